@@ -44,6 +44,8 @@
 #include "ccpp_EnvironmentalData.h"  /* Include the generated type specific (EnvironmentalData) DCPS API */
 #include "example_main.h"         /* Include to define the application main() wrapper OSPL_MAIN. */
 #include "QosProvider.h"
+#include "OutputSink.h"
+#include "SensorSchema.h"
 using namespace std;
 
 /**
@@ -70,25 +72,27 @@ extern "C"
     DDS::DomainId_t                   domain;
     DDS::DomainParticipant_var        participant;
 
-    DDS::Topic_var                    topicHumidity;
-    DDS::Topic_var                    topicRain;    
-
-    DDS::Subscriber_var               subscriberHumidity;
-    DDS::Subscriber_var               subscriberRain;
+/* The reader of one sensor kind and its last take. */
+struct KindSubscriber
+{
+    DDS::Topic_var                    topic;
+    DDS::Subscriber_var               subscriber;
+    DDS::DataReader_var               reader;
+    EnvironmentalData::EnvironmentalDataReader_var  typedReader;
+    EnvironmentalData::EnvironmentalSeq msgList;
+    DDS::SampleInfoSeq                infoSeq;
+    string                            takeFailed;
+    string                            loanFailed;
+};
 
-    DDS::DataReader_var               readerHumidity;
-    DDS::DataReader_var               readerRain;
-    
-    EnvironmentalData::EnvironmentalDataReader_var  myReaderHumidity; 
-    EnvironmentalData::EnvironmentalDataReader_var  myReaderRain;
- 
-    EnvironmentalData::EnvironmentalSeq msgListHumidity;
-    EnvironmentalData::EnvironmentalSeq msgListRain;
+    KindSubscriber                    kinds[SENSOR_KIND_COUNT];
 
-    DDS::SampleInfoSeq infoSeqHumidity;
-    DDS::SampleInfoSeq infoSeqRain;
+/* The kinds this subscriber reads. */
+static const SensorKindId READ_KINDS[] = { SENSOR_HUMIDITY, SENSOR_RAIN };
 
     DDS::ReturnCode_t result;
+
+    OutputSink sink;
 /*
  * The main function of the Subscriber application
  */
@@ -130,10 +134,11 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     //tQos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
     //tQos.durability.kind = DDS::TRANSIENT_DURABILITY_QOS;
     /* Use the changed policy when defining the EnvironmentalData topic */
-    topicHumidity = participant->create_topic("humidity", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicHumidity, "create_topic() humidity failed");
-    topicRain = participant->create_topic("rain", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicRain, "create_topic() rain failed");
+    for (int k : READ_KINDS) {
+        const char *topic = SENSOR_KINDS[k].topic;
+        kinds[k].topic = participant->create_topic(topic, typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+        checkHandle(kinds[k].topic, string("create_topic() ") + topic + " failed");
+    }
 
   // Create Subscriber entity
     /* Create on heap and initialize subscriber qos value with the default value. */
@@ -146,10 +151,10 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     //sQos.partition.name.length(1);
     //sQos.partition.name[0] = "EnvironmentalData Partition";
     /* Create the subscriber. */
-    subscriberHumidity = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberHumidity, "create_subscriber() humidity failed");
-    subscriberRain = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberRain, "create_subscriber() rain failed");
+    for (int k : READ_KINDS) {
+        kinds[k].subscriber = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
+        checkHandle(kinds[k].subscriber, string("create_subscriber() ") + SENSOR_KINDS[k].topic + " failed");
+    }
 
   // create DataReader entity
     DDS::DataReaderQos rQos;
@@ -157,16 +162,18 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     result = qp.get_datareader_qos(rQos, NULL);
     checkStatus(result, "get_default_datareader_qos() failed");
 
-    readerHumidity = subscriberHumidity->create_datareader(topicHumidity, rQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(readerHumidity, "create_datareader() humidity failed");
-    readerRain = subscriberRain->create_datareader(topicRain, rQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(readerRain, "create_datareader() rain failed");
-
-    /* Cast reader to 'HelloWorld' type specific interface. */
-    myReaderHumidity = EnvironmentalData::EnvironmentalDataReader::_narrow(readerHumidity);
-    checkHandle(myReaderHumidity, "EnvironmentalDataReader::_narrow() humidity failed");
-    myReaderRain = EnvironmentalData::EnvironmentalDataReader::_narrow(readerRain);
-    checkHandle(myReaderRain, "EnvironmentalDataReader::_narrow() temperature failed");
+    for (int k : READ_KINDS) {
+        KindSubscriber &kind = kinds[k];
+        const char *topic = SENSOR_KINDS[k].topic;
+        kind.reader = kind.subscriber->create_datareader(kind.topic, rQos, NULL, DDS::STATUS_MASK_NONE);
+        checkHandle(kind.reader, string("create_datareader() ") + topic + " failed");
+
+        /* Cast reader to 'EnvironmentalData' type specific interface. */
+        kind.typedReader = EnvironmentalData::EnvironmentalDataReader::_narrow(kind.reader);
+        checkHandle(kind.typedReader, string("EnvironmentalDataReader::_narrow() ") + topic + " failed");
+        kind.takeFailed = string("EnvironmentalDataReader::take ") + topic;
+        kind.loanFailed = string("EnvironmentalDataReader::return_loan ") + topic;
+    }
 
     cout << "=== [Subscriber] Ready ..." << endl;
     return 0;
@@ -175,92 +182,42 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
 void Subscriberkill()
 {
   // Delete all entities before termination (good practice to cleanup resources)
-    result = subscriberHumidity->delete_datareader(readerHumidity);
-    checkStatus(result, "delete_datareader() humidity failed");
-    result = subscriberRain->delete_datareader(readerRain);
-    checkStatus(result, "delete_datareader() rain failed");
-
-    result = participant->delete_subscriber(subscriberHumidity);
-    checkStatus(result, "delete_publisher() humidity failed");
-    result = participant->delete_subscriber(subscriberRain);
-    checkStatus(result, "delete_publisher() rain failed");
-    
-    result = participant->delete_topic(topicHumidity);
-    checkStatus(result, "delete_topic() humidity failed");
-    result = participant->delete_topic(topicRain);
-    checkStatus(result, "delete_topic() rain failed");
+    for (int k : READ_KINDS) {
+        KindSubscriber &kind = kinds[k];
+        string what = string(" ") + SENSOR_KINDS[k].topic + " failed";
+        result = kind.subscriber->delete_datareader(kind.reader);
+        checkStatus(result, ("delete_datareader()" + what).c_str());
+        result = participant->delete_subscriber(kind.subscriber);
+        checkStatus(result, ("delete_subscriber()" + what).c_str());
+        result = participant->delete_topic(kind.topic);
+        checkStatus(result, ("delete_topic()" + what).c_str());
+    }
 
     result = factory->delete_participant(participant);
     checkStatus(result, "delete_participant() failed");
 }
 
-bool HumidityRead()
-{
-  EnvironmentalData::EnvironmentalSeq msgList;
-  DDS::SampleInfoSeq infoSeq;
-
-  result = myReaderHumidity->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
-    DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take humidity");
-  
-  msgListHumidity = msgList;
-  infoSeqHumidity = infoSeq;
-
-  result = myReaderHumidity->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan humidity");
-
-   if(msgListHumidity.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
-}
-
-bool RainRead()
+/**
+ * Takes the samples waiting for the reader of kind k into its msgList
+ * and infoSeq. Returns whether there were any.
+ **/
+bool KindRead(int k)
 {
+  KindSubscriber &kind = kinds[k];
   EnvironmentalData::EnvironmentalSeq msgList;
   DDS::SampleInfoSeq infoSeq;
 
-  result = myReaderRain->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
+  result = kind.typedReader->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
     DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take rain");
-  
-  msgListRain = msgList;
-  infoSeqRain = infoSeq;
-
-  result = myReaderRain->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan Rain");
-
-   if(msgListRain.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
-}
+  checkStatus(result, kind.takeFailed.c_str());
 
-EnvironmentalData::EnvironmentalSeq HumidityGetDataSeq()
-{
-    return msgListHumidity;
-}
+  kind.msgList = msgList;
+  kind.infoSeq = infoSeq;
 
+  result = kind.typedReader->return_loan(msgList, infoSeq);
+  checkStatus(result, kind.loanFailed.c_str());
 
-EnvironmentalData::EnvironmentalSeq RainGetDataSeq()
-{
-    return msgListRain;
-}
-
-DDS::SampleInfoSeq HumidityGetInfoSeq()
-{
-    return infoSeqHumidity;
-}
-
-DDS::SampleInfoSeq RainGetInfoSeq()
-{
-    return infoSeqRain;
+  return kind.msgList.length() > 0;
 }
 
 /* End of the Subscriber  example application.
@@ -300,34 +257,40 @@ static void checkHandle(void *handle, string info)
     }
 }
 
+/**
+ * Source timestamp of a sample in milliseconds since the epoch.
+ **/
+static int64_t sampleTime(const DDS::SampleInfo &info)
+{
+    return (int64_t)info.source_timestamp.sec * 1000 + info.source_timestamp.nanosec / 1000000;
+}
+
 /* Main wrapper to allow embedded usage of the Subscriber application. */
 int OSPL_MAIN (int argc, char *argv[])
 {
   os_time delay_100ms = { 0, 100000000 }; //100ms
   EnvironmentalDataSubscriber (argc, argv);
+  sink.open(SINK_CSV);
 
 for(;;){
 
-            if(HumidityRead()){
-            for (DDS::ULong i = 0; i < HumidityGetDataSeq().length(); ++i) {
-                if (HumidityGetInfoSeq()[i].valid_data) {
-                    float sensor_val = HumidityGetDataSeq()[i].value;
-                    std::cout << "Humi: " << sensor_val << std::endl;
-                }
+        for (int k : READ_KINDS) {
+            KindSubscriber &kind = kinds[k];
+            const char *topic = SENSOR_KINDS[k].topic;
+            if (!KindRead(k)) {
+                continue;
             }
-        }
-
-        if(RainRead()){
-            for (DDS::ULong i = 0; i < RainGetDataSeq().length(); ++i) {
-                if (RainGetInfoSeq()[i].valid_data) {
-                    float sensor_val = RainGetDataSeq()[i].value;
-                    std::cout << "Rain: " << sensor_val << std::endl;
+            for (DDS::ULong i = 0; i < kind.msgList.length(); ++i) {
+                if (kind.infoSeq[i].valid_data) {
+                    float sensor_val = kind.msgList[i].value;
+                    sink.write(topic, kind.msgList[i].id, sampleTime(kind.infoSeq[i]), sensor_val);
                 }
             }
         }
         
          os_nanoSleep(delay_100ms);
     }
+    sink.close();
     Subscriberkill();
 
     return 0;
@@ -40,55 +40,92 @@
  *
  ***/
 #include <iostream>
+#include <chrono>
 #include "ccpp_dds_dcps.h"        /* Include the DDS::DCPS API */
 #include "ccpp_EnvironmentalData.h"  /* Include the generated type specific (EnvironmentalData) DCPS API */
 #include "example_main.h"         /* Include to define the application main() wrapper OSPL_MAIN. */
 #include "QosProvider.h"
+#include "OutputSink.h"
+#include "SensorSchema.h"
+#include "CommandLine.h"
+#include "Metrics.h"
+#include "LivenessTracker.h"
+#include "SensorRegistry.h"
 using namespace std;
 
+/**
+ * Counts the status changes of a reader in the process metrics.
+ **/
 class ExampleListener : public virtual DDS::DataReaderListener
 {
+    Counter &deadline_missed;
+    Counter &incompatible_qos;
+    Counter &samples_rejected;
+    Counter &samples_lost;
+    Counter &data_available;
+    Gauge   &alive_writers;
+    Gauge   &matched_writers;
 public:
+    ExampleListener(const char *topic)
+      : deadline_missed(metrics().counter("stack_reader_deadline_missed_total",
+          "Requested deadlines missed by the reader.", metricsLabel("topic", topic))),
+        incompatible_qos(metrics().counter("stack_reader_incompatible_qos_total",
+          "Writers not matched because of incompatible QoS.", metricsLabel("topic", topic))),
+        samples_rejected(metrics().counter("stack_reader_samples_rejected_total",
+          "Samples rejected by the reader for lack of resources.", metricsLabel("topic", topic))),
+        samples_lost(metrics().counter("stack_reader_samples_lost_total",
+          "Samples lost before reaching the reader.", metricsLabel("topic", topic))),
+        data_available(metrics().counter("stack_reader_data_available_total",
+          "Data available notifications.", metricsLabel("topic", topic))),
+        alive_writers(metrics().gauge("stack_reader_alive_writers",
+          "Matched writers that are alive.", metricsLabel("topic", topic))),
+        matched_writers(metrics().gauge("stack_reader_matched_writers",
+          "Writers currently matched with the reader.", metricsLabel("topic", topic)))
+    {
+    }
     virtual void on_requested_deadline_missed (
         DDS::DataReader_ptr reader,
         const DDS::RequestedDeadlineMissedStatus & status)
     {
-        std::cout << "on_requested_deadline_missed" << std::endl;
+        /* The topics are keyless, so this only says that the reader as a
+         * whole missed its deadline; the LivenessTracker in the main loop
+         * tells which sensor went silent. */
+        deadline_missed.add(status.total_count_change);
     }
     virtual void on_requested_incompatible_qos (
         DDS::DataReader_ptr reader,
         const DDS::RequestedIncompatibleQosStatus & status)
     {
-        std::cout << "on_requested_incompatible_qos" << std::endl;
+        incompatible_qos.add(status.total_count_change);
     }
     virtual void on_sample_rejected (
         DDS::DataReader_ptr reader,
         const DDS::SampleRejectedStatus & status)
     {
-        std::cout << "on_sample_rejected" << std::endl;
+        samples_rejected.add(status.total_count_change);
     }
     virtual void on_liveliness_changed (
         DDS::DataReader_ptr reader,
         const DDS::LivelinessChangedStatus & status)
     {
-        std::cout << "on_liveliness_changed" << std::endl;
+        alive_writers.set(status.alive_count);
     }
     virtual void on_data_available (
         DDS::DataReader_ptr reader)
     {
-        std::cout << "on_data_available" << std::endl;
+        data_available.add();
     }
     virtual void on_subscription_matched (
         DDS::DataReader_ptr reader,
         const DDS::SubscriptionMatchedStatus & status)
     {
-        std::cout << "on_subscription_matched" << std::endl;
+        matched_writers.set(status.current_count);
     }
     virtual void on_sample_lost (
         DDS::DataReader_ptr reader,
         const DDS::SampleLostStatus & status)
     {
-        std::cout << "on_sample_lost" << std::endl;
+        samples_lost.add(status.total_count_change);
     }
 };
 
@@ -104,6 +141,8 @@ static void checkStatus(DDS::ReturnCode_t status, const char *info);
  **/
 static void checkHandle(void *handle, string info);
 
+void createLivenessWriter(DDS::QosProvider &qp);
+
 /* entry point exported and demangled so symbol can be found in shared library */
 extern "C"
 {
@@ -116,31 +155,36 @@ extern "C"
     DDS::DomainId_t                   domain;
     DDS::DomainParticipant_var        participant;
 
-    DDS::Topic_var                    topicHumidity;
-    DDS::Topic_var                    topicRain;   
-    DDS::Topic_var                    topicTemperature;
-
-    DDS::Subscriber_var               subscriberHumidity;
-	DDS::Subscriber_var               subscriberRain;
-    DDS::Subscriber_var               subscriberTemperature;
-
-    DDS::DataReader_var               readerHumidity;
-	DDS::DataReader_var               readerRain;
-    DDS::DataReader_var               readerTemperature;
-    
-    EnvironmentalData::EnvironmentalDataReader_var  myReaderHumidity;   
-	EnvironmentalData::EnvironmentalDataReader_var  myReaderRain;
-    EnvironmentalData::EnvironmentalDataReader_var  myReaderTemperature;
- 
-    EnvironmentalData::EnvironmentalSeq msgListHumidity;
-	EnvironmentalData::EnvironmentalSeq msgListRain;
-    EnvironmentalData::EnvironmentalSeq msgListTemperature;
-
-    DDS::SampleInfoSeq infoSeqHumidity;
-	DDS::SampleInfoSeq infoSeqRain;
-    DDS::SampleInfoSeq infoSeqTemperature;
+/* The reader of one sensor kind and its last take. */
+struct KindSubscriber
+{
+    DDS::Topic_var                    topic;
+    DDS::Subscriber_var               subscriber;
+    DDS::DataReader_var               reader;
+    EnvironmentalData::EnvironmentalDataReader_var  typedReader;
+    EnvironmentalData::EnvironmentalSeq msgList;
+    DDS::SampleInfoSeq                infoSeq;
+    Counter                           *received;
+    string                            takeFailed;
+    string                            loanFailed;
+};
+
+    KindSubscriber                    kinds[SENSOR_KIND_COUNT];
 
     DDS::ReturnCode_t result;
+
+    /* Liveness topic, created when --liveness-timeout is given. */
+    bool                              livenessEnabled = false;
+    DDS::Topic_var                    topicLiveness;
+    DDS::Publisher_var                publisherLiveness;
+    DDS::DataWriter_var               writerLiveness;
+    EnvironmentalData::SensorLivenessDataWriter_var  myWriterLiveness;
+
+    OutputSink sink;
+    MetricsExporter metricsExporter(metrics());
+    LivenessTracker tracker;
+    SensorRegistry registry;
+    vector<const char *> sensorTopics;      /* by registry number */
 /*
  * The main function of the Subscriber application
  */
@@ -182,12 +226,11 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     //tQos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
     //tQos.durability.kind = DDS::TRANSIENT_DURABILITY_QOS;
     /* Use the changed policy when defining the EnvironmentalData topic */
-    topicHumidity = participant->create_topic("humidity", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicHumidity, "create_topic() humidity failed");
-	topicRain = participant->create_topic("rain", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicRain, "create_topic() rain failed");
-    topicTemperature = participant->create_topic("temperature", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicTemperature, "create_topic() temperature failed");
+    SensorKinds<>::forEach([&](int k) {
+        const char *topic = SENSOR_KINDS[k].topic;
+        kinds[k].topic = participant->create_topic(topic, typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+        checkHandle(kinds[k].topic, string("create_topic() ") + topic + " failed");
+    });
 
   // Create Subscriber entity
     /* Create on heap and initialize subscriber qos value with the default value. */
@@ -200,12 +243,10 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     //sQos.partition.name.length(1);
     //sQos.partition.name[0] = "EnvironmentalData Partition";
     /* Create the subscriber. */
-    subscriberHumidity = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberHumidity, "create_subscriber() humidity failed");
-	subscriberRain = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberRain, "create_subscriber() rain failed");
-    subscriberTemperature = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberTemperature, "create_subscriber() temperature failed"); 
+    SensorKinds<>::forEach([&](int k) {
+        kinds[k].subscriber = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
+        checkHandle(kinds[k].subscriber, string("create_subscriber() ") + SENSOR_KINDS[k].topic + " failed");
+    });
 
   // create DataReader entity
     DDS::DataReaderQos rQos;
@@ -213,155 +254,121 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     result = qp.get_datareader_qos(rQos, NULL);
     checkStatus(result, "get_default_datareader_qos() failed");
 
-    readerHumidity = subscriberHumidity->create_datareader(topicHumidity, rQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(readerHumidity, "create_datareader() humidity failed");
-	 readerRain = subscriberRain->create_datareader(topicRain, rQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(readerRain, "create_datareader() rain failed");
-    readerTemperature = subscriberTemperature->create_datareader(topicTemperature, rQos, new ExampleListener(), DDS::DATA_AVAILABLE_STATUS | DDS::REQUESTED_DEADLINE_MISSED_STATUS);
-    checkHandle(readerTemperature, "create_datareader() temperature failed");
-
-    /* Cast reader to 'HelloWorld' type specific interface. */
-    myReaderHumidity = EnvironmentalData::EnvironmentalDataReader::_narrow(readerHumidity);
-    checkHandle(myReaderHumidity, "EnvironmentalDataReader::_narrow() humidity failed");
-    myReaderRain = EnvironmentalData::EnvironmentalDataReader::_narrow(readerRain);
-    checkHandle(myReaderRain, "EnvironmentalDataReader::_narrow() temperature failed");
-    myReaderTemperature = EnvironmentalData::EnvironmentalDataReader::_narrow(readerTemperature);
-    checkHandle(myReaderTemperature, "EnvironmentalDataReader::_narrow() temperature failed");
+    SensorKinds<>::forEach([&](int k) {
+        KindSubscriber &kind = kinds[k];
+        const char *topic = SENSOR_KINDS[k].topic;
+        /* Only the temperature reader reports its status changes. */
+        if (k == SENSOR_TEMPERATURE) {
+            kind.reader = kind.subscriber->create_datareader(kind.topic, rQos, new ExampleListener(topic),
+                DDS::DATA_AVAILABLE_STATUS | DDS::REQUESTED_DEADLINE_MISSED_STATUS | DDS::SAMPLE_LOST_STATUS | DDS::SAMPLE_REJECTED_STATUS |
+                DDS::SUBSCRIPTION_MATCHED_STATUS | DDS::LIVELINESS_CHANGED_STATUS | DDS::REQUESTED_INCOMPATIBLE_QOS_STATUS);
+        } else {
+            kind.reader = kind.subscriber->create_datareader(kind.topic, rQos, NULL, DDS::STATUS_MASK_NONE);
+        }
+        checkHandle(kind.reader, string("create_datareader() ") + topic + " failed");
+
+        /* Cast reader to 'EnvironmentalData' type specific interface. */
+        kind.typedReader = EnvironmentalData::EnvironmentalDataReader::_narrow(kind.reader);
+        checkHandle(kind.typedReader, string("EnvironmentalDataReader::_narrow() ") + topic + " failed");
+        kind.takeFailed = string("EnvironmentalDataReader::take ") + topic;
+        kind.loanFailed = string("EnvironmentalDataReader::return_loan ") + topic;
+    });
+
+    if (getIntOption(argc, argv, "--liveness-timeout", 0) > 0) {
+        createLivenessWriter(qp);
+    }
 
     cout << "=== [Subscriber] Ready ..." << endl;
     return 0;
 }
 
-void Subscriberkill()
+/**
+ * Creates the writer for the "liveness" topic the liveness tracker reports on.
+ **/
+void createLivenessWriter(DDS::QosProvider &qp)
 {
-  // Delete all entities before termination (good practice to cleanup resources)
-    result = subscriberHumidity->delete_datareader(readerHumidity);
-    checkStatus(result, "delete_datareader() humidity failed");
-    result = subscriberRain->delete_datareader(readerRain);
-    checkStatus(result, "delete_datareader() rain failed");
-    result = subscriberTemperature->delete_datareader(readerTemperature);
-    checkStatus(result, "delete_datareader() temperature failed");
-
-    result = participant->delete_subscriber(subscriberHumidity);
-    checkStatus(result, "delete_publisher() humidity failed");
-    result = participant->delete_subscriber(subscriberRain);
-    checkStatus(result, "delete_publisher() rain failed");
-    result = participant->delete_subscriber(subscriberTemperature);
-    checkStatus(result, "delete_publisher() temperature failed");
-    
-    result = participant->delete_topic(topicHumidity);
-    checkStatus(result, "delete_topic() humidity failed");
-    result = participant->delete_topic(topicRain);
-    checkStatus(result, "delete_topic() rain failed");
-    result = participant->delete_topic(topicTemperature);
-    checkStatus(result, "delete_topic() temperature failed");
+    EnvironmentalData::SensorLivenessTypeSupport_var typesupport = new EnvironmentalData::SensorLivenessTypeSupport();
+    DDS::String_var typeName = typesupport->get_type_name();
+    result = typesupport->register_type(participant, typeName);
+    checkStatus(result, "register_type() liveness failed");
 
-    result = factory->delete_participant(participant);
-    checkStatus(result, "delete_participant() failed");
+    DDS::TopicQos tQos;
+    result = qp.get_topic_qos(tQos, NULL);
+    checkStatus(result, "get_default_topic_qos() failed");
+    topicLiveness = participant->create_topic("liveness", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(topicLiveness, "create_topic() liveness failed");
+
+    DDS::PublisherQos pQos;
+    result = qp.get_publisher_qos(pQos, NULL);
+    checkStatus(result, "get_default_publisher_qos() failed");
+    publisherLiveness = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(publisherLiveness, "create_publisher() liveness failed");
+
+    DDS::DataWriterQos wQos;
+    result = qp.get_datawriter_qos(wQos, NULL);
+    checkStatus(result, "get_default_datawriter_qos() failed");
+    writerLiveness = publisherLiveness->create_datawriter(topicLiveness, wQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(writerLiveness, "create_datawriter() liveness failed");
+
+    myWriterLiveness = EnvironmentalData::SensorLivenessDataWriter::_narrow(writerLiveness);
+    checkHandle(myWriterLiveness, "SensorLivenessDataWriter::_narrow() liveness failed");
+    livenessEnabled = true;
 }
 
-bool HumidityRead()
+void LivenessPublish(EnvironmentalData::SensorLiveness& instance)
 {
-  EnvironmentalData::EnvironmentalSeq msgList;
-  DDS::SampleInfoSeq infoSeq;
-
-  result = myReaderHumidity->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
-    DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take humidity");
-  
-  msgListHumidity = msgList;
-  infoSeqHumidity = infoSeq;
-
-  result = myReaderHumidity->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan humidity");
-
-   if(msgListHumidity.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
+  result = myWriterLiveness->write(instance, DDS::HANDLE_NIL);
+  checkStatus(result, "SensorLivenessDataWriter::write liveness");
 }
 
-bool RainRead()
+void Subscriberkill()
 {
-  EnvironmentalData::EnvironmentalSeq msgList;
-  DDS::SampleInfoSeq infoSeq;
+  // Delete all entities before termination (good practice to cleanup resources)
+    if (livenessEnabled) {
+        result = publisherLiveness->delete_datawriter(writerLiveness);
+        checkStatus(result, "delete_datawriter() liveness failed");
+        result = participant->delete_publisher(publisherLiveness);
+        checkStatus(result, "delete_publisher() liveness failed");
+        result = participant->delete_topic(topicLiveness);
+        checkStatus(result, "delete_topic() liveness failed");
+    }
 
-  result = myReaderRain->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
-    DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take rain");
-  
-  msgListRain = msgList;
-  infoSeqRain = infoSeq;
-
-  result = myReaderRain->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan Rain");
-
-   if(msgListRain.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
+    SensorKinds<>::forEach([&](int k) {
+        KindSubscriber &kind = kinds[k];
+        string what = string(" ") + SENSOR_KINDS[k].topic + " failed";
+        result = kind.subscriber->delete_datareader(kind.reader);
+        checkStatus(result, ("delete_datareader()" + what).c_str());
+        result = participant->delete_subscriber(kind.subscriber);
+        checkStatus(result, ("delete_subscriber()" + what).c_str());
+        result = participant->delete_topic(kind.topic);
+        checkStatus(result, ("delete_topic()" + what).c_str());
+    });
+
+    result = factory->delete_participant(participant);
+    checkStatus(result, "delete_participant() failed");
 }
 
-bool TemperatureRead()
+/**
+ * Takes the samples waiting for the reader of kind k into its msgList
+ * and infoSeq. Returns whether there were any.
+ **/
+bool KindRead(int k)
 {
+  KindSubscriber &kind = kinds[k];
   EnvironmentalData::EnvironmentalSeq msgList;
   DDS::SampleInfoSeq infoSeq;
 
-  result = myReaderTemperature->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
+  result = kind.typedReader->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
     DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take temperature");
-  
-  msgListTemperature = msgList;
-  infoSeqTemperature = infoSeq;
-
-  result = myReaderTemperature->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan temperature");
-
-   if(msgListTemperature.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
-}
+  checkStatus(result, kind.takeFailed.c_str());
 
+  kind.msgList = msgList;
+  kind.infoSeq = infoSeq;
 
-EnvironmentalData::EnvironmentalSeq HumidityGetDataSeq()
-{
-    return msgListHumidity;
-}
-
-EnvironmentalData::EnvironmentalSeq RainGetDataSeq()
-{
-    return msgListRain;
-}
+  result = kind.typedReader->return_loan(msgList, infoSeq);
+  checkStatus(result, kind.loanFailed.c_str());
 
-EnvironmentalData::EnvironmentalSeq TemperatureGetDataSeq()
-{
-    return msgListTemperature;
-}
-
-
-DDS::SampleInfoSeq HumidityGetInfoSeq()
-{
-    return infoSeqHumidity;
-}
-
-DDS::SampleInfoSeq RainGetInfoSeq()
-{
-    return infoSeqRain;
-}
-
-DDS::SampleInfoSeq TemperatureGetInfoSeq()
-{
-    return infoSeqTemperature;
+  return kind.msgList.length() > 0;
 }
 
 /* End of the Subscriber  example application.
@@ -401,43 +408,99 @@ static void checkHandle(void *handle, string info)
     }
 }
 
+/**
+ * Source timestamp of a sample in milliseconds since the epoch.
+ **/
+static int64_t sampleTime(const DDS::SampleInfo &info)
+{
+    return (int64_t)info.source_timestamp.sec * 1000 + info.source_timestamp.nanosec / 1000000;
+}
+
+/**
+ * Local time in milliseconds since the epoch.
+ **/
+static int64_t currentTime()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Records a reading of sensor id on topic with the liveness tracker.
+ **/
+static void touchSensor(const char *topic, const char *id, int64_t now, vector<LivenessEvent> &events)
+{
+    if (!livenessEnabled) {
+        return;
+    }
+    uint32_t sensor = registry.intern(id);
+    if (sensor >= sensorTopics.size()) {
+        sensorTopics.resize((size_t)sensor + 1, topic);
+    }
+    tracker.touch(sensor, now, events);
+}
+
 /* Main wrapper to allow embedded usage of the Subscriber application. */
 int OSPL_MAIN (int argc, char *argv[])
 {
   os_time delay_100ms = { 0, 100000000 }; //100ms
   EnvironmentalDataSubscriber (argc, argv);
+  sink.open(SINK_CSV);
+
+  SensorKinds<>::forEach([](int k) {
+      kinds[k].received = &metrics().counter("stack_samples_received_total",
+          "Valid samples taken from the reader.", metricsLabel("topic", SENSOR_KINDS[k].topic));
+  });
+
+  /* --metrics-port <port> serves Prometheus metrics on 127.0.0.1,
+   * --metrics-file <path> rewrites them every --metrics-interval ms. */
+  metricsExporter.start(getIntOption(argc, argv, "--metrics-port", 0),
+      getOption(argc, argv, "--metrics-file", NULL), getIntOption(argc, argv, "--metrics-interval", 10000));
+
+  /* --liveness-timeout <ms> reports sensors without a reading for that long
+   * as stale, and again when they recover, on the "liveness" topic. */
+  if (livenessEnabled) {
+      tracker.configure(getIntOption(argc, argv, "--liveness-timeout", 0),
+          getIntOption(argc, argv, "--liveness-tick", 100));
+  }
+  vector<LivenessEvent> livenessEvents;
+  EnvironmentalData::SensorLiveness liveness;
 
 for(;;){
 
-        if(HumidityRead()){
-            for (DDS::ULong i = 0; i < HumidityGetDataSeq().length(); ++i) {
-                if (HumidityGetInfoSeq()[i].valid_data) {
-                    float sensor_val = HumidityGetDataSeq()[i].value;
-                    std::cout << "Humi: " << sensor_val << std::endl;
-                }
+        int64_t now = currentTime();
+        SensorKinds<>::forEach([&](int k) {
+            KindSubscriber &kind = kinds[k];
+            const char *topic = SENSOR_KINDS[k].topic;
+            if (!KindRead(k)) {
+                return;
             }
-        }
-
-		 if(RainRead()){
-            for (DDS::ULong i = 0; i < RainGetDataSeq().length(); ++i) {
-                if (RainGetInfoSeq()[i].valid_data) {
-                    float sensor_val = RainGetDataSeq()[i].value;
-                    std::cout << "Rain: " << sensor_val << std::endl;
+            for (DDS::ULong i = 0; i < kind.msgList.length(); ++i) {
+                if (kind.infoSeq[i].valid_data) {
+                    float sensor_val = kind.msgList[i].value;
+                    sink.write(topic, kind.msgList[i].id, sampleTime(kind.infoSeq[i]), sensor_val);
+                    kind.received->add();
+                    touchSensor(topic, kind.msgList[i].id, now, livenessEvents);
                 }
             }
-        }
-		
-        if(TemperatureRead()){
-            for (DDS::ULong i = 0; i < TemperatureGetDataSeq().length(); ++i) {
-                if (TemperatureGetInfoSeq()[i].valid_data) {
-                    float sensor_val = TemperatureGetDataSeq()[i].value;
-                    std::cout << "Temperature: " << sensor_val << std::endl;
-                }
+        });
+
+        if (livenessEnabled) {
+            tracker.advance(now, livenessEvents);
+            for (size_t i = 0; i < livenessEvents.size(); ++i) {
+                liveness.id = DDS::String_mgr(registry.id(livenessEvents[i].sensor).c_str());
+                liveness.topic = DDS::String_mgr(sensorTopics[livenessEvents[i].sensor]);
+                liveness.alive = livenessEvents[i].alive;
+                liveness.last_seen = livenessEvents[i].last_seen;
+                liveness.timestamp = livenessEvents[i].timestamp;
+                LivenessPublish(liveness);
             }
+            livenessEvents.clear();
         }
         
          os_nanoSleep(delay_100ms);
     }
+    metricsExporter.stop();
+    sink.close();
     Subscriberkill();
 
     return 0;
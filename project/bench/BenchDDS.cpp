@@ -0,0 +1,311 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BenchDDS.cpp
+ * FUNCTION:        Helpers shared by the DDS benchmarks.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the benchmark helpers.
+ *
+ ***/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include "BenchDDS.h"
+#include "CheckStatus.h"
+
+BenchParticipant::BenchParticipant(int argc, char *argv[])
+  : arg_count(argc), args(argv)
+{
+  factory = DDS::DomainParticipantFactory::get_instance();
+  checkHandle(factory, "get_instance() failed");
+  participant = factory->create_participant(DDS::DOMAIN_ID_DEFAULT, PARTICIPANT_QOS_DEFAULT, NULL,
+    DDS::STATUS_MASK_NONE);
+  checkHandle(participant, "create_participant() failed");
+
+  EnvironmentalData::EnvironmentalTypeSupport_var typesupport = new EnvironmentalData::EnvironmentalTypeSupport();
+  type_name = typesupport->get_type_name();
+  checkStatus(typesupport->register_type(participant, type_name), "register_type() failed");
+}
+
+BenchParticipant::~BenchParticipant()
+{
+  checkStatus(participant->delete_contained_entities(), "delete_contained_entities() failed");
+  checkStatus(factory->delete_participant(participant), "delete_participant() failed");
+}
+
+DDS::Topic_ptr BenchParticipant::topic(const char *name)
+{
+  DDS::Topic_var &slot = topics[name];
+  if (!slot)
+  {
+    DDS::TopicQos tQos;
+    checkStatus(qos.provider(arg_count, args, name).get_topic_qos(tQos, NULL), "get_topic_qos() failed");
+    slot = participant->create_topic(name, type_name, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(slot, std::string("create_topic() ") + name + " failed");
+  }
+  return slot;
+}
+
+EnvironmentalData::EnvironmentalDataWriter_ptr BenchParticipant::createWriter(const char *name)
+{
+  DDS::QosProvider &qp = qos.provider(arg_count, args, name);
+  DDS::PublisherQos pQos;
+  checkStatus(qp.get_publisher_qos(pQos, NULL), "get_publisher_qos() failed");
+  DDS::Publisher_var publisher = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(publisher, "create_publisher() failed");
+
+  DDS::DataWriterQos wQos;
+  checkStatus(qp.get_datawriter_qos(wQos, NULL), "get_datawriter_qos() failed");
+  DDS::DataWriter_var writer = publisher->create_datawriter(topic(name), wQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(writer, std::string("create_datawriter() ") + name + " failed");
+
+  EnvironmentalData::EnvironmentalDataWriter_ptr typed = EnvironmentalData::EnvironmentalDataWriter::_narrow(writer);
+  checkHandle(typed, "EnvironmentalDataWriter::_narrow() failed");
+  return typed;
+}
+
+EnvironmentalData::EnvironmentalDataReader_ptr BenchParticipant::createReader(const char *name)
+{
+  DDS::QosProvider &qp = qos.provider(arg_count, args, name);
+  DDS::SubscriberQos sQos;
+  checkStatus(qp.get_subscriber_qos(sQos, NULL), "get_subscriber_qos() failed");
+  DDS::Subscriber_var subscriber = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(subscriber, "create_subscriber() failed");
+
+  DDS::DataReaderQos rQos;
+  checkStatus(qp.get_datareader_qos(rQos, NULL), "get_datareader_qos() failed");
+  DDS::DataReader_var reader = subscriber->create_datareader(topic(name), rQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(reader, std::string("create_datareader() ") + name + " failed");
+
+  EnvironmentalData::EnvironmentalDataReader_ptr typed = EnvironmentalData::EnvironmentalDataReader::_narrow(reader);
+  checkHandle(typed, "EnvironmentalDataReader::_narrow() failed");
+  return typed;
+}
+
+/**
+ * Deletes a writer made by createWriter together with its publisher.
+ **/
+void BenchParticipant::deleteWriter(DDS::DataWriter_ptr writer)
+{
+  DDS::Publisher_var publisher = writer->get_publisher();
+  checkStatus(publisher->delete_datawriter(writer), "delete_datawriter() failed");
+  checkStatus(participant->delete_publisher(publisher), "delete_publisher() failed");
+}
+
+/**
+ * Deletes a reader made by createReader together with its subscriber and
+ * the conditions attached to it.
+ **/
+void BenchParticipant::deleteReader(DDS::DataReader_ptr reader)
+{
+  DDS::Subscriber_var subscriber = reader->get_subscriber();
+  checkStatus(reader->delete_contained_entities(), "delete_contained_entities() failed");
+  checkStatus(subscriber->delete_datareader(reader), "delete_datareader() failed");
+  checkStatus(participant->delete_subscriber(subscriber), "delete_subscriber() failed");
+}
+
+bool benchWaitForReader(DDS::DataWriter_ptr writer, int64_t timeoutMs)
+{
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() +
+    std::chrono::milliseconds(timeoutMs);
+  for (;;)
+  {
+    DDS::PublicationMatchedStatus status = DDS::PublicationMatchedStatus();
+    checkStatus(writer->get_publication_matched_status(status), "get_publication_matched_status() failed");
+    if (status.current_count > 0)
+    {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= end)
+    {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void benchFill(EnvironmentalData::Environmental &sample, const char *tag, uint64_t sequence,
+  size_t payload)
+{
+  char id[BENCH_MAX_PAYLOAD + 1];
+  char type[BENCH_MAX_PAYLOAD + 1];
+  int length = snprintf(id, sizeof(id), "%s:%llu:", tag, (unsigned long long)sequence);
+  if (length < 0 || (size_t)length >= sizeof(id))
+  {
+    length = sizeof(id) - 1;
+  }
+  if (payload > BENCH_MAX_PAYLOAD)
+  {
+    payload = BENCH_MAX_PAYLOAD;
+  }
+  for (size_t i = length; i < payload; i++)
+  {
+    id[i] = 'x';
+  }
+  id[(size_t)length > payload ? length : payload] = '\0';
+  memset(type, 'y', payload);
+  type[payload] = '\0';
+
+  sample.id = DDS::string_dup(id);
+  sample.type = DDS::string_dup(type);
+  sample.value = (float)(sequence % 1000) * 0.1f;
+}
+
+bool benchParse(const char *id, std::string &tag, uint64_t &sequence)
+{
+  const char *colon = strchr(id, ':');
+  if (colon == NULL)
+  {
+    return false;
+  }
+  char *end;
+  sequence = strtoull(colon + 1, &end, 10);
+  if (end == colon + 1 || *end != ':')
+  {
+    return false;
+  }
+  tag.assign(id, colon - id);
+  return true;
+}
+
+size_t benchSampleBytes(size_t payload)
+{
+  if (payload > BENCH_MAX_PAYLOAD)
+  {
+    payload = BENCH_MAX_PAYLOAD;
+  }
+  return 2 * (payload + 1) + sizeof(float);
+}
+
+std::vector<long> benchList(const char *text)
+{
+  std::vector<long> values;
+  while (*text != '\0')
+  {
+    char *end;
+    long value = strtol(text, &end, 10);
+    if (end == text)
+    {
+      break;
+    }
+    values.push_back(value);
+    text = *end == ',' ? end + 1 : end;
+  }
+  return values;
+}
+
+double benchPercentile(const std::vector<double> &sorted, double q)
+{
+  if (sorted.empty())
+  {
+    return 0.0;
+  }
+  size_t i = (size_t)ceil(q * sorted.size());
+  return sorted[i > 0 ? i - 1 : 0];
+}
+
+BenchResults::BenchResults()
+  : file(NULL)
+{
+}
+
+BenchResults::~BenchResults()
+{
+  if (file != NULL)
+  {
+    fclose(file);
+  }
+}
+
+/**
+ * Appends results to path; nothing is written when path is NULL.
+ **/
+void BenchResults::open(const char *path)
+{
+  if (path == NULL)
+  {
+    return;
+  }
+  file = fopen(path, "a");
+  if (file == NULL)
+  {
+    std::cerr << "Error in BenchResults: cannot open " << path << std::endl;
+    exit(1);
+  }
+}
+
+void BenchResults::begin(const char *bench)
+{
+  char host[64] = "";
+  gethostname(host, sizeof(host) - 1);
+  line = "{";
+  field("bench", bench);
+  field("host", host);
+  field("time", (double)std::chrono::duration_cast<std::chrono::seconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count());
+
+  /* The OpenSplice configuration in use, e.g. "ospl_shmem". */
+  const char *uri = getenv("OSPL_URI");
+  std::string deployment = uri != NULL ? uri : "default";
+  size_t slash = deployment.find_last_of('/');
+  if (slash != std::string::npos)
+  {
+    deployment = deployment.substr(slash + 1);
+  }
+  if (deployment.size() > 4 && deployment.compare(deployment.size() - 4, 4, ".xml") == 0)
+  {
+    deployment.resize(deployment.size() - 4);
+  }
+  field("deployment", deployment.c_str());
+}
+
+void BenchResults::field(const char *name, const char *value)
+{
+  if (line.size() > 1)
+  {
+    line += ",";
+  }
+  line += "\"";
+  line += name;
+  line += "\":\"";
+  for (const char *c = value; *c != '\0'; c++)
+  {
+    if (*c == '"' || *c == '\\')
+    {
+      line += '\\';
+    }
+    line += *c;
+  }
+  line += "\"";
+}
+
+void BenchResults::field(const char *name, double value)
+{
+  char text[64];
+  snprintf(text, sizeof(text), "%.17g", value);
+  if (line.size() > 1)
+  {
+    line += ",";
+  }
+  line += "\"";
+  line += name;
+  line += "\":";
+  line += isfinite(value) ? text : "null";
+}
+
+void BenchResults::end()
+{
+  line += "}\n";
+  if (file != NULL)
+  {
+    fputs(line.c_str(), file);
+    fflush(file);
+  }
+  line.clear();
+}
@@ -0,0 +1,103 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BenchDDS.h
+ * FUNCTION:        Helpers shared by the DDS benchmarks.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the helpers of bench_throughput and
+ * bench_pingpong:
+ * - BenchParticipant creates EnvironmentalData readers and writers with
+ *   the QoS profile selected on the command line (see QosCatalogue.h)
+ * - benchFill/benchParse put a run tag and a sequence number in the id
+ *   of a sample and pad id and type to the payload length
+ * - BenchResults appends one JSON object per run to a results file, so
+ *   runs can be compared between QoS, IDL, deployment or code changes
+ *
+ ***/
+
+#ifndef __BENCHDDS_H__
+  #define __BENCHDDS_H__
+
+  #include <stdint.h>
+  #include <stdio.h>
+  #include <map>
+  #include <string>
+  #include <vector>
+  #include "ccpp_dds_dcps.h"
+  #include "ccpp_EnvironmentalData.h"
+  #include "QosCatalogue.h"
+
+  /* Bound of the id and type strings in the IDL. */
+  #define BENCH_MAX_PAYLOAD  50
+
+  class BenchParticipant
+  {
+      DDS::DomainParticipantFactory_var factory;
+      DDS::DomainParticipant_var participant;
+      DDS::String_var type_name;
+      QosCatalogue qos;
+      int arg_count;
+      char **args;
+      std::map<std::string, DDS::Topic_var> topics;
+
+      DDS::Topic_ptr topic(const char *name);
+    public:
+      BenchParticipant(int argc, char *argv[]);
+      ~BenchParticipant();
+      EnvironmentalData::EnvironmentalDataWriter_ptr createWriter(const char *topic);
+      EnvironmentalData::EnvironmentalDataReader_ptr createReader(const char *topic);
+      void deleteWriter(DDS::DataWriter_ptr writer);
+      void deleteReader(DDS::DataReader_ptr reader);
+  };
+
+  /**
+   * Waits until writer is matched with at least one reader. Returns false
+   * after timeoutMs.
+   **/
+  bool benchWaitForReader(DDS::DataWriter_ptr writer, int64_t timeoutMs);
+
+  /**
+   * Fills sample with "<tag>:<sequence>:" padded to payload characters in
+   * id and payload characters in type.
+   **/
+  void benchFill(EnvironmentalData::Environmental &sample, const char *tag, uint64_t sequence,
+    size_t payload);
+
+  /**
+   * Splits the id of a sample made by benchFill. Returns false for other
+   * samples.
+   **/
+  bool benchParse(const char *id, std::string &tag, uint64_t &sequence);
+
+  /**
+   * Bytes of a sample on the wire: both strings and the float.
+   **/
+  size_t benchSampleBytes(size_t payload);
+
+  /**
+   * Parses a comma separated list of numbers, e.g. "1,10,100".
+   **/
+  std::vector<long> benchList(const char *text);
+
+  /**
+   * Value at quantile q of sorted values.
+   **/
+  double benchPercentile(const std::vector<double> &sorted, double q);
+
+  class BenchResults
+  {
+      FILE *file;
+      std::string line;
+    public:
+      BenchResults();
+      ~BenchResults();
+      void open(const char *path);
+      void begin(const char *bench);
+      void field(const char *name, const char *value);
+      void field(const char *name, double value);
+      void end();
+  };
+
+#endif
@@ -0,0 +1,284 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    PingPongBench.cpp
+ * FUNCTION:        Round trip latency benchmark over DDS.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bench_pingpong'
+ * executable.
+ *
+ * This executable:
+ * - writes an EnvironmentalData sample on "bench_ping" and waits until
+ *   the pong side writes it back on "bench_pong"
+ * - repeats --samples times after --warmup round trips, for every
+ *   --payloads id/type length
+ * - reports the round trip distribution (min, mean, p50, p90, p99,
+ *   p99.9, max) and appends it to the --results file as JSON lines
+ *
+ * Usage: bench_pingpong [--role both|ping|pong] [--payloads 16,32,50]
+ *          [--samples 10000] [--warmup 1000] [--timeout-ms 1000]
+ *          [--results bench_results.jsonl] [--qos-profile <name>]
+ *
+ * "both" runs the pong side in a thread with its own participant. For a
+ * run between two processes or nodes, start "--role pong" first, then
+ * "--role ping"; the pong side runs until Ctrl-C.
+ *
+ ***/
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BenchDDS.h"
+#include "CheckStatus.h"
+#include "CommandLine.h"
+
+using namespace std;
+
+#define PING_TOPIC "bench_ping"
+#define PONG_TOPIC "bench_pong"
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void interrupt(int signum)
+{
+  interrupted = 1;
+}
+
+/**
+ * Waits on waitset for at most timeoutMs. Returns false on timeout.
+ **/
+static bool waitForData(DDS::WaitSet_ptr waitset, int64_t timeoutMs)
+{
+  DDS::ConditionSeq active;
+  DDS::Duration_t timeout = { (DDS::Long)(timeoutMs / 1000), (DDS::ULong)(timeoutMs % 1000 * 1000000) };
+  DDS::ReturnCode_t status = waitset->wait(active, timeout);
+  if (status == DDS::RETCODE_TIMEOUT)
+  {
+    return false;
+  }
+  checkStatus(status, "WaitSet::wait");
+  return true;
+}
+
+/**
+ * Writes every ping back as a pong until stop is set.
+ **/
+static void pong(BenchParticipant &side, atomic<bool> &stop)
+{
+  EnvironmentalData::EnvironmentalDataReader_var reader = side.createReader(PING_TOPIC);
+  EnvironmentalData::EnvironmentalDataWriter_var writer = side.createWriter(PONG_TOPIC);
+  DDS::ReadCondition_var condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE,
+    DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+  DDS::WaitSet_var waitset = new DDS::WaitSet();
+  checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+
+  EnvironmentalData::EnvironmentalSeq samples;
+  DDS::SampleInfoSeq infos;
+  while (!stop && !interrupted)
+  {
+    if (!waitForData(waitset, 100))
+    {
+      continue;
+    }
+    checkStatus(reader->take(samples, infos, DDS::LENGTH_UNLIMITED, DDS::ANY_SAMPLE_STATE,
+      DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE), "EnvironmentalDataReader::take ping");
+    for (DDS::ULong i = 0; i < samples.length(); i++)
+    {
+      if (infos[i].valid_data)
+      {
+        checkStatus(writer->write(samples[i], DDS::HANDLE_NIL), "EnvironmentalDataWriter::write pong");
+      }
+    }
+    checkStatus(reader->return_loan(samples, infos), "EnvironmentalDataReader::return_loan ping");
+  }
+
+  checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+  side.deleteWriter(writer);
+  side.deleteReader(reader);
+}
+
+struct PingRun
+{
+    vector<double> round_trips;   /* microseconds */
+    uint64_t timeouts;
+};
+
+/**
+ * Does count round trips of payload sized samples. Returns false when
+ * interrupted.
+ **/
+static bool ping(EnvironmentalData::EnvironmentalDataWriter_ptr writer,
+  EnvironmentalData::EnvironmentalDataReader_ptr reader, DDS::WaitSet_ptr waitset, const char *tag,
+  long payload, long count, int64_t timeoutMs, PingRun &run)
+{
+  EnvironmentalData::Environmental sample;
+  EnvironmentalData::EnvironmentalSeq samples;
+  DDS::SampleInfoSeq infos;
+  string echoTag;
+  uint64_t echoSequence;
+
+  for (long n = 0; n < count; n++)
+  {
+    if (interrupted)
+    {
+      return false;
+    }
+    benchFill(sample, tag, (uint64_t)n, payload);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    checkStatus(writer->write(sample, DDS::HANDLE_NIL), "EnvironmentalDataWriter::write ping");
+
+    /* Wait for the echo of this ping; older echoes that arrive after a
+     * timeout are dropped. */
+    bool answered = false;
+    while (!answered)
+    {
+      int64_t left = timeoutMs - chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - start).count();
+      if (left <= 0 || !waitForData(waitset, left))
+      {
+        break;
+      }
+      checkStatus(reader->take(samples, infos, DDS::LENGTH_UNLIMITED, DDS::ANY_SAMPLE_STATE,
+        DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE), "EnvironmentalDataReader::take pong");
+      chrono::steady_clock::time_point end = chrono::steady_clock::now();
+      for (DDS::ULong i = 0; i < samples.length(); i++)
+      {
+        if (infos[i].valid_data && benchParse(samples[i].id, echoTag, echoSequence) &&
+            echoTag == tag && echoSequence == (uint64_t)n)
+        {
+          run.round_trips.push_back(chrono::duration<double, micro>(end - start).count());
+          answered = true;
+        }
+      }
+      checkStatus(reader->return_loan(samples, infos), "EnvironmentalDataReader::return_loan pong");
+    }
+    if (!answered)
+    {
+      run.timeouts++;
+    }
+  }
+  return true;
+}
+
+static void report(BenchResults &results, const char *profile, long payload, PingRun &run)
+{
+  vector<double> &rtt = run.round_trips;
+  sort(rtt.begin(), rtt.end());
+  double sum = 0.0;
+  for (size_t i = 0; i < rtt.size(); i++)
+  {
+    sum += rtt[i];
+  }
+  double mean = rtt.empty() ? 0.0 : sum / rtt.size();
+  double minimum = rtt.empty() ? 0.0 : rtt.front();
+  double maximum = rtt.empty() ? 0.0 : rtt.back();
+
+  printf("payload=%-3ld samples=%-7zu timeouts=%-4llu rtt us: min=%.1f mean=%.1f p50=%.1f p90=%.1f "
+    "p99=%.1f p99.9=%.1f max=%.1f\n", payload, rtt.size(), (unsigned long long)run.timeouts,
+    minimum, mean, benchPercentile(rtt, 0.5), benchPercentile(rtt, 0.9), benchPercentile(rtt, 0.99),
+    benchPercentile(rtt, 0.999), maximum);
+  fflush(stdout);
+
+  results.begin("pingpong");
+  results.field("qos", profile);
+  results.field("payload", (double)payload);
+  results.field("sample_bytes", (double)benchSampleBytes(payload));
+  results.field("samples", (double)rtt.size());
+  results.field("timeouts", (double)run.timeouts);
+  results.field("rtt_min_us", minimum);
+  results.field("rtt_mean_us", mean);
+  results.field("rtt_p50_us", benchPercentile(rtt, 0.5));
+  results.field("rtt_p90_us", benchPercentile(rtt, 0.9));
+  results.field("rtt_p99_us", benchPercentile(rtt, 0.99));
+  results.field("rtt_p999_us", benchPercentile(rtt, 0.999));
+  results.field("rtt_max_us", maximum);
+  results.end();
+}
+
+int main(int argc, char *argv[])
+{
+  const char *role = getOption(argc, argv, "--role", "both");
+  vector<long> payloads = benchList(getOption(argc, argv, "--payloads", "16,32,50"));
+  long samples = getIntOption(argc, argv, "--samples", 10000);
+  long warmup = getIntOption(argc, argv, "--warmup", 1000);
+  int64_t timeoutMs = getIntOption(argc, argv, "--timeout-ms", 1000);
+  const char *profile = qosProfile(argc, argv, PING_TOPIC);
+  if (strcmp(role, "both") != 0 && strcmp(role, "ping") != 0 && strcmp(role, "pong") != 0)
+  {
+    cerr << "Error in --role: expected both, ping or pong" << endl;
+    return 1;
+  }
+
+  signal(SIGINT, interrupt);
+  signal(SIGTERM, interrupt);
+  atomic<bool> stop(false);
+
+  if (strcmp(role, "pong") == 0)
+  {
+    BenchParticipant pongSide(argc, argv);
+    cout << "=== [bench_pingpong] Answering pings ..." << endl;
+    pong(pongSide, stop);
+    return 0;
+  }
+
+  BenchResults results;
+  results.open(getOption(argc, argv, "--results", "bench_results.jsonl"));
+
+  unique_ptr<BenchParticipant> pongSide;
+  thread responder;
+  if (strcmp(role, "both") == 0)
+  {
+    pongSide.reset(new BenchParticipant(argc, argv));
+    responder = thread(pong, ref(*pongSide), ref(stop));
+  }
+
+  {
+    BenchParticipant pingSide(argc, argv);
+    EnvironmentalData::EnvironmentalDataReader_var reader = pingSide.createReader(PONG_TOPIC);
+    EnvironmentalData::EnvironmentalDataWriter_var writer = pingSide.createWriter(PING_TOPIC);
+    DDS::ReadCondition_var condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE,
+      DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    DDS::WaitSet_var waitset = new DDS::WaitSet();
+    checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+
+    if (!benchWaitForReader(writer, 30000))
+    {
+      cerr << "Error in bench_pingpong: no pong side matched on " << PING_TOPIC << endl;
+      interrupted = 1;
+    }
+
+    for (size_t p = 0; p < payloads.size() && !interrupted; p++)
+    {
+      string tag = "p" + to_string(payloads[p]);
+      PingRun skipped = PingRun();
+      PingRun run = PingRun();
+      if (ping(writer, reader, waitset, ("w" + tag).c_str(), payloads[p], warmup, timeoutMs, skipped) &&
+          ping(writer, reader, waitset, tag.c_str(), payloads[p], samples, timeoutMs, run))
+      {
+        report(results, profile, payloads[p], run);
+      }
+    }
+
+    checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+    pingSide.deleteWriter(writer);
+    pingSide.deleteReader(reader);
+  }
+
+  stop = true;
+  if (responder.joinable())
+  {
+    responder.join();
+  }
+  return 0;
+}
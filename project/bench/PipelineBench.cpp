@@ -0,0 +1,174 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    PipelineBench.cpp
+ * FUNCTION:        Benchmark of the subscriber processing without DDS.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bench_pipeline'
+ * executable.
+ *
+ * This executable:
+ * - writes readings of --sensors sensors on the in-process bus from
+ *   --writers threads, each at --rate samples/s (0: as fast as it can)
+ * - takes them in batches of at most --batch samples and runs them
+ *   through the same SensorPipeline as c2
+ * - reports samples/s processed, samples lost on the bus and the time
+ *   per batch after --seconds
+ *
+ * Usage: bench_pipeline [--sensors 1000] [--writers 1] [--rate 0]
+ *          [--seconds 5] [--batch 4096] [--depth 65536]
+ *          [--sink csv|jsonl|binary] [--sink-file /dev/null] [--store <dir>]
+ *          [--anomaly] [--liveness-timeout <ms>]
+ *
+ ***/
+
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "BusTransport.h"
+#include "SensorPipeline.h"
+#include "CommandLine.h"
+
+using namespace std;
+
+#define BENCH_TOPIC "humidity"
+
+static double seconds(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static int64_t currentTime()
+{
+  return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Writes readings of sensors round robin until stop is set, pacing to
+ * rate samples/s when it is not 0.
+ **/
+static void produce(TransportWriter *writer, long sensors, long rate, atomic<bool> &stop,
+  atomic<uint64_t> &written)
+{
+  TransportSample sample;
+  transportCopy(sample.type, "humidity");
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  uint64_t n = 0;
+  while (!stop)
+  {
+    snprintf(sample.id, sizeof(sample.id), "sensor-%ld", (long)(n % sensors));
+    sample.value = 40.0f + (float)(n % 200) * 0.1f;
+    sample.timestamp = 0;
+    writer->write(sample);
+    n++;
+    if (rate > 0 && n % 64 == 0)
+    {
+      chrono::steady_clock::time_point due = start + chrono::microseconds((int64_t)(n * 1000000 / rate));
+      this_thread::sleep_until(due);
+    }
+  }
+  written += n;
+}
+
+int main(int argc, char *argv[])
+{
+  long sensors = getIntOption(argc, argv, "--sensors", 1000);
+  long writers = getIntOption(argc, argv, "--writers", 1);
+  long rate = getIntOption(argc, argv, "--rate", 0);
+  double duration = (double)getIntOption(argc, argv, "--seconds", 5);
+  long batchLimit = getIntOption(argc, argv, "--batch", 4096);
+  if (sensors <= 0 || writers <= 0 || batchLimit <= 0)
+  {
+    cerr << "Error in bench_pipeline: --sensors, --writers and --batch must be positive" << endl;
+    return 1;
+  }
+
+  OutputSink sink;
+  SinkFormat format;
+  if (!OutputSink::parseFormat(getOption(argc, argv, "--sink", "csv"), format))
+  {
+    cerr << "Error in --sink: expected csv, jsonl or binary" << endl;
+    return 1;
+  }
+  sink.open(format, getOption(argc, argv, "--sink-file", "/dev/null"));
+
+  SeriesStore store;
+  const char *storeDir = getOption(argc, argv, "--store", NULL);
+  if (storeDir != NULL)
+  {
+    store.open(storeDir);
+  }
+  SensorRegistry registry;
+  AnomalyDetector detector;
+  LivenessTracker tracker;
+  long livenessTimeout = getIntOption(argc, argv, "--liveness-timeout", 0);
+  if (livenessTimeout > 0)
+  {
+    tracker.configure(livenessTimeout);
+  }
+  SensorPipeline pipeline(BENCH_TOPIC, registry, &sink, &store, hasOption(argc, argv, "--anomaly") ? &detector : NULL,
+    livenessTimeout > 0 ? &tracker : NULL);
+
+  BusTransport bus((size_t)getIntOption(argc, argv, "--depth", 65536));
+  unique_ptr<TransportReader> reader(bus.createReader(BENCH_TOPIC));
+  unique_ptr<TransportWriter> writer(bus.createWriter(BENCH_TOPIC));
+
+  atomic<bool> stop(false);
+  atomic<uint64_t> written(0);
+  vector<thread> producers;
+  for (long i = 0; i < writers; i++)
+  {
+    producers.push_back(thread(produce, writer.get(), sensors, rate, ref(stop), ref(written)));
+  }
+
+  vector<TransportSample> samples;
+  vector<AnomalyAlert> alerts;
+  vector<LivenessEvent> events;
+  uint64_t processed = 0;
+  uint64_t batches = 0;
+  uint64_t alertCount = 0;
+  double busy = 0.0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (seconds(start) < duration)
+  {
+    if (!reader->wait(100))
+    {
+      continue;
+    }
+    reader->take(samples, (size_t)batchLimit);
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    int64_t now = currentTime();
+    pipeline.process(samples.data(), samples.size(), now, alerts, events);
+    pipeline.advance(now, events);
+    busy += seconds(begin);
+    processed += samples.size();
+    batches++;
+    alertCount += alerts.size();
+    alerts.clear();
+    events.clear();
+  }
+  double elapsed = seconds(start);
+
+  stop = true;
+  for (size_t i = 0; i < producers.size(); i++)
+  {
+    producers[i].join();
+  }
+  sink.close();
+  store.close();
+
+  printf("sensors=%ld writers=%ld elapsed=%.2fs written=%llu processed=%llu lost=%llu alerts=%llu\n",
+    sensors, writers, elapsed, (unsigned long long)written.load(), (unsigned long long)processed,
+    (unsigned long long)reader->lost(), (unsigned long long)alertCount);
+  printf("throughput=%.0f samples/s busy=%.1f%% batch mean=%.1f samples, %.2f us/batch, %.1f ns/sample\n",
+    processed / elapsed, 100.0 * busy / elapsed, batches ? (double)processed / batches : 0.0,
+    batches ? busy * 1e6 / batches : 0.0, processed ? busy * 1e9 / processed : 0.0);
+  return 0;
+}
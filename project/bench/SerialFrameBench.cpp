@@ -0,0 +1,312 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SerialFrameBench.cpp
+ * FUNCTION:        Benchmark and fuzz harness for the serial framing.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bench_serial' executable.
+ *
+ * This executable:
+ * - generates a stream of --frames numbered board replies, flips bytes
+ *   with probability --noise and inserts random bursts of line noise
+ *   between frames with probability --garbage
+ * - feeds it through SerialFrameParser in --chunk byte reads, once clean
+ *   and once noisy, and reports the parse speed
+ * - checks every frame parsed against what was sent: intact frames lost
+ *   around the noise and corrupted frames wrongly accepted
+ * - converts the counts of the frames parsed with each Calibration mode,
+ *   in batches of --calibration-batch readings as edge_fake does with the
+ *   frames of one read, and one reading at a time, and reports the counts
+ *   converted per second
+ * - feeds --fuzz-mb of random bytes and reports the frames accepted
+ * - with --replay <file> parses a recorded stream instead and reports the
+ *   frames and errors; --record <file> saves the noisy stream
+ *
+ * Usage: bench_serial [--frames N] [--noise P] [--garbage P] [--chunk N]
+ *          [--calibration-batch N] [--fuzz-mb N] [--record <file>]
+ *          [--replay <file>]
+ *
+ ***/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "SerialFrame.h"
+#include "Calibration.h"
+#include "CommandLine.h"
+
+using namespace std;
+
+static double seconds(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Frame number n carries n in its temperature and humidity readings, so a
+ * parsed frame tells which one it was.
+ **/
+static SerialReading numbered(uint32_t n, mt19937 &rng)
+{
+  SerialReading reading;
+  reading.temperature = (uint16_t)n;
+  reading.humidity = (uint16_t)(n >> 16);
+  reading.rain = (uint16_t)(rng() & 0x0fff);
+  return reading;
+}
+
+/**
+ * Parses stream in chunk byte reads; returns the seconds spent.
+ **/
+static double parse(const vector<uint8_t> &stream, size_t chunk, SerialFrameParser &parser,
+  vector<SerialReading> &out)
+{
+  out.clear();
+  out.reserve(stream.size() / SERIAL_FRAME_BYTES + 1);
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (size_t i = 0; i < stream.size(); i += chunk)
+  {
+    parser.feed(&stream[i], stream.size() - i < chunk ? stream.size() - i : chunk, out);
+  }
+  return seconds(start);
+}
+
+static void report(const char *name, const vector<uint8_t> &stream, const SerialFrameParser &parser,
+  double time)
+{
+  printf("%-7s bytes=%zu frames=%llu crc_errors=%llu framing_errors=%llu skipped=%llu "
+    "speed=%.1f MB/s %.2f Mframes/s\n", name, stream.size(),
+    (unsigned long long)parser.frameCount(), (unsigned long long)parser.crcErrors(),
+    (unsigned long long)parser.framingErrors(), (unsigned long long)parser.skippedBytes(),
+    stream.size() / time / 1e6, parser.frameCount() / time / 1e6);
+}
+
+/**
+ * A calibration of mode with parameters in the range of the board counts.
+ **/
+static SensorCalibration calibrationOf(CalibrationMode mode)
+{
+  SensorCalibration calibration;
+  calibration.mode = mode;
+  calibration.terms[0] = -40.0f;
+  calibration.terms[1] = 0.01f;
+  calibration.terms[2] = 1e-6f;
+  calibration.terms[3] = -1e-10f;
+  calibration.points = CALIBRATION_POINTS;
+  for (size_t p = 0; p < calibration.points; p++)
+  {
+    calibration.counts[p] = p * 4095.0f / (calibration.points - 1);
+    calibration.values[p] = sqrtf(calibration.counts[p]);
+  }
+  calibration.threshold = 2000.0f;
+  calibration.below = 1.0f;
+  calibration.above = 0.0f;
+  return calibration;
+}
+
+/**
+ * Converts the counts of every kind of readings in batches of batch
+ * readings; returns the seconds spent and adds the values to sum, so the
+ * conversion is not optimized away.
+ **/
+static double calibrate(const Calibration &calibration, const vector<SerialReading> &readings, size_t batch,
+  double &sum)
+{
+  vector<uint16_t> counts(readings.size());
+  vector<float> values(readings.size());
+  double time = 0;
+  for (int k = 0; k < SENSOR_KIND_COUNT; k++)
+  {
+    for (size_t i = 0; i < readings.size(); i++)
+    {
+      counts[i] = readings[i].raw(k);
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < readings.size(); i += batch)
+    {
+      calibration.apply(k, &counts[i], &values[i], readings.size() - i < batch ? readings.size() - i : batch);
+    }
+    time += seconds(start);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+      sum += values[i];
+    }
+  }
+  return time;
+}
+
+static bool readFile(const char *path, vector<uint8_t> &stream)
+{
+  FILE *file = fopen(path, "rb");
+  if (file == NULL)
+  {
+    return false;
+  }
+  uint8_t buffer[65536];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    stream.insert(stream.end(), buffer, buffer + n);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  size_t chunk = (size_t)getIntOption(argc, argv, "--chunk", 4096);
+  if (chunk == 0)
+  {
+    cerr << "Error in --chunk: must be at least 1" << endl;
+    exit(1);
+  }
+  vector<SerialReading> parsed;
+
+  const char *replay = getOption(argc, argv, "--replay", NULL);
+  if (replay != NULL)
+  {
+    vector<uint8_t> stream;
+    if (!readFile(replay, stream))
+    {
+      cerr << "Error in --replay: cannot read " << replay << endl;
+      exit(1);
+    }
+    SerialFrameParser parser;
+    report("replay", stream, parser, parse(stream, chunk, parser, parsed));
+    return 0;
+  }
+
+  uint32_t frames = (uint32_t)getIntOption(argc, argv, "--frames", 1000000);
+  double noise = atof(getOption(argc, argv, "--noise", "0.0001"));
+  double garbage = atof(getOption(argc, argv, "--garbage", "0.001"));
+  size_t fuzzBytes = (size_t)getIntOption(argc, argv, "--fuzz-mb", 16) * 1024 * 1024;
+  mt19937 rng(2018);
+  uniform_real_distribution<double> chance(0.0, 1.0);
+
+  /* The clean stream and its noisy copy; corrupted[n] marks the frames
+   * the noise touched. */
+  vector<uint8_t> clean(frames * (size_t)SERIAL_FRAME_BYTES);
+  vector<uint8_t> noisy;
+  vector<uint8_t> corrupted(frames, 0);
+  noisy.reserve(clean.size() + clean.size() / 8);
+  uint64_t flipped = 0, bursts = 0;
+  for (uint32_t n = 0; n < frames; n++)
+  {
+    uint8_t *frame = &clean[n * (size_t)SERIAL_FRAME_BYTES];
+    serialEncode(numbered(n, rng), frame);
+    if (chance(rng) < garbage)
+    {
+      size_t burst = 1 + rng() % (2 * SERIAL_FRAME_BYTES);
+      for (size_t k = 0; k < burst; k++)
+      {
+        noisy.push_back((uint8_t)rng());
+      }
+      bursts++;
+    }
+    for (size_t k = 0; k < SERIAL_FRAME_BYTES; k++)
+    {
+      uint8_t byte = frame[k];
+      if (noise > 0 && chance(rng) < noise)
+      {
+        byte ^= (uint8_t)(1 + rng() % 255);
+        corrupted[n] = 1;
+        flipped++;
+      }
+      noisy.push_back(byte);
+    }
+  }
+
+  const char *record = getOption(argc, argv, "--record", NULL);
+  if (record != NULL)
+  {
+    FILE *file = fopen(record, "wb");
+    if (file == NULL || fwrite(&noisy[0], 1, noisy.size(), file) != noisy.size())
+    {
+      cerr << "Error in --record: cannot write " << record << endl;
+      exit(1);
+    }
+    fclose(file);
+  }
+
+  SerialFrameParser cleanParser;
+  double cleanTime = parse(clean, chunk, cleanParser, parsed);
+  bool ok = cleanParser.frameCount() == frames;
+  report("clean", clean, cleanParser, cleanTime);
+
+  /* Calibration: the counts of the clean frames through every mode. */
+  size_t batch = (size_t)getIntOption(argc, argv, "--calibration-batch", 64);
+  if (batch == 0)
+  {
+    cerr << "Error in --calibration-batch: must be at least 1" << endl;
+    exit(1);
+  }
+  static const struct { const char *name; CalibrationMode mode; } modes[] = {
+    { "raw", CALIBRATION_RAW }, { "poly", CALIBRATION_POLY }, { "table", CALIBRATION_TABLE },
+    { "threshold", CALIBRATION_THRESHOLD }
+  };
+  double sum = 0;
+  size_t counts = parsed.size() * SENSOR_KIND_COUNT;
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]) && !parsed.empty(); m++)
+  {
+    Calibration calibration;
+    for (int k = 0; k < SENSOR_KIND_COUNT; k++)
+    {
+      calibration.set(k, calibrationOf(modes[m].mode));
+    }
+    calibrate(calibration, parsed, batch, sum);     /* warm up, untimed */
+    double batched = calibrate(calibration, parsed, batch, sum);
+    double single = calibrate(calibration, parsed, 1, sum);
+    printf("calibrate %-9s counts=%zu batch=%zu %.1f Mcounts/s single %.1f Mcounts/s\n", modes[m].name,
+      counts, batch, counts / batched / 1e6, counts / single / 1e6);
+  }
+  printf("calibrate checksum=%g\n", sum);
+
+  SerialFrameParser noisyParser;
+  double noisyTime = parse(noisy, chunk, noisyParser, parsed);
+  report("noisy", noisy, noisyParser, noisyTime);
+
+  /* Recovery: which frames came through. */
+  vector<uint8_t> seen(frames, 0);
+  uint64_t accepted = 0, wrong = 0;
+  for (size_t i = 0; i < parsed.size(); i++)
+  {
+    uint32_t n = (uint32_t)parsed[i].temperature | (uint32_t)parsed[i].humidity << 16;
+    if (n < frames && !corrupted[n] && !seen[n])
+    {
+      seen[n] = 1;
+      accepted++;
+    }
+    else
+    {
+      wrong++;
+    }
+  }
+  uint64_t intact = 0;
+  for (uint32_t n = 0; n < frames; n++)
+  {
+    intact += corrupted[n] ? 0 : 1;
+  }
+  printf("recovery bursts=%llu flipped_bytes=%llu corrupted_frames=%llu intact_frames=%llu "
+    "recovered=%llu lost=%llu wrongly_accepted=%llu\n", (unsigned long long)bursts,
+    (unsigned long long)flipped, (unsigned long long)(frames - intact), (unsigned long long)intact,
+    (unsigned long long)accepted, (unsigned long long)(intact - accepted), (unsigned long long)wrong);
+  ok = ok && wrong == 0;
+
+  /* Fuzz: random bytes should almost never pass as a frame. */
+  vector<uint8_t> fuzz(fuzzBytes);
+  for (size_t i = 0; i < fuzz.size(); i++)
+  {
+    fuzz[i] = (uint8_t)rng();
+  }
+  SerialFrameParser fuzzParser;
+  report("fuzz", fuzz, fuzzParser, parse(fuzz, chunk, fuzzParser, parsed));
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,341 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SerializationBench.cpp
+ * FUNCTION:        Microbenchmarks of the generated EnvironmentalData types.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bench_serialization'
+ * executable, built when Google Benchmark is installed.
+ *
+ * This executable measures, for id/type strings of 0 to 50 characters:
+ * - building an Environmental sample and copying it
+ * - copying an EnvironmentalSeq, as HumidityRead does after each take
+ * - encoding and decoding it in the CDR form it has on the wire
+ * - taking from a reader on loan, into a preallocated sequence, and on
+ *   loan followed by a copy (HumidityRead)
+ *
+ * Usage: bench_serialization [--benchmark_filter=<regex>] [...]
+ *          [--qos-profile <name>]
+ *
+ * The take benchmarks need all written samples in the reader, so they
+ * use the lossless-reliable profile unless --qos-profile is given.
+ *
+ ***/
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "BenchDDS.h"
+#include "CheckStatus.h"
+#include "CommandLine.h"
+
+using namespace std;
+
+#define BENCH_TOPIC "bench_serialization"
+
+static vector<char *> arguments;
+
+static string text(size_t length, char fill)
+{
+  return string(length < BENCH_MAX_PAYLOAD ? length : BENCH_MAX_PAYLOAD, fill);
+}
+
+static void fill(EnvironmentalData::Environmental &sample, const string &id, const string &type)
+{
+  sample.id = DDS::string_dup(id.c_str());
+  sample.type = DDS::string_dup(type.c_str());
+  sample.value = 69.36f;
+}
+
+/*
+ * CDR (little endian, with the encapsulation header) as DDSI puts
+ * Environmental on the wire: for each string a 4 byte length including
+ * the terminator, the characters and the terminator, then the float
+ * aligned to 4 bytes.
+ */
+static size_t align4(size_t position)
+{
+  return (position + 3) & ~(size_t)3;
+}
+
+static size_t cdrSize(const EnvironmentalData::Environmental &sample)
+{
+  size_t position = 4;
+  position = align4(position) + 4 + strlen(sample.id) + 1;
+  position = align4(position) + 4 + strlen(sample.type) + 1;
+  return align4(position) + 4;
+}
+
+static size_t putString(char *out, size_t position, const char *value)
+{
+  uint32_t length = (uint32_t)strlen(value) + 1;
+  position = align4(position);
+  memcpy(out + position, &length, 4);
+  memcpy(out + position + 4, value, length);
+  return position + 4 + length;
+}
+
+static size_t cdrEncode(const EnvironmentalData::Environmental &sample, char *out)
+{
+  static const char header[4] = { 0x00, 0x01, 0x00, 0x00 };
+  memcpy(out, header, 4);
+  size_t position = putString(out, 4, sample.id);
+  position = putString(out, position, sample.type);
+  position = align4(position);
+  float value = sample.value;
+  memcpy(out + position, &value, 4);
+  return position + 4;
+}
+
+static const char *getString(const char *in, size_t size, size_t &position)
+{
+  uint32_t length;
+  position = align4(position);
+  if (position + 4 > size)
+  {
+    return NULL;
+  }
+  memcpy(&length, in + position, 4);
+  const char *value = in + position + 4;
+  if (length == 0 || position + 4 + length > size || value[length - 1] != '\0')
+  {
+    return NULL;
+  }
+  position += 4 + length;
+  return value;
+}
+
+static bool cdrDecode(const char *in, size_t size, EnvironmentalData::Environmental &sample)
+{
+  size_t position = 4;
+  const char *id = getString(in, size, position);
+  const char *type = getString(in, size, position);
+  position = align4(position);
+  if (id == NULL || type == NULL || position + 4 > size)
+  {
+    return false;
+  }
+  sample.id = DDS::string_dup(id);
+  sample.type = DDS::string_dup(type);
+  float value;
+  memcpy(&value, in + position, 4);
+  sample.value = value;
+  return true;
+}
+
+static void BM_Build(benchmark::State &state)
+{
+  string id = text(state.range(0), 'i');
+  string type = text(state.range(0), 't');
+  for (auto _ : state)
+  {
+    EnvironmentalData::Environmental sample;
+    fill(sample, id, type);
+    benchmark::DoNotOptimize(sample);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_Copy(benchmark::State &state)
+{
+  EnvironmentalData::Environmental source;
+  fill(source, text(state.range(0), 'i'), text(state.range(0), 't'));
+  for (auto _ : state)
+  {
+    EnvironmentalData::Environmental copy(source);
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_SeqCopy(benchmark::State &state)
+{
+  EnvironmentalData::EnvironmentalSeq source;
+  source.length((DDS::ULong)state.range(1));
+  for (DDS::ULong i = 0; i < source.length(); i++)
+  {
+    fill(source[i], text(state.range(0), 'i'), text(state.range(0), 't'));
+  }
+  EnvironmentalData::EnvironmentalSeq copy;
+  for (auto _ : state)
+  {
+    copy = source;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+static void BM_Serialize(benchmark::State &state)
+{
+  EnvironmentalData::Environmental sample;
+  fill(sample, text(state.range(0), 'i'), text(state.range(0), 't'));
+  vector<char> buffer(cdrSize(sample));
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(cdrEncode(sample, &buffer[0]));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+static void BM_Deserialize(benchmark::State &state)
+{
+  EnvironmentalData::Environmental sample;
+  fill(sample, text(state.range(0), 'i'), text(state.range(0), 't'));
+  vector<char> buffer(cdrSize(sample));
+  cdrEncode(sample, &buffer[0]);
+  for (auto _ : state)
+  {
+    EnvironmentalData::Environmental decoded;
+    if (!cdrDecode(&buffer[0], buffer.size(), decoded))
+    {
+      state.SkipWithError("decode failed");
+      break;
+    }
+    benchmark::DoNotOptimize(decoded);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+enum TakeMode
+{
+    TAKE_LOAN,
+    TAKE_COPY,
+    TAKE_LOAN_THEN_COPY
+};
+
+/**
+ * Writer and reader on one participant, created on first use.
+ **/
+struct TakeFixture
+{
+    BenchParticipant participant;
+    EnvironmentalData::EnvironmentalDataWriter_var writer;
+    EnvironmentalData::EnvironmentalDataReader_var reader;
+    DDS::ReadCondition_var condition;
+    DDS::WaitSet_var waitset;
+
+    TakeFixture()
+      : participant((int)arguments.size() - 1, &arguments[0])
+    {
+      reader = participant.createReader(BENCH_TOPIC);
+      writer = participant.createWriter(BENCH_TOPIC);
+      condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+        DDS::ANY_INSTANCE_STATE);
+      waitset = new DDS::WaitSet();
+      checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+      benchWaitForReader(writer, 5000);
+    }
+
+    ~TakeFixture()
+    {
+      checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+    }
+};
+
+static TakeFixture &takeFixture()
+{
+  static TakeFixture fixture;
+  return fixture;
+}
+
+static void BM_Take(benchmark::State &state, TakeMode mode)
+{
+  TakeFixture &fixture = takeFixture();
+  DDS::Long count = (DDS::Long)state.range(1);
+  EnvironmentalData::Environmental sample;
+  fill(sample, text(state.range(0), 'i'), text(state.range(0), 't'));
+
+  EnvironmentalData::EnvironmentalSeq samples;
+  DDS::SampleInfoSeq infos;
+  EnvironmentalData::EnvironmentalSeq copy;
+  int64_t taken = 0;
+  for (auto _ : state)
+  {
+    state.PauseTiming();
+    for (DDS::Long i = 0; i < count; i++)
+    {
+      checkStatus(fixture.writer->write(sample, DDS::HANDLE_NIL), "EnvironmentalDataWriter::write");
+    }
+    DDS::ConditionSeq active;
+    DDS::Duration_t timeout = { 1, 0 };
+    fixture.waitset->wait(active, timeout);
+    if (mode == TAKE_COPY)
+    {
+      /* A sequence with buffers makes take copy instead of loan. */
+      samples.length(count);
+      infos.length(count);
+    }
+    state.ResumeTiming();
+
+    checkStatus(fixture.reader->take(samples, infos, count, DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+      DDS::ANY_INSTANCE_STATE), "EnvironmentalDataReader::take");
+    taken += samples.length();
+    if (mode == TAKE_LOAN_THEN_COPY)
+    {
+      copy = samples;
+      benchmark::DoNotOptimize(copy);
+    }
+    if (mode != TAKE_COPY)
+    {
+      checkStatus(fixture.reader->return_loan(samples, infos), "EnvironmentalDataReader::return_loan");
+    }
+  }
+  state.SetItemsProcessed(taken);
+}
+
+static void lengths(benchmark::internal::Benchmark *b)
+{
+  const int sizes[] = { 0, 8, 16, 32, 50 };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    b->Arg(sizes[i]);
+  }
+}
+
+static void lengthsAndCounts(benchmark::internal::Benchmark *b)
+{
+  const int sizes[] = { 0, 8, 16, 32, 50 };
+  const int counts[] = { 1, 16, 256 };
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+  {
+    for (size_t j = 0; j < sizeof(counts) / sizeof(counts[0]); j++)
+    {
+      b->Args({ sizes[i], counts[j] });
+    }
+  }
+}
+
+BENCHMARK(BM_Build)->Apply(lengths);
+BENCHMARK(BM_Copy)->Apply(lengths);
+BENCHMARK(BM_SeqCopy)->Apply(lengthsAndCounts);
+BENCHMARK(BM_Serialize)->Apply(lengths);
+BENCHMARK(BM_Deserialize)->Apply(lengths);
+BENCHMARK_CAPTURE(BM_Take, loan, TAKE_LOAN)->Apply(lengthsAndCounts);
+BENCHMARK_CAPTURE(BM_Take, copy, TAKE_COPY)->Apply(lengthsAndCounts);
+BENCHMARK_CAPTURE(BM_Take, loan_then_copy, TAKE_LOAN_THEN_COPY)->Apply(lengthsAndCounts);
+
+int main(int argc, char *argv[])
+{
+  benchmark::Initialize(&argc, argv);
+
+  /* What Google Benchmark left are our options. */
+  arguments.assign(argv, argv + argc);
+  static char profileOption[] = "--qos-profile";
+  static char profile[] = "lossless-reliable";
+  if (getOption(argc, argv, "--qos-profile", NULL) == NULL)
+  {
+    arguments.push_back(profileOption);
+    arguments.push_back(profile);
+  }
+  arguments.push_back(NULL);
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,369 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    ThroughputBench.cpp
+ * FUNCTION:        Sustained throughput benchmark over DDS.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bench_throughput'
+ * executable.
+ *
+ * This executable:
+ * - writes EnvironmentalData samples on the "bench_throughput" topic in
+ *   bursts of --batches samples, for every --payloads id/type length
+ * - takes them back on a reader, counting samples and sequence gaps
+ * - reports samples/s, MB/s and loss per run and appends them to the
+ *   --results file as JSON lines
+ *
+ * Usage: bench_throughput [--role both|pub|sub] [--payloads 16,32,50]
+ *          [--batches 1,10,100] [--seconds 5] [--burst-interval-us 0]
+ *          [--results bench_results.jsonl] [--qos-profile <name>]
+ *
+ * "both" runs writer and reader on two participants of one process. For
+ * a run between two processes or nodes, start "--role sub" first, then
+ * "--role pub" with the same lists; the subscriber reports a run when
+ * the next one starts or after two idle seconds, and stops on Ctrl-C.
+ *
+ ***/
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "BenchDDS.h"
+#include "CheckStatus.h"
+#include "CommandLine.h"
+
+using namespace std;
+
+#define BENCH_TOPIC "bench_throughput"
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void interrupt(int signum)
+{
+  interrupted = 1;
+}
+
+static double seconds(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+struct WriterStats
+{
+    uint64_t written;
+    uint64_t timeouts;
+    double seconds;
+};
+
+/**
+ * What the reader saw of one run, told apart by the tag in the sample id.
+ **/
+struct ReaderStats
+{
+    string tag;
+    uint64_t received;
+    uint64_t lost;
+    uint64_t reordered;
+    uint64_t next_sequence;
+    chrono::steady_clock::time_point first;
+    chrono::steady_clock::time_point last;
+
+    void reset(const string &runTag)
+    {
+      tag = runTag;
+      received = 0;
+      lost = 0;
+      reordered = 0;
+      next_sequence = 0;
+    }
+};
+
+/**
+ * Takes everything available and accounts it to the run of each sample.
+ * Calls report() when a sample of a new run shows up.
+ **/
+template <typename Report>
+static void takeSamples(EnvironmentalData::EnvironmentalDataReader_ptr reader, ReaderStats &stats,
+  Report report)
+{
+  EnvironmentalData::EnvironmentalSeq samples;
+  DDS::SampleInfoSeq infos;
+  DDS::ReturnCode_t status = reader->take(samples, infos, DDS::LENGTH_UNLIMITED,
+    DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+  checkStatus(status, "EnvironmentalDataReader::take");
+
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  string tag;
+  uint64_t sequence;
+  for (DDS::ULong i = 0; i < samples.length(); i++)
+  {
+    if (!infos[i].valid_data || !benchParse(samples[i].id, tag, sequence))
+    {
+      continue;
+    }
+    if (tag != stats.tag)
+    {
+      if (stats.received > 0)
+      {
+        report(stats);
+      }
+      stats.reset(tag);
+      stats.first = now;
+    }
+    if (sequence >= stats.next_sequence)
+    {
+      stats.lost += sequence - stats.next_sequence;
+      stats.next_sequence = sequence + 1;
+    }
+    else
+    {
+      /* Late, or a duplicate when nothing was counted as lost. */
+      stats.reordered++;
+      stats.lost -= stats.lost > 0 ? 1 : 0;
+    }
+    stats.received++;
+    stats.last = now;
+  }
+  checkStatus(reader->return_loan(samples, infos), "EnvironmentalDataReader::return_loan");
+}
+
+/**
+ * Waits for data on reader for at most timeoutMs.
+ **/
+static void waitForData(DDS::WaitSet_ptr waitset, int64_t timeoutMs)
+{
+  DDS::ConditionSeq active;
+  DDS::Duration_t timeout = { (DDS::Long)(timeoutMs / 1000), (DDS::ULong)(timeoutMs % 1000 * 1000000) };
+  DDS::ReturnCode_t status = waitset->wait(active, timeout);
+  if (status != DDS::RETCODE_TIMEOUT)
+  {
+    checkStatus(status, "WaitSet::wait");
+  }
+}
+
+static string runTag(long payload, long batch)
+{
+  return "p" + to_string(payload) + "b" + to_string(batch);
+}
+
+static WriterStats writeRun(EnvironmentalData::EnvironmentalDataWriter_ptr writer, const string &tag,
+  long payload, long batch, double duration, long burstIntervalUs)
+{
+  WriterStats stats = WriterStats();
+  EnvironmentalData::Environmental sample;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (!interrupted && seconds(start) < duration)
+  {
+    for (long i = 0; i < batch; i++)
+    {
+      benchFill(sample, tag.c_str(), stats.written + stats.timeouts, payload);
+      DDS::ReturnCode_t status = writer->write(sample, DDS::HANDLE_NIL);
+      if (status == DDS::RETCODE_TIMEOUT)
+      {
+        /* A reliable writer blocked longer than max_blocking_time. */
+        stats.timeouts++;
+        continue;
+      }
+      checkStatus(status, "EnvironmentalDataWriter::write");
+      stats.written++;
+    }
+    if (burstIntervalUs > 0)
+    {
+      this_thread::sleep_for(chrono::microseconds(burstIntervalUs));
+    }
+    else
+    {
+      this_thread::yield();
+    }
+  }
+  stats.seconds = seconds(start);
+  return stats;
+}
+
+static void printRun(const char *role, long payload, long batch, uint64_t samples, double elapsed,
+  uint64_t lost, uint64_t timeouts)
+{
+  double rate = elapsed > 0 ? samples / elapsed : 0.0;
+  printf("%-4s payload=%-3ld batch=%-5ld samples=%-10llu rate=%.0f/s %.2f MB/s lost=%llu timeouts=%llu\n",
+    role, payload, batch, (unsigned long long)samples, rate, rate * benchSampleBytes(payload) / 1e6,
+    (unsigned long long)lost, (unsigned long long)timeouts);
+  fflush(stdout);
+}
+
+static void recordRun(BenchResults &results, const char *role, const char *profile, long payload,
+  long batch, double elapsed, uint64_t written, uint64_t timeouts, uint64_t received, uint64_t lost,
+  uint64_t reordered)
+{
+  results.begin("throughput");
+  results.field("role", role);
+  results.field("qos", profile);
+  results.field("payload", (double)payload);
+  results.field("sample_bytes", (double)benchSampleBytes(payload));
+  results.field("batch", (double)batch);
+  results.field("seconds", elapsed);
+  if (written > 0 || timeouts > 0)
+  {
+    results.field("written", (double)written);
+    results.field("write_timeouts", (double)timeouts);
+  }
+  if (strcmp(role, "pub") != 0)
+  {
+    double rate = elapsed > 0 ? received / elapsed : 0.0;
+    results.field("received", (double)received);
+    results.field("lost", (double)lost);
+    results.field("reordered", (double)reordered);
+    results.field("samples_per_s", rate);
+    results.field("mb_per_s", rate * benchSampleBytes(payload) / 1e6);
+    results.field("loss", received + lost > 0 ? (double)lost / (received + lost) : 0.0);
+  }
+  results.end();
+}
+
+int main(int argc, char *argv[])
+{
+  const char *role = getOption(argc, argv, "--role", "both");
+  vector<long> payloads = benchList(getOption(argc, argv, "--payloads", "16,32,50"));
+  vector<long> batches = benchList(getOption(argc, argv, "--batches", "1,10,100"));
+  double duration = getIntOption(argc, argv, "--seconds", 5);
+  long burstIntervalUs = getIntOption(argc, argv, "--burst-interval-us", 0);
+  const char *profile = qosProfile(argc, argv, BENCH_TOPIC);
+  bool publish = strcmp(role, "both") == 0 || strcmp(role, "pub") == 0;
+  bool subscribe = strcmp(role, "both") == 0 || strcmp(role, "sub") == 0;
+  if (!publish && !subscribe)
+  {
+    cerr << "Error in --role: expected both, pub or sub" << endl;
+    return 1;
+  }
+
+  BenchResults results;
+  results.open(getOption(argc, argv, "--results", "bench_results.jsonl"));
+  signal(SIGINT, interrupt);
+  signal(SIGTERM, interrupt);
+
+  BenchParticipant publisherSide(argc, argv);
+  BenchParticipant subscriberSide(argc, argv);
+
+  if (!publish)
+  {
+    /* Subscriber only: report each run as the next one starts. */
+    EnvironmentalData::EnvironmentalDataReader_var reader = subscriberSide.createReader(BENCH_TOPIC);
+    DDS::ReadCondition_var condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE,
+      DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
+    DDS::WaitSet_var waitset = new DDS::WaitSet();
+    checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+
+    ReaderStats stats;
+    stats.reset("");
+    auto report = [&](const ReaderStats &run) {
+      long payload = 0, batch = 0;
+      sscanf(run.tag.c_str(), "p%ldb%ld", &payload, &batch);
+      double elapsed = chrono::duration<double>(run.last - run.first).count();
+      printRun("sub", payload, batch, run.received, elapsed, run.lost, 0);
+      recordRun(results, "sub", profile, payload, batch, elapsed, 0, 0, run.received, run.lost,
+        run.reordered);
+    };
+    cout << "=== [bench_throughput] Waiting for samples ..." << endl;
+    while (!interrupted)
+    {
+      waitForData(waitset, 100);
+      takeSamples(reader, stats, report);
+      if (stats.received > 0 && chrono::steady_clock::now() - stats.last > chrono::seconds(2))
+      {
+        report(stats);
+        stats.reset("");
+      }
+    }
+    if (stats.received > 0)
+    {
+      report(stats);
+    }
+    checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+    subscriberSide.deleteReader(reader);
+    return 0;
+  }
+
+  for (size_t p = 0; p < payloads.size() && !interrupted; p++)
+  {
+    for (size_t b = 0; b < batches.size() && !interrupted; b++)
+    {
+      long payload = payloads[p];
+      long batch = batches[b] > 0 ? batches[b] : 1;
+      string tag = runTag(payload, batch);
+
+      /* Fresh entities per run so no history carries over. */
+      EnvironmentalData::EnvironmentalDataReader_var reader;
+      DDS::ReadCondition_var condition;
+      DDS::WaitSet_var waitset = new DDS::WaitSet();
+      if (subscribe)
+      {
+        reader = subscriberSide.createReader(BENCH_TOPIC);
+        condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+          DDS::ANY_INSTANCE_STATE);
+        checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+      }
+      EnvironmentalData::EnvironmentalDataWriter_var writer = publisherSide.createWriter(BENCH_TOPIC);
+      if (!benchWaitForReader(writer, subscribe ? 5000 : 30000))
+      {
+        cerr << "Error in bench_throughput: no reader matched on " << BENCH_TOPIC << endl;
+        return 1;
+      }
+
+      ReaderStats stats;
+      stats.reset(tag);
+      atomic<bool> writing(true);
+      thread receiver;
+      if (subscribe)
+      {
+        receiver = thread([&]() {
+          auto ignore = [](const ReaderStats &) {};
+          chrono::steady_clock::time_point quiet = chrono::steady_clock::now();
+          uint64_t seen = 0;
+          /* Drain until nothing arrived for 500 ms after the writer stopped. */
+          while (writing || chrono::steady_clock::now() - quiet < chrono::milliseconds(500))
+          {
+            waitForData(waitset, 100);
+            takeSamples(reader, stats, ignore);
+            if (stats.received != seen)
+            {
+              seen = stats.received;
+              quiet = chrono::steady_clock::now();
+            }
+          }
+        });
+      }
+
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      WriterStats written = writeRun(writer, tag, payload, batch, duration, burstIntervalUs);
+      writing = false;
+      if (subscribe)
+      {
+        receiver.join();
+        /* Samples never received at the end of the run are lost too; the
+         * sequence also counts writes that timed out. */
+        uint64_t attempts = written.written + written.timeouts;
+        stats.lost += attempts > stats.next_sequence ? attempts - stats.next_sequence : 0;
+        double elapsed = chrono::duration<double>(stats.last - start).count();
+        printRun("both", payload, batch, stats.received, elapsed, stats.lost, written.timeouts);
+        recordRun(results, "both", profile, payload, batch, elapsed, written.written, written.timeouts,
+          stats.received, stats.lost, stats.reordered);
+        checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+        subscriberSide.deleteReader(reader);
+      }
+      else
+      {
+        printRun("pub", payload, batch, written.written, written.seconds, 0, written.timeouts);
+        recordRun(results, "pub", profile, payload, batch, written.seconds, written.written,
+          written.timeouts, 0, 0, 0);
+      }
+      publisherSide.deleteWriter(writer);
+    }
+  }
+  return 0;
+}
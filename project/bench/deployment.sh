@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+#
+# Compares the shared memory and the network OpenSplice deployments for
+# processes on one box: runs bench_throughput and bench_pingpong with
+# publisher and subscriber in two processes under ospl_shmem.xml and
+# ospl_network.xml.
+#
+# Usage: bench/deployment.sh [build directory] [deployment ...]
+#
+# Environment:
+#   PAYLOADS   id/type lengths (default 16,50)
+#   BATCHES    bench_throughput burst sizes (default 1,100)
+#   SECONDS_PER_RUN  bench_throughput seconds per run (default 5)
+#   SAMPLES    bench_pingpong round trips per payload (default 10000)
+#   PROFILE    QoS profile (default high-throughput)
+#   RESULTS    JSON lines file the runs are appended to; every line has
+#              a "deployment" field (default bench_results.jsonl)
+#
+# Needs the OpenSplice environment (release.com) to be sourced.
+
+PROJECT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=${1:-build}
+shift
+DEPLOYMENTS=${@:-network shmem}
+
+PAYLOADS=${PAYLOADS:-16,50}
+BATCHES=${BATCHES:-1,100}
+SECONDS_PER_RUN=${SECONDS_PER_RUN:-5}
+SAMPLES=${SAMPLES:-10000}
+PROFILE=${PROFILE:-high-throughput}
+RESULTS=${RESULTS:-bench_results.jsonl}
+
+if [ ! -x "$BUILD/bench_throughput" ] || [ ! -x "$BUILD/bench_pingpong" ]; then
+    echo "Error in $0: bench_throughput and bench_pingpong not found in $BUILD" >&2
+    exit 1
+fi
+if ! command -v ospl > /dev/null; then
+    echo "Error in $0: ospl not found, source release.com first" >&2
+    exit 1
+fi
+
+PIDS=""
+SHMEM_RUNNING=0
+cleanup() {
+    kill -INT $PIDS 2>/dev/null
+    wait $PIDS 2>/dev/null
+    if [ $SHMEM_RUNNING -eq 1 ]; then
+        ospl stop
+    fi
+}
+trap cleanup EXIT
+
+cd "$BUILD"
+cp "$PROJECT/DDS_DefaultQoS.xml" .
+OPTIONS="--qos-profile $PROFILE --payloads $PAYLOADS --results $RESULTS"
+
+for DEPLOYMENT in $DEPLOYMENTS; do
+    export OSPL_URI="file://$PROJECT/ospl_$DEPLOYMENT.xml"
+    echo "=== $DEPLOYMENT ($OSPL_URI)"
+    if [ "$DEPLOYMENT" == "shmem" ]; then
+        ospl start || exit 1
+        SHMEM_RUNNING=1
+    fi
+
+    # The subscriber reports a run after two idle seconds; stop it once
+    # the publisher is done and it had the time to.
+    ./bench_throughput --role sub $OPTIONS &
+    PIDS=$!
+    sleep 2
+    ./bench_throughput --role pub $OPTIONS --batches "$BATCHES" --seconds "$SECONDS_PER_RUN"
+    sleep 3
+    kill -INT $PIDS
+    wait $PIDS
+
+    ./bench_pingpong --role pong $OPTIONS &
+    PIDS=$!
+    sleep 2
+    ./bench_pingpong --role ping $OPTIONS --samples "$SAMPLES"
+    kill -INT $PIDS
+    wait $PIDS
+    PIDS=""
+
+    if [ "$DEPLOYMENT" == "shmem" ]; then
+        ospl stop
+        SHMEM_RUNNING=0
+    fi
+done
+
+echo "=== Results appended to $BUILD/$RESULTS"
@@ -0,0 +1,143 @@
+#!/usr/bin/env bash
+#
+# Runs edge_fake and c2 under every QoS profile of DDS_DefaultQoS.xml and
+# reports throughput and latency of the humidity topic, read from the
+# Prometheus metrics of both processes.
+#
+# Usage: bench/qos_profiles.sh [build directory] [profile ...]
+#
+# Environment:
+#   DURATION   measured seconds per profile (default 20)
+#   WARMUP     seconds before the measurement starts (default 3)
+#   PERIOD_US  edge_fake time between two rounds of readings (default 1000)
+#   POLL_US    c2 time between two takes (default 1000)
+#   PUBLISHERS edge_fake processes, each with its own node id (default 1)
+#   RESULTS    file the tab separated results are appended to
+#
+# The latency is the delay from the source timestamp to the take, so it
+# includes up to POLL_US of polling delay and has millisecond resolution.
+# The late-joiner-transient profile needs the durability service, which
+# ospl_shmem.xml and ospl_network.xml enable (select one with OSPL_URI).
+
+BUILD=${1:-build}
+shift
+PROFILES=${@:-DefaultQosProfile low-latency high-throughput lossless-reliable late-joiner-transient}
+
+DURATION=${DURATION:-20}
+WARMUP=${WARMUP:-3}
+PERIOD_US=${PERIOD_US:-1000}
+POLL_US=${POLL_US:-1000}
+PUBLISHERS=${PUBLISHERS:-1}
+RESULTS=${RESULTS:-qos_profiles.tsv}
+
+C2_PORT=9464
+EDGE_PORT=9465
+
+if [ ! -x "$BUILD/c2" ] || [ ! -x "$BUILD/edge_fake" ]; then
+    echo "Error in $0: c2 and edge_fake not found in $BUILD" >&2
+    exit 1
+fi
+
+# Sum of the samples of a metric whose name and labels start with $2.
+metric() {
+    awk -v prefix="$2" 'index($1, prefix) == 1 { sum += $2 } END { printf "%.0f\n", sum }' "$1"
+}
+
+# Upper bound of the latency bucket holding quantile $3 of the samples
+# added between the scrapes $1 and $2.
+quantile() {
+    paste "$1" "$2" | awk -v q="$3" '
+        BEGIN { n = 0 }
+        $1 ~ /^stack_sample_latency_seconds_bucket\{topic="humidity"/ {
+            match($1, /le="[^"]*"/)
+            le[n] = substr($1, RSTART + 4, RLENGTH - 5)
+            count[n++] = $4 - $2
+        }
+        END {
+            total = count[n - 1]
+            if (total == 0) { print "-"; exit }
+            for (i = 0; i < n; i++) {
+                if (count[i] >= q * total) { print le[i]; exit }
+            }
+        }'
+}
+
+scrape() {
+    curl -s "http://127.0.0.1:$1/metrics" > "$2"
+}
+
+cleanup() {
+    kill $PIDS 2>/dev/null
+    wait $PIDS 2>/dev/null
+}
+trap cleanup EXIT
+
+TMP=$(mktemp -d)
+cd "$BUILD"
+
+if [ ! -f "$RESULTS" ]; then
+    printf "profile\twritten_per_s\treceived_per_s\tdelivered\tlost\trejected\tlatency_mean_ms\tlatency_p50_s\tlatency_p99_s\twrite_mean_us\n" > "$RESULTS"
+fi
+printf "%-24s %12s %12s %10s %8s %12s %10s %10s %10s\n" \
+    profile written/s received/s delivered lost "latency ms" "p50 s" "p99 s" "write us"
+
+for PROFILE in $PROFILES; do
+    PIDS=""
+    ./c2 --qos-profile "$PROFILE" --poll-us "$POLL_US" --sink-file /dev/null \
+        --metrics-port $C2_PORT > "$TMP/c2.log" 2>&1 &
+    PIDS="$PIDS $!"
+    sleep 1
+    for NODE in $(seq 1 "$PUBLISHERS"); do
+        ./edge_fake "$NODE" --qos-profile "$PROFILE" --period-us "$PERIOD_US" \
+            --metrics-port $((EDGE_PORT + NODE - 1)) > "$TMP/edge_fake.$NODE.log" 2>&1 &
+        PIDS="$PIDS $!"
+    done
+    sleep "$WARMUP"
+
+    scrape $C2_PORT "$TMP/c2.before"
+    for NODE in $(seq 1 "$PUBLISHERS"); do
+        scrape $((EDGE_PORT + NODE - 1)) "$TMP/edge.$NODE.before"
+    done
+    sleep "$DURATION"
+    scrape $C2_PORT "$TMP/c2.after"
+    for NODE in $(seq 1 "$PUBLISHERS"); do
+        scrape $((EDGE_PORT + NODE - 1)) "$TMP/edge.$NODE.after"
+    done
+
+    cleanup
+    PIDS=""
+
+    WRITTEN=0
+    WRITE_TIME=0
+    for NODE in $(seq 1 "$PUBLISHERS"); do
+        W0=$(metric "$TMP/edge.$NODE.before" 'stack_samples_written_total{topic="humidity"}')
+        W1=$(metric "$TMP/edge.$NODE.after" 'stack_samples_written_total{topic="humidity"}')
+        T0=$(awk '$1 == "stack_write_duration_seconds_sum{topic=\"humidity\"}" { print $2 }' "$TMP/edge.$NODE.before")
+        T1=$(awk '$1 == "stack_write_duration_seconds_sum{topic=\"humidity\"}" { print $2 }' "$TMP/edge.$NODE.after")
+        WRITTEN=$((WRITTEN + W1 - W0))
+        WRITE_TIME=$(awk -v a="$WRITE_TIME" -v b="${T0:-0}" -v c="${T1:-0}" 'BEGIN { print a + c - b }')
+    done
+
+    R0=$(metric "$TMP/c2.before" 'stack_samples_received_total{topic="humidity"}')
+    R1=$(metric "$TMP/c2.after" 'stack_samples_received_total{topic="humidity"}')
+    L0=$(metric "$TMP/c2.before" 'stack_reader_samples_lost_total{topic="humidity"}')
+    L1=$(metric "$TMP/c2.after" 'stack_reader_samples_lost_total{topic="humidity"}')
+    J0=$(metric "$TMP/c2.before" 'stack_reader_samples_rejected_total{topic="humidity"}')
+    J1=$(metric "$TMP/c2.after" 'stack_reader_samples_rejected_total{topic="humidity"}')
+    S0=$(awk '$1 == "stack_sample_latency_seconds_sum{topic=\"humidity\"}" { print $2 }' "$TMP/c2.before")
+    S1=$(awk '$1 == "stack_sample_latency_seconds_sum{topic=\"humidity\"}" { print $2 }' "$TMP/c2.after")
+    RECEIVED=$((R1 - R0))
+
+    LINE=$(awk -v p="$PROFILE" -v w="$WRITTEN" -v r="$RECEIVED" -v d="$DURATION" \
+        -v l=$((L1 - L0)) -v j=$((J1 - J0)) -v s0="${S0:-0}" -v s1="${S1:-0}" -v wt="$WRITE_TIME" \
+        -v p50="$(quantile "$TMP/c2.before" "$TMP/c2.after" 0.5)" \
+        -v p99="$(quantile "$TMP/c2.before" "$TMP/c2.after" 0.99)" 'BEGIN {
+            printf "%s\t%.1f\t%.1f\t%.4f\t%d\t%d\t%.3f\t%s\t%s\t%.2f\n", p, w / d, r / d,
+                w > 0 ? r / w : 0, l, j, r > 0 ? (s1 - s0) * 1000 / r : 0, p50, p99,
+                w > 0 ? wt * 1000000 / w : 0
+        }')
+    echo "$LINE" >> "$RESULTS"
+    echo "$LINE" | awk -F'\t' '{ printf "%-24s %12s %12s %10s %8s %12s %10s %10s %10s\n", $1, $2, $3, $4, $5, $7, $8, $9, $10 }'
+done
+
+rm -rf "$TMP"
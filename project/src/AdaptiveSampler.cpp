@@ -0,0 +1,64 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    AdaptiveSampler.cpp
+ * FUNCTION:        Sampling period following the dynamics of a signal.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the adaptive sampling.
+ *
+ ***/
+
+#include <math.h>
+#include "AdaptiveSampler.h"
+
+AdaptiveConfig::AdaptiveConfig()
+  : fast_us(100000), slow_us(10000000), rate_limit(0.5f), sigma_limit(1.0f), alpha(0.1f), backoff(2.0f)
+{
+}
+
+AdaptiveSampler::AdaptiveSampler(const AdaptiveConfig &config)
+  : config(config), period(config.fast_us), last_time(0), last_value(0.0f), mean(0.0f), variance(0.0f),
+    started(false), active(true), changes(0)
+{
+}
+
+int64_t AdaptiveSampler::update(int64_t now, float value)
+{
+  if (!started)
+  {
+    started = true;
+    last_time = now;
+    last_value = value;
+    mean = value;
+    return period;
+  }
+
+  double elapsed = (now - last_time) / 1e6;
+  float rate = elapsed > 0 ? (float)(fabs(value - last_value) / elapsed) : 0.0f;
+  float delta = value - mean;
+  mean += config.alpha * delta;
+  variance = (1.0f - config.alpha) * (variance + config.alpha * delta * delta);
+  last_time = now;
+  last_value = value;
+
+  bool moving = (config.rate_limit > 0 && rate > config.rate_limit) ||
+    (config.sigma_limit > 0 && variance > config.sigma_limit * config.sigma_limit);
+  if (moving != active)
+  {
+    active = moving;
+    changes++;
+  }
+
+  if (moving)
+  {
+    period = config.fast_us;
+  }
+  else
+  {
+    double grown = period * (double)config.backoff;
+    period = grown < config.slow_us ? (int64_t)grown : config.slow_us;
+  }
+  return period;
+}
@@ -0,0 +1,71 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    AdaptiveSampler.h
+ * FUNCTION:        Sampling period following the dynamics of a signal.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the adaptive sampling of the edge
+ * nodes. One sampler per sensor picks the time until its next reading
+ * from the readings so far:
+ *
+ *   active  the change per second since the previous reading is above
+ *           rate_limit, or the standard deviation of the recent readings
+ *           (exponentially weighted, alpha) is above sigma_limit: the
+ *           period drops to fast_us at once
+ *   steady  otherwise the period grows by backoff per reading, up to
+ *           slow_us
+ *
+ * so a signal that moves is read and published at the full rate and a
+ * flat one only every slow_us. A limit of 0 disables its rule.
+ *
+ ***/
+
+#ifndef __ADAPTIVESAMPLER_H__
+  #define __ADAPTIVESAMPLER_H__
+
+  #include <stdint.h>
+
+  struct AdaptiveConfig
+  {
+      int64_t fast_us;          /* period while the signal moves */
+      int64_t slow_us;          /* period of a steady signal, the floor rate */
+      float   rate_limit;       /* change per second, 0 disables */
+      float   sigma_limit;      /* standard deviation, 0 disables */
+      float   alpha;            /* weight of a new reading in the mean */
+      float   backoff;          /* period growth per steady reading */
+
+      AdaptiveConfig();
+  };
+
+  class AdaptiveSampler
+  {
+      AdaptiveConfig config;
+      int64_t period;
+      int64_t last_time;
+      float   last_value;
+      float   mean;
+      float   variance;
+      bool    started;
+      bool    active;
+      uint64_t changes;
+    public:
+      AdaptiveSampler(const AdaptiveConfig &config = AdaptiveConfig());
+
+      /**
+       * Takes the reading value at now (us) and returns the period until
+       * the next one (us).
+       **/
+      int64_t update(int64_t now, float value);
+
+      int64_t periodUs() const { return period; }
+      bool isActive() const { return active; }
+
+      /**
+       * Switches between active and steady so far.
+       **/
+      uint64_t changeCount() const { return changes; }
+  };
+
+#endif
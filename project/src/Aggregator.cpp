@@ -0,0 +1,235 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Aggregator.cpp
+ * FUNCTION:        Aggregator tier between the edge nodes and c2.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'aggregator' executable.
+ *
+ * This executable:
+ * - takes the readings of the --topics topics from the edge nodes of its
+ *   shards (--shards / --shard-set, see Sharding.h) every --poll-us
+ * - reduces them per sensor over windows of --window-ms (see
+ *   SensorAggregator.h)
+ * - republishes one sample per sensor and window upstream, in partition
+ *   --upstream-partition of its domain or of domain --upstream-domain:
+ *     summary     SensorSummary (min, max, mean, last, count) on the
+ *                 topic "<topic>_summary" (default)
+ *     downsample  the --reduce (last, mean, min or max) value as a plain
+ *                 reading on the same topic, so an unchanged c2 run with
+ *                 --partition <upstream partition> consumes it
+ *
+ * Usage: aggregator [--topics humidity,temperature,rain]
+ *          [--shards <n> --shard-set <list>] [--window-ms 1000]
+ *          [--mode summary|downsample] [--reduce last|mean|min|max]
+ *          [--upstream-partition stack.aggregated] [--upstream-domain <id>]
+ *          [--poll-us 10000] [--metrics-port <port>] [--qos-profile <name>]
+ *
+ ***/
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include "ccpp_dds_dcps.h"
+#include "ccpp_EnvironmentalData.h"
+#include "example_main.h"
+#include "CheckStatus.h"
+#include "CommandLine.h"
+#include "DDSTransport.h"
+#include "Metrics.h"
+#include "SensorSchema.h"
+#include "SensorAggregator.h"
+#include "SummaryWriter.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void stopRunning(int signum)
+{
+  running = 0;
+}
+
+static int64_t currentTime()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * One reduced topic: its input reader, its reduction and its upstream
+ * writer, a summary writer or a transport writer.
+ **/
+struct AggregatedTopic
+{
+    std::string name;
+    std::unique_ptr<DDSTransportReader> reader;
+    SensorAggregator aggregator;
+    std::unique_ptr<SummaryWriter> summary;
+    std::unique_ptr<DDSTransportWriter> writer;
+    Counter *samples_in;
+    Counter *samples_out;
+
+    AggregatedTopic(const std::string &name, int64_t windowMs) : name(name), aggregator(windowMs) {}
+};
+
+/**
+ * Republishes the --reduce value of every closed window as a reading.
+ **/
+static void downsample(AggregatedTopic &topic, const std::vector<SensorWindow> &windows,
+  AggregateReduce reduce)
+{
+  TransportSample sample;
+  for (size_t i = 0; i < windows.size(); i++)
+  {
+    const SensorWindow &window = windows[i];
+    transportCopy(sample.id, topic.aggregator.id(window.sensor).c_str());
+    transportCopy(sample.type, topic.aggregator.type(window.sensor).c_str());
+    sample.value = window.value(reduce);
+    sample.timestamp = window.last;
+    topic.writer->write(sample);
+  }
+}
+
+int OSPL_MAIN (int argc, char *argv[])
+{
+  std::vector<std::string> names;
+  std::string allTopics = sensorKindTopics();
+  std::stringstream list(getOption(argc, argv, "--topics", allTopics.c_str()));
+  std::string name;
+  while (std::getline(list, name, ','))
+  {
+    if (!name.empty())
+    {
+      names.push_back(name);
+    }
+  }
+
+  const char *mode = getOption(argc, argv, "--mode", "summary");
+  bool summary = strcmp(mode, "summary") == 0;
+  if (!summary && strcmp(mode, "downsample") != 0)
+  {
+    cerr << "Error in --mode: expected summary or downsample, got " << mode << endl;
+    exit(1);
+  }
+  AggregateReduce reduce;
+  if (!SensorAggregator::parseReduce(getOption(argc, argv, "--reduce", "last"), reduce))
+  {
+    cerr << "Error in --reduce: expected last, mean, min or max" << endl;
+    exit(1);
+  }
+  long windowMs = getIntOption(argc, argv, "--window-ms", 1000);
+  long period = getIntOption(argc, argv, "--poll-us", 10000);
+  std::string upstreamPartition = getOption(argc, argv, "--upstream-partition", "stack.aggregated");
+  long upstreamDomain = getIntOption(argc, argv, "--upstream-domain", -1);
+
+  DDS::DomainParticipantFactory_var factory = DDS::DomainParticipantFactory::get_instance();
+  checkHandle(factory, "get_instance() failed");
+  DDS::DomainParticipant_var participant = factory->create_participant(DDS::DOMAIN_ID_DEFAULT,
+    PARTICIPANT_QOS_DEFAULT, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(participant, "create_participant() failed");
+
+  /* Upstream is either another domain or another partition of this one. */
+  DDS::DomainParticipant_var upstream = DDS::DomainParticipant::_duplicate(participant.in());
+  if (upstreamDomain >= 0)
+  {
+    upstream = factory->create_participant((DDS::DomainId_t)upstreamDomain, PARTICIPANT_QOS_DEFAULT, NULL,
+      DDS::STATUS_MASK_NONE);
+    checkHandle(upstream, "create_participant() upstream failed");
+  }
+
+  MetricsExporter metricsExporter(metrics());
+  {
+    DDSTransport transport(participant, argc, argv);
+    std::unique_ptr<DDSTransport> upstreamTransport;
+    DDSTransport *output = &transport;
+    if (upstreamDomain >= 0)
+    {
+      upstreamTransport.reset(new DDSTransport(upstream, argc, argv));
+      output = upstreamTransport.get();
+    }
+    std::vector<std::string> upstreamPartitions(1, upstreamPartition);
+    output->setWriterPartitions(upstreamPartitions);
+
+    QosCatalogue qos;
+    std::vector<std::unique_ptr<AggregatedTopic> > topics;
+    for (size_t i = 0; i < names.size(); i++)
+    {
+      AggregatedTopic *topic = new AggregatedTopic(names[i], windowMs);
+      topics.push_back(std::unique_ptr<AggregatedTopic>(topic));
+      topic->reader.reset(transport.createReader(names[i].c_str()));
+      if (summary)
+      {
+        topic->summary.reset(new SummaryWriter(upstream, qos.provider(argc, argv, "summary"), names[i].c_str(),
+          upstreamPartitions));
+      }
+      else
+      {
+        topic->writer.reset(output->createWriter(names[i].c_str()));
+      }
+      topic->samples_in = &metrics().counter("stack_aggregator_samples_in_total",
+        "Readings taken from the edge nodes.", metricsLabel("topic", names[i].c_str()));
+      topic->samples_out = &metrics().counter("stack_aggregator_samples_out_total",
+        "Reduced samples published upstream.", metricsLabel("topic", names[i].c_str()));
+    }
+
+    metricsExporter.start(getIntOption(argc, argv, "--metrics-port", 0));
+    Gauge &sensors = metrics().gauge("stack_aggregator_sensors", "Sensors seen by the aggregator.");
+
+    signal(SIGINT, stopRunning);
+    signal(SIGTERM, stopRunning);
+    cout << "=== [Aggregator] Reducing " << names.size() << " topics over " << windowMs << " ms into "
+         << (upstreamDomain >= 0 ? "domain " + std::to_string(upstreamDomain) + " " : std::string())
+         << "partition " << upstreamPartition << " (" << mode << ")" << endl;
+
+    std::vector<TransportSample> samples;
+    std::vector<SensorWindow> windows;
+    while (running)
+    {
+      size_t total = 0;
+      for (size_t i = 0; i < topics.size(); i++)
+      {
+        AggregatedTopic &topic = *topics[i];
+        int64_t now = currentTime();
+        topic.reader->take(samples);
+        /* Close the window before adding, so samples taken after its end
+         * go to the next one. */
+        if (topic.aggregator.due(now))
+        {
+          int64_t windowEnd = topic.aggregator.windowEnd();
+          topic.aggregator.flush(now, windows);
+          if (summary)
+          {
+            topic.summary->write(topic.aggregator, windows, windowEnd);
+          }
+          else
+          {
+            downsample(topic, windows, reduce);
+          }
+          topic.samples_out->add(windows.size());
+        }
+        topic.aggregator.add(samples.data(), samples.size(), now);
+        topic.samples_in->add(samples.size());
+        total += topic.aggregator.size();
+      }
+      sensors.set((double)total);
+      std::this_thread::sleep_for(std::chrono::microseconds(period));
+    }
+
+    metricsExporter.stop();
+    topics.clear();
+  }
+  if (upstreamDomain >= 0)
+  {
+    checkStatus(factory->delete_participant(upstream), "delete_participant() upstream failed");
+  }
+  checkStatus(factory->delete_participant(participant), "delete_participant() failed");
+  return 0;
+}
@@ -0,0 +1,303 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    AnomalyDetector.cpp
+ * FUNCTION:        Online anomaly detection over sensor readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the anomaly detector.
+ *
+ ***/
+
+#include <math.h>
+#include "AnomalyDetector.h"
+#include "Checkpoint.h"
+#include "MemoryUsage.h"
+
+AnomalyConfig::AnomalyConfig()
+  : alpha(0.05f), z_limit(4.0f), noise_floor(0.05f), rate_limit(0.0f),
+    stuck_samples(600), warmup(20)
+{
+}
+
+/**
+ * Updates the gathered state of one round. Every element belongs to a
+ * different sensor, so the iterations are independent. Selections are
+ * written as masks and products so the loop stays free of branches.
+ **/
+static void updateState(size_t n, const AnomalyConfig &config,
+  const float *__restrict value, const float *__restrict elapsed, const float *__restrict last,
+  float *__restrict mean, float *__restrict variance, uint32_t *__restrict seen,
+  uint32_t *__restrict run, float *__restrict z2, float *__restrict rate,
+  uint32_t *__restrict flags)
+{
+  /* Disabled rules get limits that are never exceeded. */
+  const float alpha = config.alpha;
+  const float zLimit2 = config.z_limit > 0 ? config.z_limit * config.z_limit : HUGE_VALF;
+  const float floor2 = config.noise_floor * config.noise_floor;
+  const float rateLimit = config.rate_limit > 0 ? config.rate_limit : HUGE_VALF;
+  const uint32_t stuckSamples = config.stuck_samples > 0 ? config.stuck_samples : UINT32_MAX;
+  const uint32_t warmup = config.warmup;
+
+  for (size_t i = 0; i < n; i++)
+  {
+    float x = value[i];
+    float delta = x - mean[i];
+    uint32_t known = seen[i] != 0;
+    float z = delta * delta / (variance[i] + floor2);
+    float change = fabsf(x - last[i]) * 1000.0f / elapsed[i];
+    uint32_t same = known & (uint32_t)(x == last[i]);
+    uint32_t length = (run[i] & (0u - same)) + 1;
+
+    uint32_t f = (ANOMALY_ZSCORE & (0u - ((uint32_t)(seen[i] >= warmup) & (uint32_t)(z > zLimit2))))
+               | (ANOMALY_RATE & (0u - (known & (uint32_t)(change > rateLimit))))
+               | (ANOMALY_STUCK & (0u - (uint32_t)(length >= stuckSamples)));
+
+    /* The first reading of a sensor sets the mean and a zero variance. */
+    float first = (float)(int32_t)(1 - known);
+    float weight = alpha + first * (1.0f - alpha);
+    float keep = (1.0f - first) * (1.0f - alpha);
+    mean[i] += weight * delta;
+    variance[i] = keep * (variance[i] + alpha * delta * delta);
+    seen[i] += (uint32_t)(seen[i] <= warmup);
+    run[i] = length;
+    z2[i] = z;
+    rate[i] = change;
+    flags[i] = f;
+  }
+}
+
+AnomalyDetector::AnomalyDetector()
+{
+}
+
+void AnomalyDetector::configure(const AnomalyConfig &detectorConfig)
+{
+  config = detectorConfig;
+}
+
+const char *AnomalyDetector::ruleName(uint32_t rule)
+{
+  switch (rule)
+  {
+    case ANOMALY_ZSCORE:
+      return "zscore";
+    case ANOMALY_RATE:
+      return "rate";
+    case ANOMALY_STUCK:
+      return "stuck";
+  }
+  return "unknown";
+}
+
+void AnomalyDetector::reserve(size_t sensors)
+{
+  if (mean.size() >= sensors)
+  {
+    return;
+  }
+  mean.resize(sensors, 0.0f);
+  variance.resize(sensors, 0.0f);
+  last_value.resize(sensors, 0.0f);
+  last_time.resize(sensors, 0);
+  seen.resize(sensors, 0);
+  run.resize(sensors, 0);
+  active.resize(sensors, 0);
+  round.resize(sensors, 0);
+}
+
+void AnomalyDetector::resizeBatch(size_t count)
+{
+  if (batch_value.size() >= count)
+  {
+    return;
+  }
+  order.resize(count);
+  batch_sensor.resize(count);
+  batch_value.resize(count);
+  batch_time.resize(count);
+  batch_mean.resize(count);
+  batch_variance.resize(count);
+  batch_last.resize(count);
+  batch_elapsed.resize(count);
+  batch_seen.resize(count);
+  batch_run.resize(count);
+  batch_z2.resize(count);
+  batch_rate.resize(count);
+  batch_flags.resize(count);
+}
+
+void AnomalyDetector::processRound(const uint32_t *index, size_t count, const uint32_t *sensors,
+  const int64_t *timestamps, const float *values, std::vector<AnomalyAlert> &alerts)
+{
+  /* Gather. */
+  for (size_t k = 0; k < count; k++)
+  {
+    uint32_t i = index[k];
+    uint32_t s = sensors[i];
+    batch_sensor[k] = s;
+    batch_value[k] = values[i];
+    batch_time[k] = timestamps[i];
+    batch_mean[k] = mean[s];
+    batch_variance[k] = variance[s];
+    batch_last[k] = last_value[s];
+    int64_t elapsed = timestamps[i] - last_time[s];
+    batch_elapsed[k] = elapsed > 1 ? (float)elapsed : 1.0f;
+    batch_seen[k] = seen[s];
+    batch_run[k] = run[s];
+  }
+
+  updateState(count, config, &batch_value[0], &batch_elapsed[0], &batch_last[0],
+    &batch_mean[0], &batch_variance[0], &batch_seen[0], &batch_run[0],
+    &batch_z2[0], &batch_rate[0], &batch_flags[0]);
+
+  /* Scatter and report the rules that started to hold. */
+  for (size_t k = 0; k < count; k++)
+  {
+    uint32_t s = batch_sensor[k];
+    mean[s] = batch_mean[k];
+    variance[s] = batch_variance[k];
+    last_value[s] = batch_value[k];
+    last_time[s] = batch_time[k];
+    seen[s] = batch_seen[k];
+    run[s] = batch_run[k];
+
+    uint32_t rising = batch_flags[k] & ~active[s];
+    active[s] = batch_flags[k];
+    for (uint32_t rule = ANOMALY_ZSCORE; rising != 0; rule <<= 1)
+    {
+      if ((rising & rule) == 0)
+      {
+        continue;
+      }
+      rising &= ~rule;
+
+      AnomalyAlert alert;
+      alert.sensor = s;
+      alert.rule = rule;
+      alert.timestamp = batch_time[k];
+      alert.value = batch_value[k];
+      if (rule == ANOMALY_ZSCORE)
+      {
+        alert.score = sqrtf(batch_z2[k]);
+      }
+      else if (rule == ANOMALY_RATE)
+      {
+        alert.score = batch_rate[k];
+      }
+      else
+      {
+        alert.score = (float)batch_run[k];
+      }
+      alerts.push_back(alert);
+    }
+  }
+}
+
+/**
+ * Runs a batch of readings through the detector and appends the resulting
+ * alerts. sensors[] holds the numbers of the SensorRegistry.
+ **/
+void AnomalyDetector::process(const uint32_t *sensors, const int64_t *timestamps,
+  const float *values, size_t count, std::vector<AnomalyAlert> &alerts)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  resizeBatch(count);
+  uint32_t highest = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    highest = sensors[i] > highest ? sensors[i] : highest;
+  }
+  reserve((size_t)highest + 1);
+
+  /* Round of every reading: how many readings of the same sensor precede
+   * it in the batch. batch_flags holds the rounds until they are sorted. */
+  uint32_t rounds = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    uint32_t r = round[sensors[i]]++;
+    batch_flags[i] = r;
+    if (r + 1 > rounds)
+    {
+      rounds = r + 1;
+    }
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    round[sensors[i]] = 0;
+  }
+
+  /* Counting sort of the readings by round, keeping the batch order. */
+  round_start.assign(rounds + 1, 0);
+  for (size_t i = 0; i < count; i++)
+  {
+    round_start[batch_flags[i] + 1]++;
+  }
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    round_start[r + 1] += round_start[r];
+  }
+  std::vector<uint32_t> position(round_start.begin(), round_start.end() - 1);
+  for (size_t i = 0; i < count; i++)
+  {
+    order[position[batch_flags[i]]++] = (uint32_t)i;
+  }
+
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    processRound(&order[round_start[r]], round_start[r + 1] - round_start[r],
+      sensors, timestamps, values, alerts);
+  }
+}
+
+size_t AnomalyDetector::memoryUsage() const
+{
+  return memoryOf(mean) + memoryOf(variance) + memoryOf(last_value) + memoryOf(last_time) +
+    memoryOf(seen) + memoryOf(run) + memoryOf(active) + memoryOf(round) +
+    memoryOf(order) + memoryOf(round_start) + memoryOf(batch_sensor) + memoryOf(batch_value) +
+    memoryOf(batch_time) + memoryOf(batch_mean) + memoryOf(batch_variance) + memoryOf(batch_last) +
+    memoryOf(batch_elapsed) + memoryOf(batch_seen) + memoryOf(batch_run) + memoryOf(batch_z2) +
+    memoryOf(batch_rate) + memoryOf(batch_flags);
+}
+
+void AnomalyDetector::save(CheckpointWriter &out) const
+{
+  out.putVector(mean);
+  out.putVector(variance);
+  out.putVector(last_value);
+  out.putVector(last_time);
+  out.putVector(seen);
+  out.putVector(run);
+  out.putVector(active);
+}
+
+bool AnomalyDetector::restore(CheckpointReader &in, size_t sensors)
+{
+  std::vector<float> m, v, l;
+  std::vector<int64_t> t;
+  std::vector<uint32_t> s, r, a;
+  if (!in.getVector(m) || !in.getVector(v) || !in.getVector(l) || !in.getVector(t) ||
+      !in.getVector(s) || !in.getVector(r) || !in.getVector(a) || !in.done())
+  {
+    return false;
+  }
+  size_t n = m.size();
+  if (n > sensors || v.size() != n || l.size() != n || t.size() != n || s.size() != n || r.size() != n ||
+      a.size() != n)
+  {
+    return false;
+  }
+  mean.swap(m);
+  variance.swap(v);
+  last_value.swap(l);
+  last_time.swap(t);
+  seen.swap(s);
+  run.swap(r);
+  active.swap(a);
+  round.assign(n, 0);
+  return true;
+}
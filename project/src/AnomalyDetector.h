@@ -0,0 +1,129 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    AnomalyDetector.h
+ * FUNCTION:        Online anomaly detection over sensor readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the streaming anomaly detector used
+ * by the subscriber. Every sensor keeps an exponentially weighted mean and
+ * variance; a reading is reported when
+ *   - it is more than z_limit standard deviations from the mean,
+ *   - it changed faster than rate_limit units per second, or
+ *   - it is the stuck_samples-th identical value in a row.
+ * A rule reports once when it starts to hold and again only after it
+ * cleared.
+ *
+ * The state is kept as one array per field. process() takes a whole batch
+ * from the reader, gathers the state of the sensors in the batch into
+ * contiguous arrays, updates them in a branch free loop the compiler can
+ * vectorize and scatters the result back. A sensor appearing several times
+ * in a batch is handled in successive rounds so its samples stay in order.
+ *
+ * Sensors are the dense numbers of the SensorRegistry; the arrays grow to
+ * the highest number seen.
+ *
+ ***/
+
+#ifndef __ANOMALYDETECTOR_H__
+  #define __ANOMALYDETECTOR_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <vector>
+
+  class CheckpointWriter;
+  class CheckpointReader;
+
+  enum AnomalyRule
+  {
+      ANOMALY_ZSCORE = 1,
+      ANOMALY_RATE   = 2,
+      ANOMALY_STUCK  = 4
+  };
+
+  struct AnomalyConfig
+  {
+      float    alpha;           /* weight of a new reading in the EWMA */
+      float    z_limit;         /* standard deviations, 0 disables */
+      float    noise_floor;     /* smallest standard deviation assumed */
+      float    rate_limit;      /* change per second, 0 disables */
+      uint32_t stuck_samples;   /* identical readings in a row, 0 disables */
+      uint32_t warmup;          /* readings before the z-score rule applies */
+
+      AnomalyConfig();
+  };
+
+  struct AnomalyAlert
+  {
+      uint32_t sensor;
+      uint32_t rule;
+      int64_t  timestamp;
+      float    value;
+      float    score;           /* z-score, change per second or run length */
+  };
+
+  class AnomalyDetector
+  {
+      AnomalyConfig config;
+
+      /* Per sensor state. */
+      std::vector<float>    mean;
+      std::vector<float>    variance;
+      std::vector<float>    last_value;
+      std::vector<int64_t>  last_time;
+      std::vector<uint32_t> seen;
+      std::vector<uint32_t> run;
+      std::vector<uint32_t> active;
+      std::vector<uint32_t> round;
+
+      /* Batch working arrays, kept to avoid reallocating per batch. */
+      std::vector<uint32_t> order;
+      std::vector<uint32_t> round_start;
+      std::vector<uint32_t> batch_sensor;
+      std::vector<float>    batch_value;
+      std::vector<int64_t>  batch_time;
+      std::vector<float>    batch_mean;
+      std::vector<float>    batch_variance;
+      std::vector<float>    batch_last;
+      std::vector<float>    batch_elapsed;
+      std::vector<uint32_t> batch_seen;
+      std::vector<uint32_t> batch_run;
+      std::vector<float>    batch_z2;
+      std::vector<float>    batch_rate;
+      std::vector<uint32_t> batch_flags;
+
+      void resizeBatch(size_t count);
+      void processRound(const uint32_t *index, size_t count, const uint32_t *sensors,
+        const int64_t *timestamps, const float *values, std::vector<AnomalyAlert> &alerts);
+    public:
+      AnomalyDetector();
+      void configure(const AnomalyConfig &config);
+
+      /**
+       * Makes room for the sensors below sensors; process() calls it as
+       * needed.
+       **/
+      void reserve(size_t sensors);
+      size_t size() const { return mean.size(); }
+
+      /**
+       * Approximate bytes held (see MemoryUsage.h).
+       **/
+      size_t memoryUsage() const;
+
+      /**
+       * Saves the per sensor state, not the configuration (see
+       * Checkpoint.h). restore() replaces the state with a saved one of at
+       * most sensors sensors; it returns false, changing nothing, for a
+       * malformed or larger one.
+       **/
+      void save(CheckpointWriter &out) const;
+      bool restore(CheckpointReader &in, size_t sensors);
+      void process(const uint32_t *sensors, const int64_t *timestamps, const float *values,
+        size_t count, std::vector<AnomalyAlert> &alerts);
+      static const char *ruleName(uint32_t rule);
+  };
+
+#endif
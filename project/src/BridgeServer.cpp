@@ -0,0 +1,780 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BridgeServer.cpp
+ * FUNCTION:        Coalescing push server for the dashboard.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the dashboard bridge.
+ *
+ ***/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <utility>
+#include "BridgeServer.h"
+#include "Metrics.h"
+
+/* Bytes of a WebSocket handshake or of a client frame that are accepted. */
+#define BRIDGE_MAX_INPUT  16384
+
+static const char *WEBSOCKET_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+static int64_t currentTime()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void appendEscaped(std::string &out, const std::string &text)
+{
+  for (size_t i = 0; i < text.size(); i++)
+  {
+    if (text[i] == '"' || text[i] == '\\')
+    {
+      out += '\\';
+    }
+    out += text[i];
+  }
+}
+
+template <typename T> static void appendRaw(std::string &out, T value)
+{
+  out.append((const char *)&value, sizeof(value));
+}
+
+static void appendShort(std::string &out, const std::string &text)
+{
+  uint8_t length = (uint8_t)(text.size() < 255 ? text.size() : 255);
+  out += (char)length;
+  out.append(text, 0, length);
+}
+
+/**
+ * SHA-1 of data (RFC 3174), only used for the WebSocket handshake.
+ **/
+static void sha1(const std::string &data, unsigned char digest[20])
+{
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  std::string message = data;
+  uint64_t bits = (uint64_t)data.size() * 8;
+  message += (char)0x80;
+  while (message.size() % 64 != 56)
+  {
+    message += (char)0;
+  }
+  for (int i = 7; i >= 0; i--)
+  {
+    message += (char)(bits >> (i * 8));
+  }
+
+  for (size_t block = 0; block < message.size(); block += 64)
+  {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++)
+    {
+      const unsigned char *p = (const unsigned char *)message.data() + block + i * 4;
+      w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+    for (int i = 16; i < 80; i++)
+    {
+      uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+      w[i] = x << 1 | x >> 31;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++)
+    {
+      uint32_t f, k;
+      if (i < 20)
+      {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      }
+      else if (i < 40)
+      {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      }
+      else if (i < 60)
+      {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      }
+      else
+      {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = b << 30 | b >> 2;
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 20; i++)
+  {
+    digest[i] = (unsigned char)(h[i / 4] >> (24 - i % 4 * 8));
+  }
+}
+
+static std::string base64(const unsigned char *data, size_t size)
+{
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  for (size_t i = 0; i < size; i += 3)
+  {
+    uint32_t chunk = (uint32_t)data[i] << 16;
+    if (i + 1 < size)
+    {
+      chunk |= (uint32_t)data[i + 1] << 8;
+    }
+    if (i + 2 < size)
+    {
+      chunk |= data[i + 2];
+    }
+    out += alphabet[chunk >> 18 & 63];
+    out += alphabet[chunk >> 12 & 63];
+    out += i + 1 < size ? alphabet[chunk >> 6 & 63] : '=';
+    out += i + 2 < size ? alphabet[chunk & 63] : '=';
+  }
+  return out;
+}
+
+/**
+ * Value of an HTTP header, matched without regard to case.
+ **/
+static std::string header(const std::string &request, const char *name)
+{
+  size_t length = strlen(name);
+  size_t line = request.find("\r\n");
+  while (line != std::string::npos && line + 2 < request.size())
+  {
+    size_t start = line + 2;
+    size_t end = request.find("\r\n", start);
+    if (end == std::string::npos)
+    {
+      break;
+    }
+    if (end - start > length && request[start + length] == ':' &&
+        strncasecmp(request.c_str() + start, name, length) == 0)
+    {
+      size_t value = request.find_first_not_of(" \t", start + length + 1);
+      size_t last = request.find_last_not_of(" \t", end - 1);
+      return value <= last ? request.substr(value, last - value + 1) : std::string();
+    }
+    line = end;
+  }
+  return std::string();
+}
+
+/**
+ * Appends the header of an unmasked, final WebSocket frame.
+ **/
+static void websocketHeader(std::string &out, int opcode, size_t length)
+{
+  out += (char)(0x80 | opcode);
+  if (length < 126)
+  {
+    out += (char)length;
+  }
+  else if (length < 65536)
+  {
+    out += (char)126;
+    out += (char)(length >> 8);
+    out += (char)length;
+  }
+  else
+  {
+    out += (char)127;
+    for (int i = 7; i >= 0; i--)
+    {
+      out += (char)((uint64_t)length >> (i * 8));
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+LatestValues::LatestValues()
+  : clock(0)
+{
+}
+
+void LatestValues::update(const char *topic, const TransportSample *samples, size_t count)
+{
+  std::string key(topic);
+  key += '\0';
+  size_t prefix = key.size();
+
+  std::lock_guard<std::mutex> guard(lock);
+  for (size_t i = 0; i < count; i++)
+  {
+    key.resize(prefix);
+    key += samples[i].id;
+    std::unordered_map<std::string, uint32_t>::iterator it = slots.find(key);
+    uint32_t slot;
+    if (it == slots.end())
+    {
+      slot = (uint32_t)ids.size();
+      slots[key] = slot;
+      topics.push_back(topic);
+      ids.push_back(samples[i].id);
+      values.push_back(0.0f);
+      timestamps.push_back(0);
+      versions.push_back(0);
+    }
+    else
+    {
+      slot = it->second;
+    }
+    values[slot] = samples[i].value;
+    timestamps[slot] = samples[i].timestamp;
+    versions[slot] = ++clock;
+  }
+}
+
+uint64_t LatestValues::version()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return clock;
+}
+
+size_t LatestValues::size()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  return ids.size();
+}
+
+size_t LatestValues::encode(uint64_t since, BridgeFormat format, uint64_t sequence, int64_t time,
+  std::string &out)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  size_t count = 0;
+  char text[128];
+  if (format == BRIDGE_JSON)
+  {
+    snprintf(text, sizeof(text), "{\"seq\":%llu,\"time\":%lld,\"full\":%s,\"values\":[",
+      (unsigned long long)sequence, (long long)time, since == 0 ? "true" : "false");
+    out += text;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      if (versions[i] <= since)
+      {
+        continue;
+      }
+      out += count == 0 ? "[\"" : ",[\"";
+      appendEscaped(out, topics[i]);
+      out += "\",\"";
+      appendEscaped(out, ids[i]);
+      if (isfinite(values[i]))
+      {
+        snprintf(text, sizeof(text), "\",%.7g,%lld]", values[i], (long long)timestamps[i]);
+      }
+      else
+      {
+        snprintf(text, sizeof(text), "\",null,%lld]", (long long)timestamps[i]);
+      }
+      out += text;
+      count++;
+    }
+    out += "]}";
+  }
+  else
+  {
+    size_t start = out.size();
+    out += "SB";
+    out += (char)1;
+    out += (char)(since == 0 ? 1 : 0);
+    appendRaw(out, sequence);
+    appendRaw(out, time);
+    appendRaw(out, (uint32_t)0);
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+      if (versions[i] <= since)
+      {
+        continue;
+      }
+      appendShort(out, topics[i]);
+      appendShort(out, ids[i]);
+      appendRaw(out, values[i]);
+      appendRaw(out, timestamps[i]);
+      count++;
+    }
+    uint32_t total = (uint32_t)count;
+    memcpy(&out[start + 20], &total, sizeof(total));
+  }
+  return count;
+}
+
+/* ---------------------------------------------------------------------- */
+
+BridgeServer::BridgeServer(LatestValues &latest)
+  : latest(latest), format(BRIDGE_JSON), frame_ms(100), buffer_limit(256 * 1024), client_timeout(10000),
+    ws_fd(-1), tcp_fd(-1), sequence(0), running(false)
+{
+}
+
+BridgeServer::~BridgeServer()
+{
+  stop();
+}
+
+bool BridgeServer::parseFormat(const char *name, BridgeFormat &format)
+{
+  if (strcmp(name, "json") == 0)
+  {
+    format = BRIDGE_JSON;
+  }
+  else if (strcmp(name, "binary") == 0)
+  {
+    format = BRIDGE_BINARY;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+int BridgeServer::listenOn(int port)
+{
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+  {
+    std::cerr << "Error in BridgeServer::start: socket: " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons((uint16_t)port);
+  if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(fd, 16) != 0)
+  {
+    std::cerr << "Error in BridgeServer::start: cannot listen on port " << port
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  return fd;
+}
+
+void BridgeServer::start(int wsPort, int tcpPort, BridgeFormat frameFormat, int framesPerSecond,
+  size_t bufferLimit, int64_t clientTimeoutMs)
+{
+  format = frameFormat;
+  frame_ms = framesPerSecond > 0 ? 1000 / framesPerSecond : 100;
+  if (frame_ms <= 0)
+  {
+    frame_ms = 1;
+  }
+  buffer_limit = bufferLimit;
+  client_timeout = clientTimeoutMs;
+  if (wsPort > 0)
+  {
+    ws_fd = listenOn(wsPort);
+    std::cout << "=== [Bridge] WebSocket on ws://127.0.0.1:" << wsPort << "/" << std::endl;
+  }
+  if (tcpPort > 0)
+  {
+    tcp_fd = listenOn(tcpPort);
+    std::cout << "=== [Bridge] TCP on 127.0.0.1:" << tcpPort << std::endl;
+  }
+  if (ws_fd < 0 && tcp_fd < 0)
+  {
+    return;
+  }
+  running = true;
+  worker = std::thread(&BridgeServer::run, this);
+}
+
+void BridgeServer::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+  running = false;
+  worker.join();
+  for (size_t i = 0; i < clients.size(); i++)
+  {
+    close(clients[i].fd);
+  }
+  clients.clear();
+  if (ws_fd >= 0)
+  {
+    close(ws_fd);
+    ws_fd = -1;
+  }
+  if (tcp_fd >= 0)
+  {
+    close(tcp_fd);
+    tcp_fd = -1;
+  }
+}
+
+void BridgeServer::accept(int listenFd, bool websocket)
+{
+  int fd = ::accept(listenFd, NULL, NULL);
+  if (fd < 0)
+  {
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  int noDelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+  Client client;
+  client.fd = fd;
+  client.websocket = websocket;
+  client.open = !websocket;
+  client.sent = 0;
+  client.version = 0;
+  client.progress = currentTime();
+  clients.push_back(client);
+}
+
+/**
+ * Reads what the client sent. Returns false when it is to be dropped.
+ **/
+bool BridgeServer::receive(Client &client)
+{
+  char buffer[4096];
+  for (;;)
+  {
+    ssize_t got = recv(client.fd, buffer, sizeof(buffer), 0);
+    if (got > 0)
+    {
+      if (client.websocket)
+      {
+        client.input.append(buffer, (size_t)got);
+      }
+      if (client.input.size() > BRIDGE_MAX_INPUT)
+      {
+        return false;
+      }
+      continue;
+    }
+    if (got < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      break;
+    }
+    return false;
+  }
+  if (!client.websocket)
+  {
+    return true;
+  }
+  return client.open ? readFrames(client) : handshake(client);
+}
+
+bool BridgeServer::handshake(Client &client)
+{
+  size_t end = client.input.find("\r\n\r\n");
+  if (end == std::string::npos)
+  {
+    return true;
+  }
+  std::string request = client.input.substr(0, end + 2);
+  client.input.erase(0, end + 4);
+
+  std::string key = header(request, "Sec-WebSocket-Key");
+  if (request.compare(0, 4, "GET ") != 0 || key.empty())
+  {
+    const char *refused = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    send(client.fd, refused, strlen(refused), MSG_NOSIGNAL);
+    return false;
+  }
+  unsigned char digest[20];
+  sha1(key + WEBSOCKET_GUID, digest);
+  client.output += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+    "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+  client.open = true;
+  return readFrames(client);
+}
+
+/**
+ * Handles the frames a WebSocket client sent: ping is answered, close
+ * ends the connection and everything else is ignored.
+ **/
+bool BridgeServer::readFrames(Client &client)
+{
+  for (;;)
+  {
+    const unsigned char *in = (const unsigned char *)client.input.data();
+    size_t size = client.input.size();
+    if (size < 2)
+    {
+      return true;
+    }
+    int opcode = in[0] & 0x0f;
+    bool masked = (in[1] & 0x80) != 0;
+    uint64_t length = in[1] & 0x7f;
+    size_t position = 2;
+    if (length == 126)
+    {
+      if (size < 4)
+      {
+        return true;
+      }
+      length = (uint64_t)in[2] << 8 | in[3];
+      position = 4;
+    }
+    else if (length == 127)
+    {
+      if (size < 10)
+      {
+        return true;
+      }
+      length = 0;
+      for (int i = 0; i < 8; i++)
+      {
+        length = length << 8 | in[2 + i];
+      }
+      position = 10;
+    }
+    if (length > BRIDGE_MAX_INPUT)
+    {
+      return false;
+    }
+    size_t maskAt = position;
+    if (masked)
+    {
+      position += 4;
+    }
+    if (size < position + length)
+    {
+      return true;
+    }
+
+    std::string payload(client.input, position, (size_t)length);
+    if (masked)
+    {
+      for (size_t i = 0; i < payload.size(); i++)
+      {
+        payload[i] ^= client.input[maskAt + i % 4];
+      }
+    }
+    client.input.erase(0, position + (size_t)length);
+
+    if (opcode == 0x8)
+    {
+      websocketHeader(client.output, 0x8, 0);
+      flush(client, currentTime());
+      return false;
+    }
+    if (opcode == 0x9)
+    {
+      websocketHeader(client.output, 0xA, payload.size());
+      client.output += payload;
+    }
+  }
+}
+
+/**
+ * Sends as much output as the socket takes. Returns false when the
+ * client is to be dropped.
+ **/
+bool BridgeServer::flush(Client &client, int64_t now)
+{
+  while (client.sent < client.output.size())
+  {
+    ssize_t done = send(client.fd, client.output.data() + client.sent, client.output.size() - client.sent,
+      MSG_NOSIGNAL);
+    if (done > 0)
+    {
+      client.sent += (size_t)done;
+      client.progress = now;
+      continue;
+    }
+    if (done < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (done < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      break;
+    }
+    return false;
+  }
+  if (client.sent == client.output.size())
+  {
+    client.output.clear();
+    client.sent = 0;
+    client.progress = now;
+  }
+  else if (client.sent > client.output.size() / 2)
+  {
+    client.output.erase(0, client.sent);
+    client.sent = 0;
+  }
+  return now - client.progress < client_timeout;
+}
+
+/**
+ * Queues one frame for every client that is not behind. Clients at the
+ * same version share the encoded frame.
+ **/
+void BridgeServer::frame(int64_t now)
+{
+  static Counter &frames = metrics().counter("stack_bridge_frames_total",
+    "Frames queued to dashboard clients.");
+  static Counter &skipped = metrics().counter("stack_bridge_frames_skipped_total",
+    "Frames not queued because the client was behind.");
+  static Counter &valuesSent = metrics().counter("stack_bridge_values_total",
+    "Sensor values queued to dashboard clients.");
+  static Counter &bytes = metrics().counter("stack_bridge_bytes_total",
+    "Bytes queued to dashboard clients.");
+
+  uint64_t version = latest.version();
+  sequence++;
+  std::map<uint64_t, std::string> encoded;
+  std::map<uint64_t, size_t> counts;
+  for (size_t i = 0; i < clients.size(); i++)
+  {
+    Client &client = clients[i];
+    if (!client.open || client.version == version)
+    {
+      continue;
+    }
+    if (client.output.size() - client.sent > buffer_limit)
+    {
+      skipped.add();
+      continue;
+    }
+
+    std::map<uint64_t, std::string>::iterator it = encoded.find(client.version);
+    if (it == encoded.end())
+    {
+      it = encoded.insert(std::make_pair(client.version, std::string())).first;
+      counts[client.version] = latest.encode(client.version, format, sequence, now, it->second);
+    }
+    const std::string &payload = it->second;
+    if (client.websocket)
+    {
+      websocketHeader(client.output, format == BRIDGE_JSON ? 0x1 : 0x2, payload.size());
+    }
+    else
+    {
+      uint32_t length = (uint32_t)payload.size();
+      client.output.append((const char *)&length, sizeof(length));
+    }
+    client.output += payload;
+    client.version = version;
+    frames.add();
+    valuesSent.add(counts[it->first]);
+    bytes.add(payload.size());
+  }
+}
+
+void BridgeServer::run()
+{
+  Gauge &connected = metrics().gauge("stack_bridge_clients", "Dashboard clients connected.");
+  int64_t next = currentTime();
+  std::vector<struct pollfd> ready;
+  while (running)
+  {
+    ready.clear();
+    struct pollfd entry;
+    entry.events = POLLIN;
+    entry.revents = 0;
+    entry.fd = ws_fd;
+    ready.push_back(entry);
+    entry.fd = tcp_fd;
+    ready.push_back(entry);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+      entry.fd = clients[i].fd;
+      entry.events = POLLIN | (clients[i].sent < clients[i].output.size() ? POLLOUT : 0);
+      ready.push_back(entry);
+    }
+
+    int64_t now = currentTime();
+    int timeout = next > now ? (int)(next - now) : 0;
+    if (poll(&ready[0], ready.size(), timeout < 200 ? timeout : 200) < 0 && errno != EINTR)
+    {
+      std::cerr << "Error in BridgeServer::run: poll: " << strerror(errno) << std::endl;
+      return;
+    }
+
+    /* Clients first: the indexes in ready are those of before accept. */
+    now = currentTime();
+    size_t kept = 0;
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+      short events = ready[i + 2].revents;
+      bool alive = (events & (POLLERR | POLLNVAL)) == 0;
+      if (alive && (events & (POLLIN | POLLHUP)) != 0)
+      {
+        alive = receive(clients[i]);
+      }
+      if (alive)
+      {
+        alive = flush(clients[i], now);
+      }
+      if (alive)
+      {
+        if (kept != i)
+        {
+          clients[kept] = std::move(clients[i]);
+        }
+        kept++;
+      }
+      else
+      {
+        close(clients[i].fd);
+      }
+    }
+    clients.resize(kept);
+    if (ready[0].revents & POLLIN)
+    {
+      accept(ws_fd, true);
+    }
+    if (ready[1].revents & POLLIN)
+    {
+      accept(tcp_fd, false);
+    }
+
+    if (now >= next)
+    {
+      frame(now);
+      for (size_t i = 0; i < clients.size(); i++)
+      {
+        flush(clients[i], now);
+      }
+      next += frame_ms;
+      if (next <= now)
+      {
+        next = now + frame_ms;
+      }
+    }
+    connected.set(clients.size());
+  }
+}
@@ -0,0 +1,137 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BridgeServer.h
+ * FUNCTION:        Coalescing push server for the dashboard.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the dashboard bridge. LatestValues
+ * keeps the last reading of every (topic, sensor id); BridgeServer
+ * pushes what changed in it to its clients at a fixed frame rate, so a
+ * client gets at most one value per sensor per frame however fast the
+ * sensors publish.
+ *
+ * Clients connect on 127.0.0.1 as WebSocket (--ws-port) or plain TCP
+ * (--tcp-port). A new client first gets every value, then the values
+ * changed since the last frame it was sent. A client whose unsent output
+ * is above the buffer limit is skipped for that frame; its next frame
+ * covers everything it missed, so a slow client gets fewer, larger
+ * frames instead of a growing queue. A client that takes nothing for
+ * the client timeout is dropped.
+ *
+ * Frames, in the format chosen with --format:
+ *   json    {"seq":12,"time":1760000000000,"full":false,
+ *            "values":[["humidity","node1-h",55.2,1760000000000],...]}
+ *           sent as WebSocket text frames
+ *   binary  little endian, sent as WebSocket binary frames
+ *             char[2] "SB", uint8 version (1), uint8 flags (1: full)
+ *             uint64 seq, int64 time (ms), uint32 count, then per value
+ *             uint8 topic length, topic, uint8 id length, id,
+ *             float value, int64 timestamp (ms)
+ * On plain TCP every frame is preceded by its uint32 length.
+ *
+ ***/
+
+#ifndef __BRIDGESERVER_H__
+  #define __BRIDGESERVER_H__
+
+  #include <stdint.h>
+  #include <atomic>
+  #include <mutex>
+  #include <string>
+  #include <thread>
+  #include <unordered_map>
+  #include <vector>
+  #include "Transport.h"
+
+  enum BridgeFormat
+  {
+      BRIDGE_JSON,
+      BRIDGE_BINARY
+  };
+
+  class LatestValues
+  {
+      std::mutex lock;
+      std::unordered_map<std::string, uint32_t> slots;   /* topic '\0' id */
+
+      /* Per value state. */
+      std::vector<std::string> topics;
+      std::vector<std::string> ids;
+      std::vector<float>       values;
+      std::vector<int64_t>     timestamps;
+      std::vector<uint64_t>    versions;
+      uint64_t clock;
+    public:
+      LatestValues();
+
+      /**
+       * Keeps the last of count samples of topic per sensor.
+       **/
+      void update(const char *topic, const TransportSample *samples, size_t count);
+
+      /**
+       * Version of the last update.
+       **/
+      uint64_t version();
+
+      /**
+       * Appends the values updated after since to out in format, as one
+       * frame; since 0 gives every value. Returns the number of values.
+       **/
+      size_t encode(uint64_t since, BridgeFormat format, uint64_t sequence, int64_t time,
+        std::string &out);
+
+      size_t size();
+  };
+
+  class BridgeServer
+  {
+      struct Client
+      {
+          int fd;
+          bool websocket;
+          bool open;                /* handshake done */
+          std::string input;
+          std::string output;
+          size_t sent;              /* bytes of output already sent */
+          uint64_t version;         /* LatestValues version of the last frame */
+          int64_t progress;         /* last time output was taken (ms) */
+      };
+
+      LatestValues &latest;
+      BridgeFormat format;
+      int64_t frame_ms;
+      size_t buffer_limit;
+      int64_t client_timeout;
+      int ws_fd;
+      int tcp_fd;
+      std::vector<Client> clients;
+      uint64_t sequence;
+      std::atomic<bool> running;
+      std::thread worker;
+
+      int listenOn(int port);
+      void accept(int listenFd, bool websocket);
+      bool receive(Client &client);
+      bool handshake(Client &client);
+      bool readFrames(Client &client);
+      bool flush(Client &client, int64_t now);
+      void frame(int64_t now);
+      void run();
+    public:
+      BridgeServer(LatestValues &latest);
+      ~BridgeServer();
+
+      /**
+       * Serves WebSocket clients on 127.0.0.1:wsPort and plain TCP
+       * clients on 127.0.0.1:tcpPort (0 disables) at framesPerSecond.
+       **/
+      void start(int wsPort, int tcpPort, BridgeFormat format, int framesPerSecond,
+        size_t bufferLimit = 256 * 1024, int64_t clientTimeoutMs = 10000);
+      void stop();
+      static bool parseFormat(const char *name, BridgeFormat &format);
+  };
+
+#endif
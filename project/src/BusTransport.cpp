@@ -0,0 +1,216 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BusTransport.cpp
+ * FUNCTION:        In-process lock-free transport.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the in-process bus.
+ *
+ ***/
+
+#include <chrono>
+#include "BusTransport.h"
+
+static int64_t currentTime()
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+BusTopic::BusTopic(size_t depth)
+  : head(0), waiters(0)
+{
+  size_t size = 1;
+  while (size < depth)
+  {
+    size <<= 1;
+  }
+  slots.reset(new Slot[size]);
+  for (size_t i = 0; i < size; i++)
+  {
+    slots[i].sequence.store(0, std::memory_order_relaxed);
+  }
+  mask = size - 1;
+}
+
+void BusTopic::write(const TransportSample &sample)
+{
+  uint64_t n = head.fetch_add(1, std::memory_order_relaxed);
+  Slot &slot = slots[n & mask];
+  slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.sample = sample;
+  slot.sequence.store(2 * n + 2, std::memory_order_release);
+
+  /* Pairs with the fence in wait(): either the reader sees the sample or
+   * this sees the reader waiting. */
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_relaxed) > 0)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    ready.notify_all();
+  }
+}
+
+uint64_t BusTopic::copy(uint64_t cursor, std::vector<TransportSample> &samples, size_t maxSamples,
+  uint64_t &lost, uint64_t *first)
+{
+  uint64_t last = head.load(std::memory_order_acquire);
+  if (last - cursor > capacity())
+  {
+    lost += last - capacity() - cursor;
+    cursor = last - capacity();
+  }
+
+  TransportSample sample;
+  while (cursor < last && samples.size() < maxSamples)
+  {
+    const Slot &slot = slots[cursor & mask];
+    uint64_t expected = 2 * cursor + 2;
+    uint64_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before < expected)
+    {
+      /* Claimed but not written yet. */
+      break;
+    }
+    if (before == expected)
+    {
+      sample = slot.sample;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == expected)
+      {
+        if (first != NULL && samples.empty())
+        {
+          *first = cursor;
+        }
+        samples.push_back(sample);
+        cursor++;
+        continue;
+      }
+    }
+    /* Overwritten by a writer that went round the ring. */
+    lost++;
+    cursor++;
+  }
+  return cursor;
+}
+
+bool BusTopic::available(uint64_t cursor)
+{
+  return slots[cursor & mask].sequence.load(std::memory_order_acquire) >= 2 * cursor + 2 ||
+    head.load(std::memory_order_acquire) - cursor > capacity();
+}
+
+bool BusTopic::wait(uint64_t cursor, int64_t timeoutMs)
+{
+  if (available(cursor))
+  {
+    return true;
+  }
+  waiters.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool result;
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    result = ready.wait_for(guard, std::chrono::milliseconds(timeoutMs),
+      [this, cursor]() { return available(cursor); });
+  }
+  waiters.fetch_sub(1, std::memory_order_relaxed);
+  return result;
+}
+
+class BusWriter : public TransportWriter
+{
+    BusTopic &topic;
+  public:
+    BusWriter(BusTopic &topic) : topic(topic) {}
+
+    bool write(const TransportSample &sample)
+    {
+      if (sample.timestamp != 0)
+      {
+        topic.write(sample);
+        return true;
+      }
+      TransportSample stamped = sample;
+      stamped.timestamp = currentTime();
+      topic.write(stamped);
+      return true;
+    }
+};
+
+class BusReader : public TransportReader
+{
+    BusTopic &topic;
+    uint64_t cursor;
+    uint64_t lost_count;
+  public:
+    BusReader(BusTopic &topic) : topic(topic), cursor(topic.end()), lost_count(0) {}
+
+    size_t read(std::vector<TransportSample> &samples, size_t maxSamples)
+    {
+      samples.clear();
+      uint64_t skipped = 0;
+      uint64_t first = 0;
+      uint64_t next = topic.copy(cursor, samples, maxSamples, skipped, &first);
+
+      /* The samples read stay in the reader; the ones lost before them
+       * are gone. Later gaps are counted when they are taken. */
+      if (samples.empty())
+      {
+        cursor = next;
+        lost_count += skipped;
+      }
+      else
+      {
+        lost_count += first - cursor;
+        cursor = first;
+      }
+      return samples.size();
+    }
+
+    size_t take(std::vector<TransportSample> &samples, size_t maxSamples)
+    {
+      samples.clear();
+      cursor = topic.copy(cursor, samples, maxSamples, lost_count);
+      return samples.size();
+    }
+
+    bool wait(int64_t timeoutMs)
+    {
+      return topic.wait(cursor, timeoutMs);
+    }
+
+    uint64_t lost()
+    {
+      return lost_count;
+    }
+};
+
+BusTransport::BusTransport(size_t depth)
+  : depth(depth)
+{
+}
+
+BusTopic &BusTransport::topic(const char *name)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  std::unique_ptr<BusTopic> &slot = topics[name];
+  if (!slot)
+  {
+    slot.reset(new BusTopic(depth));
+  }
+  return *slot;
+}
+
+TransportWriter *BusTransport::createWriter(const char *name)
+{
+  return new BusWriter(topic(name));
+}
+
+TransportReader *BusTransport::createReader(const char *name)
+{
+  return new BusReader(topic(name));
+}
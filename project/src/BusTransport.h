@@ -0,0 +1,79 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    BusTransport.h
+ * FUNCTION:        In-process lock-free transport.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the in-process bus backend of the
+ * transport interface.
+ *
+ * Every topic is one broadcast ring of depth slots (rounded up to a power
+ * of two). A writer claims the next sequence number with one atomic add
+ * and fills its slot under a per slot sequence lock; readers never block
+ * writers. Each reader keeps its own cursor into the ring, so it holds
+ * the last depth samples of the topic like a KEEP_LAST reader; samples
+ * that are overwritten before it takes them are counted as lost.
+ *
+ ***/
+
+#ifndef __BUSTRANSPORT_H__
+  #define __BUSTRANSPORT_H__
+
+  #include <atomic>
+  #include <condition_variable>
+  #include <map>
+  #include <memory>
+  #include <mutex>
+  #include <string>
+  #include "Transport.h"
+
+  class BusTopic
+  {
+      struct Slot
+      {
+          std::atomic<uint64_t> sequence;   /* 2n+1 while written, 2n+2 when sample n is complete */
+          TransportSample sample;
+      };
+
+      std::unique_ptr<Slot[]> slots;
+      uint64_t mask;
+      char pad0[64];
+      std::atomic<uint64_t> head;
+      char pad1[64];
+      std::atomic<int> waiters;
+      std::mutex lock;
+      std::condition_variable ready;
+    public:
+      BusTopic(size_t depth);
+      size_t capacity() const { return (size_t)mask + 1; }
+      void write(const TransportSample &sample);
+      uint64_t end() const { return head.load(std::memory_order_acquire); }
+
+      /**
+       * Copies the samples from cursor on into samples, at most
+       * maxSamples, counting those already overwritten in lost. Returns
+       * the cursor after the last sample copied and sets first to the
+       * cursor of the first one.
+       **/
+      uint64_t copy(uint64_t cursor, std::vector<TransportSample> &samples, size_t maxSamples,
+        uint64_t &lost, uint64_t *first = NULL);
+      bool available(uint64_t cursor);
+      bool wait(uint64_t cursor, int64_t timeoutMs);
+  };
+
+  class BusTransport : public Transport
+  {
+      size_t depth;
+      std::mutex lock;
+      std::map<std::string, std::unique_ptr<BusTopic> > topics;
+
+      BusTopic &topic(const char *name);
+    public:
+      BusTransport(size_t depth = 1024);
+      TransportWriter *createWriter(const char *topic);
+      TransportReader *createReader(const char *topic);
+  };
+
+#endif
@@ -0,0 +1,240 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Calibration.cpp
+ * FUNCTION:        Conversion of raw sensor counts to units.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the calibration.
+ *
+ ***/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "Calibration.h"
+
+/* Counts converted per pass, kept on the stack as floats. */
+#define CALIBRATION_CHUNK  256
+
+SensorCalibration::SensorCalibration()
+  : mode(CALIBRATION_RAW), points(0), threshold(0.0f), below(0.0f), above(0.0f)
+{
+  memset(terms, 0, sizeof(terms));
+  memset(counts, 0, sizeof(counts));
+  memset(values, 0, sizeof(values));
+}
+
+Calibration::Calibration()
+{
+  kinds[SENSOR_RAIN].mode = CALIBRATION_THRESHOLD;
+  kinds[SENSOR_RAIN].threshold = 2000.0f;
+  kinds[SENSOR_RAIN].below = 1.0f;
+  kinds[SENSOR_RAIN].above = 0.0f;
+}
+
+static void applyPoly(const SensorCalibration &c, const float *__restrict x, float *__restrict out, size_t n)
+{
+  const float c0 = c.terms[0], c1 = c.terms[1], c2 = c.terms[2], c3 = c.terms[3];
+  for (size_t i = 0; i < n; i++)
+  {
+    out[i] = ((c3 * x[i] + c2) * x[i] + c1) * x[i] + c0;
+  }
+}
+
+/**
+ * Sum of the slope of every segment times the part of it below x, so the
+ * points are walked outside the loop over the counts.
+ **/
+static void applyTable(const SensorCalibration &c, const float *__restrict x, float *__restrict out, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+  {
+    out[i] = c.values[0];
+  }
+  for (size_t p = 0; p + 1 < c.points; p++)
+  {
+    const float start = c.counts[p];
+    const float width = c.counts[p + 1] - start;
+    const float slope = (c.values[p + 1] - c.values[p]) / width;
+    for (size_t i = 0; i < n; i++)
+    {
+      float part = x[i] - start;
+      part = part < 0.0f ? 0.0f : part;
+      part = part > width ? width : part;
+      out[i] += slope * part;
+    }
+  }
+}
+
+static void applyThreshold(const SensorCalibration &c, const float *__restrict x, float *__restrict out,
+  size_t n)
+{
+  const float threshold = c.threshold, below = c.below, above = c.above;
+  for (size_t i = 0; i < n; i++)
+  {
+    out[i] = x[i] < threshold ? below : above;
+  }
+}
+
+void Calibration::apply(int kind, const uint16_t *raw, float *values, size_t count) const
+{
+  const SensorCalibration &c = kinds[kind];
+  float x[CALIBRATION_CHUNK];
+  for (size_t done = 0; done < count; done += CALIBRATION_CHUNK)
+  {
+    size_t n = count - done < CALIBRATION_CHUNK ? count - done : CALIBRATION_CHUNK;
+    float *out = values + done;
+    for (size_t i = 0; i < n; i++)
+    {
+      x[i] = raw[done + i];
+    }
+    switch (c.mode)
+    {
+      case CALIBRATION_POLY:
+        applyPoly(c, x, out, n);
+        break;
+      case CALIBRATION_TABLE:
+        applyTable(c, x, out, n);
+        break;
+      case CALIBRATION_THRESHOLD:
+        applyThreshold(c, x, out, n);
+        break;
+      default:
+        memcpy(out, x, n * sizeof(float));
+        break;
+    }
+  }
+}
+
+static bool parseFloat(const std::string &text, float &value)
+{
+  char *end;
+  value = strtof(text.c_str(), &end);
+  return !text.empty() && *end == 0;
+}
+
+/**
+ * Parses one "kind mode parameters" line into calibration.
+ **/
+bool Calibration::parseLine(const std::string &line, SensorCalibration &calibration, int &kind,
+  std::string &error)
+{
+  std::istringstream words(line);
+  std::string name, mode, word;
+  words >> name >> mode;
+  std::vector<std::string> parameters;
+  while (words >> word)
+  {
+    parameters.push_back(word);
+  }
+
+  kind = -1;
+  for (int k = 0; k < SENSOR_KIND_COUNT; k++)
+  {
+    kind = name == SENSOR_KINDS[k].topic ? k : kind;
+  }
+  if (kind < 0)
+  {
+    error = "unknown sensor kind " + name;
+    return false;
+  }
+
+  calibration = SensorCalibration();
+  if (mode == "raw" && parameters.empty())
+  {
+    return true;
+  }
+  if (mode == "poly" && !parameters.empty() && parameters.size() <= CALIBRATION_TERMS)
+  {
+    calibration.mode = CALIBRATION_POLY;
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+      if (!parseFloat(parameters[i], calibration.terms[i]))
+      {
+        error = "bad coefficient " + parameters[i];
+        return false;
+      }
+    }
+    return true;
+  }
+  if (mode == "table" && parameters.size() >= 2 && parameters.size() <= CALIBRATION_POINTS)
+  {
+    calibration.mode = CALIBRATION_TABLE;
+    calibration.points = parameters.size();
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+      size_t colon = parameters[i].find(':');
+      if (colon == std::string::npos ||
+          !parseFloat(parameters[i].substr(0, colon), calibration.counts[i]) ||
+          !parseFloat(parameters[i].substr(colon + 1), calibration.values[i]) ||
+          (i > 0 && calibration.counts[i] <= calibration.counts[i - 1]))
+      {
+        error = "bad point " + parameters[i] + ", expected increasing count:value";
+        return false;
+      }
+    }
+    return true;
+  }
+  if (mode == "threshold" && parameters.size() == 3)
+  {
+    calibration.mode = CALIBRATION_THRESHOLD;
+    if (!parseFloat(parameters[0], calibration.threshold) || !parseFloat(parameters[1], calibration.below) ||
+        !parseFloat(parameters[2], calibration.above))
+    {
+      error = "bad threshold parameters";
+      return false;
+    }
+    return true;
+  }
+  error = "expected raw, poly <c0> [<c1> <c2> <c3>], table <count:value>... (2 to 16) "
+    "or threshold <count> <below> <above>";
+  return false;
+}
+
+bool Calibration::load(const char *path, std::string &error)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    error = std::string("cannot read ") + path;
+    return false;
+  }
+
+  SensorCalibration loaded[SENSOR_KIND_COUNT];
+  for (int k = 0; k < SENSOR_KIND_COUNT; k++)
+  {
+    loaded[k] = kinds[k];
+  }
+  std::string line;
+  for (int number = 1; std::getline(file, line); number++)
+  {
+    size_t hash = line.find('#');
+    if (hash != std::string::npos)
+    {
+      line.erase(hash);
+    }
+    if (line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+      continue;
+    }
+    SensorCalibration calibration;
+    int kind;
+    if (!parseLine(line, calibration, kind, error))
+    {
+      std::ostringstream where;
+      where << path << ":" << number << ": " << error;
+      error = where.str();
+      return false;
+    }
+    loaded[kind] = calibration;
+  }
+  for (int k = 0; k < SENSOR_KIND_COUNT; k++)
+  {
+    kinds[k] = loaded[k];
+  }
+  return true;
+}
@@ -0,0 +1,264 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Checkpoint.cpp
+ * FUNCTION:        Snapshots of the subscriber state for warm restarts.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the checkpoints.
+ *
+ ***/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <iostream>
+#include "Checkpoint.h"
+
+uint64_t checkpointChecksum(const uint8_t *data, size_t count)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < count; i++)
+  {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+void CheckpointWriter::finish(int64_t created)
+{
+  CheckpointHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+  header.version = CHECKPOINT_VERSION;
+  header.sections = sections;
+  header.created = created;
+  header.bytes = buffer.size() - sizeof(header);
+  header.checksum = checkpointChecksum(&buffer[sizeof(header)], (size_t)header.bytes);
+  memcpy(&buffer[0], &header, sizeof(header));
+}
+
+CheckpointFile::CheckpointFile()
+  : created(0), busy(false), stopping(false), writes(0), failures(0), last_bytes(0), last_write_us(0)
+{
+}
+
+CheckpointFile::~CheckpointFile()
+{
+  close();
+}
+
+void CheckpointFile::open(const char *path)
+{
+  this->path = path;
+  stopping = false;
+  thread = std::thread(&CheckpointFile::run, this);
+}
+
+void CheckpointFile::close()
+{
+  if (!thread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_one();
+  thread.join();
+  path.clear();
+}
+
+CheckpointWriter *CheckpointFile::begin(bool wait)
+{
+  if (!isOpen())
+  {
+    return NULL;
+  }
+  if (busy.load(std::memory_order_acquire))
+  {
+    if (!wait)
+    {
+      return NULL;
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    wake.wait(guard, [this]() { return !busy.load(std::memory_order_acquire); });
+  }
+  snapshot.clear();
+  return &snapshot;
+}
+
+void CheckpointFile::commit(int64_t created)
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    this->created = created;
+    busy.store(true, std::memory_order_release);
+  }
+  wake.notify_all();
+}
+
+/**
+ * Writes the snapshots as they are committed; the one pending when
+ * stopping is still written.
+ **/
+void CheckpointFile::run()
+{
+  std::unique_lock<std::mutex> guard(lock);
+  for (;;)
+  {
+    wake.wait(guard, [this]() { return stopping || busy.load(std::memory_order_acquire); });
+    if (!busy.load(std::memory_order_acquire))
+    {
+      return;
+    }
+    guard.unlock();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    snapshot.finish(created);
+    std::string error;
+    if (writeFile(error))
+    {
+      writes.fetch_add(1, std::memory_order_relaxed);
+      last_bytes.store(snapshot.data().size(), std::memory_order_relaxed);
+      last_write_us.store(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+    }
+    else
+    {
+      failures.fetch_add(1, std::memory_order_relaxed);
+      std::cerr << "Error in checkpoint " << path << ": " << error << std::endl;
+    }
+
+    guard.lock();
+    busy.store(false, std::memory_order_release);
+    wake.notify_all();
+  }
+}
+
+bool CheckpointFile::writeFile(std::string &error)
+{
+  const std::vector<uint8_t> &data = snapshot.data();
+  std::string temporary = path + ".tmp";
+  int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    error = "cannot create " + temporary + ": " + strerror(errno);
+    return false;
+  }
+  void *map = MAP_FAILED;
+  bool ok = ftruncate(fd, (off_t)data.size()) == 0 &&
+    (map = mmap(NULL, data.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) != MAP_FAILED;
+  if (ok)
+  {
+    memcpy(map, data.data(), data.size());
+    ok = msync(map, data.size(), MS_SYNC) == 0;
+  }
+  if (!ok)
+  {
+    error = "cannot write " + temporary + ": " + strerror(errno);
+  }
+  if (map != MAP_FAILED)
+  {
+    munmap(map, data.size());
+  }
+  ::close(fd);
+  if (ok && rename(temporary.c_str(), path.c_str()) != 0)
+  {
+    error = "cannot rename " + temporary + ": " + strerror(errno);
+    ok = false;
+  }
+  if (!ok)
+  {
+    unlink(temporary.c_str());
+  }
+  return ok;
+}
+
+CheckpointImage::CheckpointImage()
+  : map(MAP_FAILED), length(0)
+{
+}
+
+CheckpointImage::~CheckpointImage()
+{
+  if (map != MAP_FAILED)
+  {
+    munmap(map, length);
+  }
+}
+
+bool CheckpointImage::open(const char *path, std::string &error)
+{
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+  {
+    error = std::string("cannot open ") + path + ": " + strerror(errno);
+    return false;
+  }
+  struct stat status;
+  bool mapped = fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(CheckpointHeader) &&
+    (map = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED;
+  ::close(fd);
+  if (!mapped)
+  {
+    error = std::string(path) + " is too short or cannot be mapped";
+    return false;
+  }
+  length = (size_t)status.st_size;
+
+  const uint8_t *bytes = (const uint8_t *)map;
+  CheckpointHeader header;
+  memcpy(&header, bytes, sizeof(header));
+  if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.version != CHECKPOINT_VERSION)
+  {
+    error = std::string(path) + " is not a checkpoint of this version";
+    return false;
+  }
+  if (header.bytes != length - sizeof(header) ||
+      header.checksum != checkpointChecksum(bytes + sizeof(header), length - sizeof(header)))
+  {
+    error = std::string(path) + " is truncated or corrupt";
+    return false;
+  }
+  return true;
+}
+
+int64_t CheckpointImage::created() const
+{
+  CheckpointHeader header;
+  memcpy(&header, map, sizeof(header));
+  return header.created;
+}
+
+bool CheckpointImage::section(const char *name, CheckpointReader &reader) const
+{
+  const uint8_t *bytes = (const uint8_t *)map;
+  size_t at = sizeof(CheckpointHeader);
+  CheckpointSection wanted;
+  memset(&wanted, 0, sizeof(wanted));
+  memcpy(wanted.name, name, strnlen(name, sizeof(wanted.name)));
+  while (length - at >= sizeof(CheckpointSection))
+  {
+    CheckpointSection section;
+    memcpy(&section, bytes + at, sizeof(section));
+    at += sizeof(section);
+    if (section.bytes > length - at)
+    {
+      return false;
+    }
+    if (memcmp(section.name, wanted.name, sizeof(wanted.name)) == 0)
+    {
+      reader = CheckpointReader(bytes + at, (size_t)section.bytes);
+      return true;
+    }
+    at += (size_t)section.bytes;
+  }
+  return false;
+}
@@ -0,0 +1,274 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Checkpoint.h
+ * FUNCTION:        Snapshots of the subscriber state for warm restarts.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for checkpointing the in memory state
+ * of c2 (sensor numbers, detector and liveness state, latest readings),
+ * so a restart picks up where it stopped instead of warming up again.
+ *
+ * A checkpoint is a header and named sections, each written by one
+ * component's save() and read back by its restore():
+ *
+ *   CheckpointHeader   magic, version, section count, creation time,
+ *                      length and FNV-1a checksum of what follows
+ *   CheckpointSection  name, length; then the bytes of the section
+ *   ...
+ *
+ * Values are stored in host byte order: a checkpoint is restored on the
+ * machine that wrote it.
+ *
+ * The snapshot is filled on the thread that owns the state, between two
+ * rounds of work, so it is consistent; filling it is a copy of the per
+ * sensor arrays. CheckpointFile then writes it on its own thread to
+ * "<path>.tmp" through a shared mapping, syncs it and renames it over
+ * path, so a crash leaves the previous checkpoint whole. While a write is
+ * in progress begin() returns NULL and the snapshot is skipped.
+ *
+ ***/
+
+#ifndef __CHECKPOINT_H__
+  #define __CHECKPOINT_H__
+
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include <atomic>
+  #include <condition_variable>
+  #include <mutex>
+  #include <string>
+  #include <thread>
+  #include <vector>
+
+  #define CHECKPOINT_MAGIC    "STKCKP1"
+  #define CHECKPOINT_VERSION  1
+
+  struct CheckpointHeader
+  {
+      char     magic[8];
+      uint32_t version;
+      uint32_t sections;
+      int64_t  created;         /* ms since the epoch */
+      uint64_t bytes;           /* of the sections after the header */
+      uint64_t checksum;        /* FNV-1a of those bytes */
+  };
+
+  struct CheckpointSection
+  {
+      char     name[8];
+      uint64_t bytes;           /* after this header */
+  };
+
+  uint64_t checkpointChecksum(const uint8_t *data, size_t count);
+
+  /**
+   * Builds a checkpoint in memory. Values are copied as they are, so only
+   * trivially copyable types are put.
+   **/
+  class CheckpointWriter
+  {
+      std::vector<uint8_t> buffer;
+      size_t section;           /* offset of the open section header */
+      uint32_t sections;
+    public:
+      CheckpointWriter() : section(0), sections(0) { clear(); }
+
+      /**
+       * Starts an empty checkpoint, keeping the memory of the last one.
+       **/
+      void clear()
+      {
+        buffer.assign(sizeof(CheckpointHeader), 0);
+        sections = 0;
+      }
+
+      void begin(const char *name)
+      {
+        CheckpointSection header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.name, name, strnlen(name, sizeof(header.name)));
+        section = buffer.size();
+        put(header);
+        sections++;
+      }
+
+      void end()
+      {
+        uint64_t bytes = buffer.size() - section - sizeof(CheckpointSection);
+        memcpy(&buffer[section + offsetof(CheckpointSection, bytes)], &bytes, sizeof(bytes));
+      }
+
+      void put(const void *data, size_t bytes)
+      {
+        const uint8_t *from = (const uint8_t *)data;
+        buffer.insert(buffer.end(), from, from + bytes);
+      }
+
+      template <typename T> void put(const T &value)
+      {
+        put(&value, sizeof(value));
+      }
+
+      template <typename T> void putVector(const std::vector<T> &values)
+      {
+        put((uint64_t)values.size());
+        if (!values.empty())
+        {
+          put(values.data(), values.size() * sizeof(T));
+        }
+      }
+
+      void putString(const std::string &text)
+      {
+        put((uint32_t)text.size());
+        put(text.data(), text.size());
+      }
+
+      /**
+       * Fills in the header; the checkpoint is then data().
+       **/
+      void finish(int64_t created);
+
+      const std::vector<uint8_t> &data() const { return buffer; }
+      size_t memoryUsage() const { return buffer.capacity(); }
+  };
+
+  /**
+   * Reads the values of one section back, checking every length against
+   * what is left of it.
+   **/
+  class CheckpointReader
+  {
+      const uint8_t *at;
+      const uint8_t *end;
+    public:
+      CheckpointReader(const uint8_t *data = NULL, size_t bytes = 0) : at(data), end(data + bytes) {}
+
+      bool get(void *data, size_t bytes)
+      {
+        if ((size_t)(end - at) < bytes)
+        {
+          return false;
+        }
+        memcpy(data, at, bytes);
+        at += bytes;
+        return true;
+      }
+
+      template <typename T> bool get(T &value)
+      {
+        return get(&value, sizeof(value));
+      }
+
+      template <typename T> bool getVector(std::vector<T> &values)
+      {
+        uint64_t count;
+        if (!get(count) || count > (size_t)(end - at) / sizeof(T))
+        {
+          return false;
+        }
+        values.resize((size_t)count);
+        return count == 0 || get(values.data(), (size_t)count * sizeof(T));
+      }
+
+      bool getString(std::string &text)
+      {
+        uint32_t length;
+        if (!get(length) || length > (size_t)(end - at))
+        {
+          return false;
+        }
+        text.assign((const char *)at, length);
+        at += length;
+        return true;
+      }
+
+      bool done() const { return at == end; }
+  };
+
+  /**
+   * Writes the snapshots of one checkpoint file on a thread of its own.
+   **/
+  class CheckpointFile
+  {
+      std::string path;
+      CheckpointWriter snapshot;
+      int64_t created;
+      std::atomic<bool> busy;
+      bool stopping;
+      std::mutex lock;
+      std::condition_variable wake;
+      std::thread thread;
+
+      std::atomic<uint64_t> writes;
+      std::atomic<uint64_t> failures;
+      std::atomic<uint64_t> last_bytes;
+      std::atomic<uint64_t> last_write_us;
+
+      void run();
+      bool writeFile(std::string &error);
+    public:
+      CheckpointFile();
+      ~CheckpointFile();
+
+      /**
+       * Starts writing the snapshots committed to path.
+       **/
+      void open(const char *path);
+
+      /**
+       * Writes the snapshot still pending, if any, and stops.
+       **/
+      void close();
+
+      bool isOpen() const { return !path.empty(); }
+
+      /**
+       * The snapshot to fill, emptied. NULL when closed, or while the
+       * previous snapshot is being written unless wait is set.
+       **/
+      CheckpointWriter *begin(bool wait = false);
+
+      /**
+       * Hands the snapshot filled since begin() to the writer thread;
+       * created (ms since the epoch) goes into its header.
+       **/
+      void commit(int64_t created);
+
+      uint64_t writeCount() const { return writes.load(std::memory_order_relaxed); }
+      uint64_t failureCount() const { return failures.load(std::memory_order_relaxed); }
+      uint64_t lastBytes() const { return last_bytes.load(std::memory_order_relaxed); }
+      double lastWriteSeconds() const { return last_write_us.load(std::memory_order_relaxed) / 1e6; }
+      size_t memoryUsage() const { return snapshot.memoryUsage(); }
+  };
+
+  /**
+   * A checkpoint file mapped for restoring.
+   **/
+  class CheckpointImage
+  {
+      void *map;
+      size_t length;
+    public:
+      CheckpointImage();
+      ~CheckpointImage();
+
+      /**
+       * Maps path and checks its header and checksum. Returns false with
+       * a message in error for a missing, foreign, truncated or corrupt
+       * file.
+       **/
+      bool open(const char *path, std::string &error);
+
+      int64_t created() const;
+
+      /**
+       * Sets reader to the section name; false when there is none.
+       **/
+      bool section(const char *name, CheckpointReader &reader) const;
+  };
+
+#endif
@@ -0,0 +1,106 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    CommandLine.cpp
+ * FUNCTION:        Command line helpers shared by the executables.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the option lookup.
+ *
+ ***/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "CommandLine.h"
+
+const char *getOption(int argc, char *argv[], const char *name, const char *defaultValue)
+{
+  for (int i = 1; i + 1 < argc; i++)
+  {
+    if (strcmp(argv[i], name) == 0)
+    {
+      return argv[i + 1];
+    }
+  }
+  return defaultValue;
+}
+
+long getIntOption(int argc, char *argv[], const char *name, long defaultValue)
+{
+  const char *value = getOption(argc, argv, name, NULL);
+  if (value == NULL)
+  {
+    return defaultValue;
+  }
+  return strtol(value, NULL, 10);
+}
+
+bool hasOption(int argc, char *argv[], const char *name)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], name) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool OptionSet::load(int argc, char *argv[], const char *path, int keep, std::string &error)
+{
+  std::vector<std::string> loaded;
+  for (int i = 0; i < keep && i < argc; i++)
+  {
+    loaded.push_back(argv[i]);
+  }
+  if (path != NULL)
+  {
+    std::ifstream file(path);
+    if (!file)
+    {
+      error = std::string("cannot read ") + path;
+      return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+      size_t hash = line.find('#');
+      if (hash != std::string::npos)
+      {
+        line.erase(hash);
+      }
+      std::istringstream words(line);
+      std::string name, value, word;
+      if (!(words >> name))
+      {
+        continue;
+      }
+      while (words >> word)
+      {
+        value += (value.empty() ? "" : " ") + word;
+      }
+      loaded.push_back(name.compare(0, 2, "--") == 0 ? name : "--" + name);
+      if (!value.empty())
+      {
+        loaded.push_back(value);
+      }
+    }
+  }
+  for (int i = keep; i < argc; i++)
+  {
+    loaded.push_back(argv[i]);
+  }
+
+  values.swap(loaded);
+  pointers.clear();
+  for (size_t i = 0; i < values.size(); i++)
+  {
+    pointers.push_back(&values[i][0]);
+  }
+  pointers.push_back(NULL);
+  return true;
+}
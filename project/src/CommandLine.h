@@ -0,0 +1,65 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    CommandLine.h
+ * FUNCTION:        Command line helpers shared by the executables.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the "--name value" option lookup
+ * used by edge_fake, c2 and the benchmark executables, and for option
+ * files: "name value" lines ("#" starts a comment) that are looked up as
+ * if given on the command line before its own options, so they win.
+ *
+ ***/
+
+#ifndef __COMMANDLINE_H__
+  #define __COMMANDLINE_H__
+
+  #include <string>
+  #include <vector>
+
+  /**
+   * Returns the argument following "name", or defaultValue when the
+   * option is not present.
+   **/
+  const char *getOption(int argc, char *argv[], const char *name, const char *defaultValue);
+
+  /**
+   * Returns the integer argument following "name", or defaultValue.
+   **/
+  long getIntOption(int argc, char *argv[], const char *name, long defaultValue);
+
+  /**
+   * Returns true when the flag "name" is present.
+   **/
+  bool hasOption(int argc, char *argv[], const char *name);
+
+  class OptionSet
+  {
+      std::vector<std::string> values;
+      std::vector<char *> pointers;
+    public:
+      OptionSet() {}
+      OptionSet(const OptionSet &) = delete;
+      OptionSet &operator=(const OptionSet &) = delete;
+
+      /**
+       * Builds the options of argv with those of the file path (NULL for
+       * none) inserted after its first keep arguments, e.g. 2 to keep a
+       * positional node id in argv[1]. Returns false with a message in
+       * error when the file cannot be read; nothing is changed then.
+       **/
+      bool load(int argc, char *argv[], const char *path, int keep, std::string &error);
+
+      int argc() { return (int)pointers.size() - 1; }
+      char **argv() { return &pointers[0]; }
+
+      /**
+       * Exchanges the options with those of other. The argv strings of
+       * both stay where they are.
+       **/
+      void swap(OptionSet &other) { values.swap(other.values); pointers.swap(other.pointers); }
+  };
+
+#endif
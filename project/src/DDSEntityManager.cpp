@@ -1,8 +1,14 @@
 
 #include "DDSEntityManager.h"
+#include "Sharding.h"
 
 
 void DDSEntityManager::createParticipant(const char *partitiontName)
+{
+  createParticipant(std::vector<std::string>(1, partitiontName));
+}
+
+void DDSEntityManager::createParticipant(const std::vector<std::string> &partitionNames)
 {
   domain = DOMAIN_ID_DEFAULT;
   dpf = DomainParticipantFactory::get_instance();
@@ -11,7 +17,7 @@ void DDSEntityManager::createParticipant(const char *partitiontName)
     STATUS_MASK_NONE);
   checkHandle(participant.in(),
     "DDS::DomainParticipantFactory::create_participant");
-  partition = partitiontName;
+  partitions = partitionNames;
 }
 
 void DDSEntityManager::deleteParticipant()
@@ -54,8 +60,7 @@ void DDSEntityManager::createPublisher()
 {
   status = participant->get_default_publisher_qos(pub_qos);
   checkStatus(status, "DDS::DomainParticipant::get_default_publisher_qos");
-  pub_qos.partition.name.length(1);
-  pub_qos.partition.name[0] = partition;
+  setPartitions(pub_qos.partition, partitions);
 
   publisher = participant->create_publisher(pub_qos, NULL, STATUS_MASK_NONE);
   checkHandle(publisher.in(), "DDS::DomainParticipant::create_publisher");
@@ -100,8 +105,7 @@ void DDSEntityManager::createSubscriber()
 {
   int status = participant->get_default_subscriber_qos(sub_qos);
   checkStatus(status, "DDS::DomainParticipant::get_default_subscriber_qos");
-  sub_qos.partition.name.length(1);
-  sub_qos.partition.name[0] = partition;
+  setPartitions(sub_qos.partition, partitions);
   subscriber = participant->create_subscriber(sub_qos, NULL, STATUS_MASK_NONE);
   checkHandle(subscriber.in(), "DDS::DomainParticipant::create_subscriber");
 }
@@ -3,6 +3,8 @@
   #define _DDSENTITYMGR_
 
 
+  #include <string>
+  #include <vector>
   #include "ccpp_dds_dcps.h"
   #include "CheckStatus.h"
   using namespace DDS;
@@ -29,10 +31,16 @@
       DomainId_t domain;
       ReturnCode_t status;
 
-      DDS::String_var partition;
+      std::vector<std::string> partitions;
       DDS::String_var typeName;
     public:
       void createParticipant(const char *partitiontName);
+
+      /**
+       * Publishers and subscribers created afterwards are in all of
+       * partitionNames (see Sharding.h); none means the default partition.
+       **/
+      void createParticipant(const std::vector<std::string> &partitionNames);
       void deleteParticipant();
       void registerType(TypeSupport *ts);
       void createTopic(char *topicName);
@@ -0,0 +1,246 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    DDSTransport.cpp
+ * FUNCTION:        OpenSplice backend of the transport interface.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the transport backend on
+ * OpenSplice.
+ *
+ ***/
+
+#include "DDSTransport.h"
+#include "CheckStatus.h"
+#include "Sharding.h"
+
+DDSTransportWriter::DDSTransportWriter(EnvironmentalData::EnvironmentalDataWriter_ptr writer)
+  : writer(writer)
+{
+}
+
+/**
+ * Deletes the writer together with its publisher.
+ **/
+DDSTransportWriter::~DDSTransportWriter()
+{
+  DDS::Publisher_var publisher = writer->get_publisher();
+  DDS::DomainParticipant_var participant = publisher->get_participant();
+  checkStatus(publisher->delete_datawriter(writer), "delete_datawriter() failed");
+  checkStatus(participant->delete_publisher(publisher), "delete_publisher() failed");
+}
+
+bool DDSTransportWriter::write(const TransportSample &in)
+{
+  sample.id = DDS::string_dup(in.id);
+  sample.type = DDS::string_dup(in.type);
+  sample.value = in.value;
+  DDS::ReturnCode_t status;
+  if (in.timestamp != 0)
+  {
+    DDS::Time_t timestamp;
+    timestamp.sec = (DDS::Long)(in.timestamp / 1000);
+    timestamp.nanosec = (DDS::ULong)(in.timestamp % 1000 * 1000000);
+    status = writer->write_w_timestamp(sample, DDS::HANDLE_NIL, timestamp);
+  }
+  else
+  {
+    status = writer->write(sample, DDS::HANDLE_NIL);
+  }
+  if (status == DDS::RETCODE_TIMEOUT)
+  {
+    return false;
+  }
+  checkStatus(status, "EnvironmentalDataWriter::write");
+  return true;
+}
+
+DDSTransportReader::DDSTransportReader(EnvironmentalData::EnvironmentalDataReader_ptr reader)
+  : reader(reader)
+{
+  condition = reader->create_readcondition(DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+    DDS::ANY_INSTANCE_STATE);
+  checkHandle(condition.in(), "create_readcondition() failed");
+  waitset = new DDS::WaitSet();
+  checkStatus(waitset->attach_condition(condition.in()), "WaitSet::attach_condition");
+}
+
+/**
+ * Deletes the reader together with its condition and subscriber.
+ **/
+DDSTransportReader::~DDSTransportReader()
+{
+  checkStatus(waitset->detach_condition(condition.in()), "WaitSet::detach_condition");
+  checkStatus(reader->delete_readcondition(condition.in()), "delete_readcondition() failed");
+  DDS::Subscriber_var subscriber = reader->get_subscriber();
+  DDS::DomainParticipant_var participant = subscriber->get_participant();
+  checkStatus(subscriber->delete_datareader(reader), "delete_datareader() failed");
+  checkStatus(participant->delete_subscriber(subscriber), "delete_subscriber() failed");
+}
+
+/**
+ * Reads or takes on loan and converts the valid samples; a read leaves
+ * them in the reader.
+ **/
+size_t DDSTransportReader::fetch(std::vector<TransportSample> &out, size_t maxSamples, bool remove)
+{
+  out.clear();
+  DDS::Long limit = maxSamples >= (size_t)0x7fffffff ? DDS::LENGTH_UNLIMITED : (DDS::Long)maxSamples;
+  DDS::ReturnCode_t status;
+  if (remove)
+  {
+    status = reader->take(samples, infos, limit, DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+      DDS::ANY_INSTANCE_STATE);
+    checkStatus(status, "EnvironmentalDataReader::take");
+  }
+  else
+  {
+    status = reader->read(samples, infos, limit, DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE,
+      DDS::ANY_INSTANCE_STATE);
+    checkStatus(status, "EnvironmentalDataReader::read");
+  }
+  if (status == DDS::RETCODE_NO_DATA)
+  {
+    return 0;
+  }
+
+  TransportSample sample;
+  for (DDS::ULong i = 0; i < samples.length(); i++)
+  {
+    if (infos[i].valid_data)
+    {
+      transportCopy(sample.id, samples[i].id);
+      transportCopy(sample.type, samples[i].type);
+      sample.value = samples[i].value;
+      sample.timestamp = (int64_t)infos[i].source_timestamp.sec * 1000 +
+        infos[i].source_timestamp.nanosec / 1000000;
+      out.push_back(sample);
+    }
+  }
+  checkStatus(reader->return_loan(samples, infos), "EnvironmentalDataReader::return_loan");
+  return out.size();
+}
+
+size_t DDSTransportReader::read(std::vector<TransportSample> &out, size_t maxSamples)
+{
+  return fetch(out, maxSamples, false);
+}
+
+size_t DDSTransportReader::take(std::vector<TransportSample> &out, size_t maxSamples)
+{
+  return fetch(out, maxSamples, true);
+}
+
+bool DDSTransportReader::wait(int64_t timeoutMs)
+{
+  DDS::ConditionSeq active;
+  DDS::Duration_t timeout = { (DDS::Long)(timeoutMs / 1000), (DDS::ULong)(timeoutMs % 1000 * 1000000) };
+  DDS::ReturnCode_t status = waitset->wait(active, timeout);
+  if (status == DDS::RETCODE_TIMEOUT)
+  {
+    return false;
+  }
+  checkStatus(status, "WaitSet::wait");
+  return true;
+}
+
+uint64_t DDSTransportReader::lost()
+{
+  DDS::SampleLostStatus status = DDS::SampleLostStatus();
+  checkStatus(reader->get_sample_lost_status(status), "get_sample_lost_status() failed");
+  return (uint64_t)status.total_count;
+}
+
+DDSTransport::DDSTransport(DDS::DomainParticipant_ptr participant, int argc, char *argv[])
+  : participant(DDS::DomainParticipant::_duplicate(participant)), arg_count(argc), args(argv),
+    reader_partitions(shardSubscription(argc, argv)), reader_samples(-1), reader_purge(0)
+{
+  EnvironmentalData::EnvironmentalTypeSupport_var typesupport = new EnvironmentalData::EnvironmentalTypeSupport();
+  type_name = typesupport->get_type_name();
+  checkStatus(typesupport->register_type(participant, type_name), "register_type() failed");
+}
+
+/**
+ * Deletes the topics; the writers and readers must be deleted first.
+ **/
+DDSTransport::~DDSTransport()
+{
+  for (std::map<std::string, DDS::Topic_var>::iterator it = topics.begin(); it != topics.end(); ++it)
+  {
+    checkStatus(participant->delete_topic(it->second), "delete_topic() failed");
+  }
+}
+
+DDS::Topic_ptr DDSTransport::topic(const char *name)
+{
+  DDS::Topic_var &slot = topics[name];
+  if (!slot)
+  {
+    DDS::TopicQos tQos;
+    checkStatus(qos.provider(arg_count, args, name).get_topic_qos(tQos, NULL), "get_topic_qos() failed");
+    slot = participant->create_topic(name, type_name, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(slot, std::string("create_topic() ") + name + " failed");
+  }
+  return slot;
+}
+
+void DDSTransport::setReaderLimits(long maxSamples, int64_t purgeMs)
+{
+  reader_samples = maxSamples;
+  reader_purge = purgeMs;
+}
+
+DDSTransportWriter *DDSTransport::createWriter(const char *name)
+{
+  DDS::QosProvider &qp = qos.provider(arg_count, args, name);
+  DDS::PublisherQos pQos;
+  checkStatus(qp.get_publisher_qos(pQos, NULL), "get_publisher_qos() failed");
+  setPartitions(pQos.partition, writer_partitions);
+  DDS::Publisher_var publisher = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(publisher, std::string("create_publisher() ") + name + " failed");
+
+  DDS::DataWriterQos wQos;
+  checkStatus(qp.get_datawriter_qos(wQos, NULL), "get_datawriter_qos() failed");
+  DDS::DataWriter_var writer = publisher->create_datawriter(topic(name), wQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(writer, std::string("create_datawriter() ") + name + " failed");
+
+  EnvironmentalData::EnvironmentalDataWriter_ptr typed = EnvironmentalData::EnvironmentalDataWriter::_narrow(writer);
+  checkHandle(typed, std::string("EnvironmentalDataWriter::_narrow() ") + name + " failed");
+  return new DDSTransportWriter(typed);
+}
+
+DDSTransportReader *DDSTransport::createReader(const char *name)
+{
+  DDS::QosProvider &qp = qos.provider(arg_count, args, name);
+  DDS::SubscriberQos sQos;
+  checkStatus(qp.get_subscriber_qos(sQos, NULL), "get_subscriber_qos() failed");
+  setPartitions(sQos.partition, reader_partitions);
+  DDS::Subscriber_var subscriber = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(subscriber, std::string("create_subscriber() ") + name + " failed");
+
+  DDS::DataReaderQos rQos;
+  checkStatus(qp.get_datareader_qos(rQos, NULL), "get_datareader_qos() failed");
+  if (reader_samples >= 0)
+  {
+    DDS::Duration_t purge;
+    purge.sec = (DDS::Long)(reader_purge / 1000);
+    purge.nanosec = (DDS::ULong)(reader_purge % 1000 * 1000000);
+    rQos.resource_limits.max_samples = (DDS::Long)reader_samples;
+    rQos.resource_limits.max_instances = (DDS::Long)reader_samples;
+    rQos.resource_limits.max_samples_per_instance = (DDS::Long)reader_samples;
+    rQos.reader_data_lifecycle.autopurge_nowriter_samples_delay = purge;
+    rQos.reader_data_lifecycle.autopurge_disposed_samples_delay = purge;
+    if (rQos.history.kind == DDS::KEEP_LAST_HISTORY_QOS && rQos.history.depth > (DDS::Long)reader_samples)
+    {
+      /* A depth above the limit is an inconsistent policy. */
+      rQos.history.depth = (DDS::Long)reader_samples;
+    }
+  }
+  DDS::DataReader_var reader = subscriber->create_datareader(topic(name), rQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(reader, std::string("create_datareader() ") + name + " failed");
+
+  EnvironmentalData::EnvironmentalDataReader_ptr typed = EnvironmentalData::EnvironmentalDataReader::_narrow(reader);
+  checkHandle(typed, std::string("EnvironmentalDataReader::_narrow() ") + name + " failed");
+  return new DDSTransportReader(typed);
+}
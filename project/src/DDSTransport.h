@@ -0,0 +1,106 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    DDSTransport.h
+ * FUNCTION:        OpenSplice backend of the transport interface.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the transport backend on
+ * OpenSplice. Every topic carries the EnvironmentalData type with the
+ * QoS profile QosCatalogue picks for it from the command line; each
+ * writer and reader has its own publisher or subscriber.
+ *
+ * Readers bind to the shard partitions of "--shard-set" when the command
+ * line enables sharding or names --partition (see Sharding.h); writers
+ * use the partitions of their QoS profile unless setWriterPartitions()
+ * says otherwise.
+ *
+ * The backend creates its entities on a participant owned by the caller
+ * and deletes them when it is destroyed, before the participant.
+ *
+ ***/
+
+#ifndef __DDSTRANSPORT_H__
+  #define __DDSTRANSPORT_H__
+
+  #include <map>
+  #include <string>
+  #include <vector>
+  #include "ccpp_dds_dcps.h"
+  #include "ccpp_EnvironmentalData.h"
+  #include "QosCatalogue.h"
+  #include "Transport.h"
+
+  class DDSTransportWriter : public TransportWriter
+  {
+      EnvironmentalData::EnvironmentalDataWriter_var writer;
+      EnvironmentalData::Environmental sample;
+    public:
+      DDSTransportWriter(EnvironmentalData::EnvironmentalDataWriter_ptr writer);
+      ~DDSTransportWriter();
+      bool write(const TransportSample &sample);
+      DDS::DataWriter_ptr dataWriter() { return writer.in(); }
+  };
+
+  class DDSTransportReader : public TransportReader
+  {
+      EnvironmentalData::EnvironmentalDataReader_var reader;
+      DDS::ReadCondition_var condition;
+      DDS::WaitSet_var waitset;
+      EnvironmentalData::EnvironmentalSeq samples;
+      DDS::SampleInfoSeq infos;
+
+      size_t fetch(std::vector<TransportSample> &out, size_t maxSamples, bool remove);
+    public:
+      DDSTransportReader(EnvironmentalData::EnvironmentalDataReader_ptr reader);
+      ~DDSTransportReader();
+      size_t read(std::vector<TransportSample> &samples, size_t maxSamples = SIZE_MAX);
+      size_t take(std::vector<TransportSample> &samples, size_t maxSamples = SIZE_MAX);
+      bool wait(int64_t timeoutMs);
+      uint64_t lost();
+
+      /**
+       * The underlying reader, for its status counters.
+       **/
+      DDS::DataReader_ptr dataReader() { return reader.in(); }
+  };
+
+  class DDSTransport : public Transport
+  {
+      DDS::DomainParticipant_var participant;
+      QosCatalogue qos;
+      int arg_count;
+      char **args;
+      DDS::String_var type_name;
+      std::vector<std::string> reader_partitions;
+      std::vector<std::string> writer_partitions;
+      long reader_samples;
+      int64_t reader_purge;
+      std::map<std::string, DDS::Topic_var> topics;
+
+      DDS::Topic_ptr topic(const char *name);
+    public:
+      /**
+       * argc/argv select the QoS profile of every topic (see QosCatalogue.h)
+       * and the shards read (see Sharding.h).
+       **/
+      DDSTransport(DDS::DomainParticipant_ptr participant, int argc, char *argv[]);
+      ~DDSTransport();
+      DDSTransportWriter *createWriter(const char *topic);
+      DDSTransportReader *createReader(const char *topic);
+
+      /**
+       * Partitions of the writers created afterwards.
+       **/
+      void setWriterPartitions(const std::vector<std::string> &names) { writer_partitions = names; }
+
+      /**
+       * Bounds the readers created afterwards to maxSamples samples (and
+       * instances), and purges the samples of instances without writers
+       * or disposed after purgeMs. maxSamples < 0 keeps the profile.
+       **/
+      void setReaderLimits(long maxSamples, int64_t purgeMs);
+  };
+
+#endif
@@ -0,0 +1,116 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    DashboardBridge.cpp
+ * FUNCTION:        Bridge from the sensor topics to the dashboard.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'bridge' executable.
+ *
+ * This executable:
+ * - takes the readings of the --topics topics (default humidity,
+ *   temperature, rain) every --poll-us microseconds
+ * - keeps the last reading of every sensor
+ * - pushes the readings changed since the last frame to the dashboard
+ *   clients --fps times a second (see BridgeServer.h for the protocol)
+ *
+ * Usage: bridge [--topics humidity,temperature,rain] [--ws-port 8081]
+ *          [--tcp-port 0] [--format json|binary] [--fps 10]
+ *          [--client-buffer-kb 256] [--client-timeout-ms 10000]
+ *          [--poll-us 10000] [--metrics-port <port>] [--qos-profile <name>]
+ *          [--shards <n> --shard-set <list>]
+ *
+ ***/
+
+#include <signal.h>
+#include <stdlib.h>
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include "ccpp_dds_dcps.h"
+#include "example_main.h"
+#include "CheckStatus.h"
+#include "CommandLine.h"
+#include "DDSTransport.h"
+#include "BridgeServer.h"
+#include "Metrics.h"
+#include "SensorSchema.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void stopRunning(int signum)
+{
+  running = 0;
+}
+
+int OSPL_MAIN (int argc, char *argv[])
+{
+  BridgeFormat format;
+  if (!BridgeServer::parseFormat(getOption(argc, argv, "--format", "json"), format))
+  {
+    cerr << "Error in --format: expected json or binary" << endl;
+    exit(1);
+  }
+  std::vector<std::string> topics;
+  std::string allTopics = sensorKindTopics();
+  std::stringstream list(getOption(argc, argv, "--topics", allTopics.c_str()));
+  std::string topic;
+  while (std::getline(list, topic, ','))
+  {
+    if (!topic.empty())
+    {
+      topics.push_back(topic);
+    }
+  }
+  long period = getIntOption(argc, argv, "--poll-us", 10000);
+
+  DDS::DomainParticipantFactory_var factory = DDS::DomainParticipantFactory::get_instance();
+  checkHandle(factory, "get_instance() failed");
+  DDS::DomainParticipant_var participant = factory->create_participant(DDS::DOMAIN_ID_DEFAULT,
+    PARTICIPANT_QOS_DEFAULT, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(participant, "create_participant() failed");
+
+  LatestValues latest;
+  BridgeServer server(latest);
+  MetricsExporter metricsExporter(metrics());
+  {
+    DDSTransport transport(participant, argc, argv);
+    std::vector<std::unique_ptr<DDSTransportReader> > readers;
+    for (size_t i = 0; i < topics.size(); i++)
+    {
+      readers.push_back(std::unique_ptr<DDSTransportReader>(transport.createReader(topics[i].c_str())));
+    }
+
+    server.start(getIntOption(argc, argv, "--ws-port", 8081), getIntOption(argc, argv, "--tcp-port", 0),
+      format, getIntOption(argc, argv, "--fps", 10), getIntOption(argc, argv, "--client-buffer-kb", 256) * 1024,
+      getIntOption(argc, argv, "--client-timeout-ms", 10000));
+    metricsExporter.start(getIntOption(argc, argv, "--metrics-port", 0));
+    Gauge &sensors = metrics().gauge("stack_bridge_sensors", "Sensors with a last value.");
+
+    signal(SIGINT, stopRunning);
+    signal(SIGTERM, stopRunning);
+    cout << "=== [Bridge] Ready ..." << endl;
+
+    std::vector<TransportSample> samples;
+    while (running)
+    {
+      for (size_t i = 0; i < readers.size(); i++)
+      {
+        readers[i]->take(samples);
+        latest.update(topics[i].c_str(), samples.data(), samples.size());
+      }
+      sensors.set(latest.size());
+      std::this_thread::sleep_for(std::chrono::microseconds(period));
+    }
+
+    server.stop();
+    metricsExporter.stop();
+  }
+  checkStatus(factory->delete_participant(participant), "delete_participant() failed");
+  return 0;
+}
@@ -39,12 +39,31 @@
  *
  ***/
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <algorithm>
 #include <iostream>
+#include <mutex>
 #include <random>
+#include <sstream>
+#include <chrono>
 #include "ccpp_dds_dcps.h"        /* Include the DDS::DCPS API */
 #include "ccpp_EnvironmentalData.h"  /* Include the generated type specific (EnvironmentalData) DCPS API */
 #include "example_main.h"         /* Include to define the application main() wrapper OSPL_MAIN. */
 #include "QosProvider.h"
+#include "QosCatalogue.h"
+#include "CommandLine.h"
+#include "Metrics.h"
+#include "Sharding.h"
+#include "SensorSchema.h"
+#include "AdaptiveSampler.h"
+#include "SerialFrame.h"
+#include "Calibration.h"
+#include "FileWatcher.h"
+#include "SummaryWriter.h"
 //#include <SerialStream.h>
 
 using namespace std;
@@ -52,12 +71,8 @@ using namespace std;
 
 #define SERIAL_PORT  "/dev/ttyS1"
 #define SERIAL_BAUD 115200
+#define SERIAL_READ_FRAMES 64   /* frames taken from the board in one read at most */
 
-struct Sensors{
-    float temperature;
-    float humidity;
-    float rain;
-};
 /**
  * Check the return status for errors.
  * If there is an error, then report info message and terminate.
@@ -82,93 +97,156 @@ extern "C"
     DDS::DomainId_t                   domain;
     DDS::DomainParticipant_var        participant;
 
-    DDS::Topic_var                    topicHumidity;
-    DDS::Topic_var                    topicTemperature;
-    DDS::Topic_var                    topicRain;    
+    DDS::ReturnCode_t result;
+    DDS::String_var                   typeName;
 
-    DDS::Publisher_var                publisherHumidity;
-    DDS::Publisher_var                publisherTemperature;  
-    DDS::Publisher_var                publisherRain;
+/* --qos-file <path> (default DDS_DefaultQoS.xml) holds the profiles. */
+    QosCatalogue                      qos;
+    string                            qosFile;
 
-    DDS::DataWriter_var               writerHumidity;
-    DDS::DataWriter_var               writerTemperature;
-    DDS::DataWriter_var               writerRain;
-    
-    EnvironmentalData::EnvironmentalDataWriter_var  myWriterHumidity;   
-    EnvironmentalData::EnvironmentalDataWriter_var  myWriterTemperature;
-    EnvironmentalData::EnvironmentalDataWriter_var  myWriterRain;
+/* --config <file>: the command line, the options merged with those of
+ * the file, and the files watched for changes while running. */
+    int                               commandArgc;
+    char                              **commandArgv;
+    const char                        *configFile = NULL;
+    OptionSet                         options;
+    FileWatcher                       watcher;
 
-    DDS::ReturnCode_t result;
-/*
- * The main function of the Publisher application
- */
-int EnvironmentalDataPublisher (int argc, char *argv[])
+/**
+ * Samples written and time spent in write() for one topic.
+ **/
+struct WriterMetrics
 {
-    /* The DDS entities required to publish data */
+    Counter &written;
+    Histogram &write_time;
+
+    WriterMetrics(const char *topic)
+      : written(metrics().counter("stack_samples_written_total", "Samples written.",
+          metricsLabel("topic", topic))),
+        write_time(metrics().histogram("stack_write_duration_seconds", "Time spent in write().",
+          metricsLabel("topic", topic)))
+    {
+    }
 
-    //=======Load Qos Policy file======
-    DDS::QosProvider qp("file://DDS_DefaultQoS.xml", "DefaultQosProfile");
+    void record(chrono::steady_clock::time_point start)
+    {
+        written.add();
+        write_time.observe(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+};
 
-    /* The Application EnvironmentalData Data TypeSupport */
-    EnvironmentalData::EnvironmentalTypeSupport_var typesupport;
+    MetricsExporter metricsExporter(metrics());
 
-    DDS::String_var typeName;
+/* Partition of the shard of this node, "" without sharding. */
+    string shardPartition;
 
-  // Get the DDS DomainParticipantFactory
-    factory = DDS::DomainParticipantFactory::get_instance();
-    checkHandle(factory, "get_instance() failed");
+/**
+ * Summaries of the readings of one topic over --summary-window-ms,
+ * published on "<topic>_summary" when a window closes.
+ **/
+struct EdgeSummary
+{
+    SensorAggregator aggregator;
+    SummaryWriter writer;
+    TransportSample sample;
+    vector<SensorWindow> windows;
+
+    EdgeSummary(DDS::QosProvider &qp, const char *topic, int64_t windowMs)
+      : aggregator(windowMs),
+        writer(participant, qp, topic, vector<string>(shardPartition.empty() ? 0 : 1, shardPartition))
+    {
+    }
 
-  // Create a domain participant entity for the Default Domain (Domain Id = 0)
-    domain = DDS::DOMAIN_ID_DEFAULT;
-    participant = factory->create_participant(domain, PARTICIPANT_QOS_DEFAULT, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(participant, "create_participant() failed");
-    
-  // Register the application data type
-    typesupport = new EnvironmentalData::EnvironmentalTypeSupport();
-    /* Get the IDL type name and use this to register the type. */
-    typeName = typesupport->get_type_name();
-    result = typesupport->register_type(participant, typeName);
-    checkStatus(result, "register_type() failed");
+    static int64_t currentTime()
+    {
+        return chrono::duration_cast<chrono::milliseconds>(
+            chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Publishes the window that closed before now, if any. Called before
+     * every reading and once per round, so a sensor read seldom or no
+     * more still gets its last window out.
+     **/
+    void flushDue(int64_t now)
+    {
+        if (aggregator.due(now)) {
+            int64_t windowEnd = aggregator.windowEnd();
+            aggregator.flush(now, windows);
+            writer.write(aggregator, windows, windowEnd);
+        }
+    }
+
+    void add(const EnvironmentalData::Environmental &instance)
+    {
+        int64_t now = currentTime();
+        flushDue(now);
+        transportCopy(sample.id, instance.id.in());
+        transportCopy(sample.type, instance.type.in());
+        sample.value = instance.value;
+        sample.timestamp = now;
+        aggregator.add(&sample, 1, now);
+    }
+};
+
+/**
+ * The entities, sample and metrics of one sensor kind (see SensorSchema.h).
+ * The summary is created when --summary-window-ms is given, the sampler
+ * with --adaptive; next_us is when the sensor is read next. profile is
+ * the QoS profile of the entities and enabled whether --sensors lists the
+ * kind.
+ **/
+struct KindPublisher
+{
+    string                            profile;
+    bool                              enabled;
+    DDS::Topic_var                    topic;
+    DDS::Publisher_var                publisher;
+    DDS::DataWriter_var               writer;
+    EnvironmentalData::EnvironmentalDataWriter_var  typedWriter;
+    EnvironmentalData::Environmental  instance;
+    WriterMetrics                     *metrics;
+    EdgeSummary                       *summary;
+    string                            writeFailed;
+    AdaptiveSampler                   *sampler;
+    int64_t                           next_us;
+    Gauge                             *period;
+};
+
+    KindPublisher                     kinds[SENSOR_KIND_COUNT];
+
+/* Held while the entities of a kind are replaced, as the metrics thread
+ * reads the writers. */
+    mutex                             writersLock;
+
+/* --summary-only drops the raw writes. */
+    bool                              rawEnabled = true;
+
+/**
+ * Creates the topic, publisher and writer of one topic with the QoS of
+ * the profile selected for it.
+ **/
+static void createTopicWriter(DDS::QosProvider &qp, const char *name, const char *typeName,
+    DDS::Topic_var &topic, DDS::Publisher_var &publisher, DDS::DataWriter_var &writer)
+{
+    string what = string(" ") + name + " failed";
 
   // Create Topic entity
-    /* Create and initialize topic qos value on heap. */
     DDS::TopicQos tQos;
-    //result = participant->get_default_topic_qos(tQos);
     result = qp.get_topic_qos(tQos, NULL);
     checkStatus(result, "get_default_topic_qos() failed");
-
-    /* Fine tune topic qos, i.e. make topic reliable and transient (for late joining subscribers) */
-    //tQos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
-    //tQos.durability.kind = DDS::TRANSIENT_DURABILITY_QOS;
-    /* Use the changed policy when defining the EnvironmentalData topic */
-    topicHumidity = participant->create_topic("humidity", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicHumidity, "create_topic() humidity failed");
-	
-    topicTemperature = participant->create_topic("temperature", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicTemperature, "create_topic() temperature failed");
-    
-	topicRain = participant->create_topic("rain", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicRain, "create_topic() rain failed");
+    topic = participant->create_topic(name, typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(topic, "create_topic()" + what);
 
   // Create Publisher entity
-    /* Create on heap and initialize publisher qos value with the default value. */
     DDS::PublisherQos pQos;
-    //result = participant->get_default_publisher_qos(pQos);
     result = qp.get_publisher_qos(pQos, NULL);
     checkStatus(result, "get_default_publisher_qos() failed");
 
-    /* Fine tune the partition qos policy ito the partition in which the data will be published. */
-    //pQos.partition.name.length(1);
-    //pQos.partition.name[0] = "EnvironmentalData Partition";
-    /* Create the publisher. */
-    publisherHumidity = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(publisherHumidity, "create_publisher() humidity failed");
-	
-    publisherTemperature = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(publisherTemperature, "create_publisher() temperature failed");
-    
-	publisherRain = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(publisherRain, "create_publisher() rain failed");
+    /* Publish into the partition of the shard of this node. */
+    setPartitions(pQos.partition, vector<string>(shardPartition.empty() ? 0 : 1, shardPartition));
+    publisher = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(publisher, "create_publisher()" + what);
 
   // create DataWriter entity
     DDS::DataWriterQos wQos;
@@ -180,71 +258,183 @@ int EnvironmentalDataPublisher (int argc, char *argv[])
      * you will have to start the subscriber before the publisher
      */
     //wQos.writer_data_lifecycle.autodispose_unregistered_instances = false;
+    writer = publisher->create_datawriter(topic, wQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(writer, "create_datawriter()" + what);
+}
 
-    writerHumidity = publisherHumidity->create_datawriter(topicHumidity, wQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(writerHumidity, "create_datawriter() humidity failed");
-    
-	writerTemperature = publisherTemperature->create_datawriter(topicTemperature, wQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(writerTemperature, "create_datawriter() temperature failed");
-    
-	writerRain = publisherRain->create_datawriter(topicRain, wQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(writerRain, "create_datawriter() rain failed");
+/**
+ * Creates the entities of sensor kind k with the QoS of profile.
+ **/
+static void createKind(int k, const char *profile)
+{
+    KindPublisher &kind = kinds[k];
+    const char *topic = SENSOR_KINDS[k].topic;
+    createTopicWriter(qos.provider(profile), topic, typeName, kind.topic, kind.publisher, kind.writer);
 
     /* Cast writer to 'EnvironmentalData' type specific interface. */
-    myWriterHumidity = EnvironmentalData::EnvironmentalDataWriter::_narrow(writerHumidity);
-    checkHandle(myWriterHumidity, "EnvironmentalDataWriter::_narrow() humidity failed");
-    
-	myWriterTemperature = EnvironmentalData::EnvironmentalDataWriter::_narrow(writerTemperature);
-    checkHandle(myWriterTemperature, "EnvironmentalDataWriter::_narrow() temperature failed");
-    
-	myWriterRain = EnvironmentalData::EnvironmentalDataWriter::_narrow(writerRain);
-    checkHandle(myWriterRain, "EnvironmentalDataWriter::_narrow() rain failed");
+    kind.typedWriter = EnvironmentalData::EnvironmentalDataWriter::_narrow(kind.writer);
+    checkHandle(kind.typedWriter, string("EnvironmentalDataWriter::_narrow() ") + topic + " failed");
+    kind.profile = profile;
+}
 
-    cout << "=== [Publisher Fake] Ready ..." << endl;
-    return 0;
+static void deleteKind(int k)
+{
+    KindPublisher &kind = kinds[k];
+    string what = string(" ") + SENSOR_KINDS[k].topic + " failed";
+    result = kind.publisher->delete_datawriter(kind.writer);
+    checkStatus(result, ("delete_datawriter()" + what).c_str());
+    result = participant->delete_publisher(kind.publisher);
+    checkStatus(result, "delete_publisher() failed");
+    result = participant->delete_topic(kind.topic);
+    checkStatus(result, ("delete_topic()" + what).c_str());
 }
 
-void HumidityPublish(EnvironmentalData::Environmental& instance)
+/**
+ * Sets enabled from a list of sensor kinds such as "humidity,rain" or
+ * "all". False with a message in error for an unknown kind.
+ **/
+static bool parseSensors(const char *list, bool *enabled, string &error)
+{
+    string names(list);
+    replace(names.begin(), names.end(), ',', ' ');
+    istringstream words(names);
+    fill(enabled, enabled + SENSOR_KIND_COUNT, false);
+    string name;
+    while (words >> name) {
+        if (name == "all") {
+            fill(enabled, enabled + SENSOR_KIND_COUNT, true);
+            continue;
+        }
+        int kind = -1;
+        for (int k = 0; k < SENSOR_KIND_COUNT; k++) {
+            kind = name == SENSOR_KINDS[k].topic ? k : kind;
+        }
+        if (kind < 0) {
+            error = "unknown sensor kind " + name + ", expected some of " + sensorKindTopics() + " or all";
+            return false;
+        }
+        enabled[kind] = true;
+    }
+    return true;
+}
+
+/*
+ * The main function of the Publisher application
+ */
+int EnvironmentalDataPublisher (int argc, char *argv[])
 {
-  result = myWriterHumidity->write(instance, DDS::HANDLE_NIL);
-  checkStatus(result, "SensorDataWriter::write humidity");
+    /* The DDS entities required to publish data */
+
+    //=======Load Qos Policy file======
+    /* --qos-profile <name> selects the profile of every topic and
+     * --qos-<topic> <name> the profile of one topic (see QosCatalogue.h). */
+    qosFile = getOption(argc, argv, "--qos-file", QOS_DEFAULT_FILE);
+    qos.reload("file://" + qosFile);
+
+    /* --sensors <list> publishes only the kinds listed (default all). */
+    bool enabled[SENSOR_KIND_COUNT];
+    string sensorsError;
+    if (!parseSensors(getOption(argc, argv, "--sensors", "all"), enabled, sensorsError)) {
+        cerr << "Error in --sensors: " << sensorsError << endl;
+        exit(1);
+    }
+
+    /* --shards <n> publishes into the partition of the shard of the node
+     * id (see Sharding.h). */
+    ShardMap shards = ShardMap::fromCommandLine(argc, argv);
+    shardPartition = shards.partitionOf(argv[1]);
+    if (shards.enabled()) {
+        cout << "=== [Publisher Fake] Node " << argv[1] << " publishes into partition "
+             << shardPartition << endl;
+    }
+
+    /* The Application EnvironmentalData Data TypeSupport */
+    EnvironmentalData::EnvironmentalTypeSupport_var typesupport;
+
+  // Get the DDS DomainParticipantFactory
+    factory = DDS::DomainParticipantFactory::get_instance();
+    checkHandle(factory, "get_instance() failed");
+
+  // Create a domain participant entity for the Default Domain (Domain Id = 0)
+    domain = DDS::DOMAIN_ID_DEFAULT;
+    participant = factory->create_participant(domain, PARTICIPANT_QOS_DEFAULT, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(participant, "create_participant() failed");
+    
+  // Register the application data type
+    typesupport = new EnvironmentalData::EnvironmentalTypeSupport();
+    /* Get the IDL type name and use this to register the type. */
+    typeName = typesupport->get_type_name();
+    result = typesupport->register_type(participant, typeName);
+    checkStatus(result, "register_type() failed");
+
+    /* --summary-window-ms <ms> also publishes min/max/mean/count per
+     * sensor and window on "<topic>_summary" (see SummaryWriter.h);
+     * --summary-only publishes them instead of the raw readings. */
+    long summaryWindow = getIntOption(argc, argv, "--summary-window-ms", 0);
+
+    /* One topic, writer and summary per sensor kind. */
+    SensorKinds<>::forEach([&](int k) {
+        KindPublisher &kind = kinds[k];
+        const char *topic = SENSOR_KINDS[k].topic;
+        createKind(k, qosProfile(argc, argv, topic));
+        kind.enabled = enabled[k];
+
+        kind.metrics = new WriterMetrics(topic);
+        kind.summary = summaryWindow > 0 ?
+            new EdgeSummary(qos.provider(argc, argv, "summary"), topic, summaryWindow) : NULL;
+        kind.writeFailed = string("SensorDataWriter::write ") + topic;
+    });
+
+    if (summaryWindow > 0) {
+        rawEnabled = !hasOption(argc, argv, "--summary-only");
+        cout << "=== [Publisher Fake] Summaries every " << summaryWindow << " ms"
+             << (rawEnabled ? " alongside the raw readings" : " instead of the raw readings") << endl;
+    }
+
+    cout << "=== [Publisher Fake] Ready ..." << endl;
+    return 0;
 }
 
-void TemperaturePublish(EnvironmentalData::Environmental& instance)
+static inline void SensorPublish(KindPublisher &kind)
 {
-  result = myWriterTemperature->write(instance, DDS::HANDLE_NIL);
-  checkStatus(result, "SensorDataWriter::write temperature");
+  if (kind.summary != NULL) {
+    kind.summary->add(kind.instance);
+  }
+  if (!rawEnabled) {
+    return;
+  }
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  result = kind.typedWriter->write(kind.instance, DDS::HANDLE_NIL);
+  checkStatus(result, kind.writeFailed.c_str());
+  kind.metrics->record(start);
 }
 
-void RainPublish(EnvironmentalData::Environmental& instance)
+/**
+ * Exposes the number of readers matched with the writer of sensor kind k.
+ **/
+static void registerWriterMetrics(int k)
 {
-  result = myWriterRain->write(instance, DDS::HANDLE_NIL);
-  checkStatus(result, "SensorDataWriter::write rain");
+    metrics().gaugeFunction("stack_writer_matched_readers", "Readers currently matched with the writer.",
+        metricsLabel("topic", SENSOR_KINDS[k].topic), [k]() {
+            lock_guard<mutex> lock(writersLock);
+            DDS::PublicationMatchedStatus status = DDS::PublicationMatchedStatus();
+            kinds[k].writer->get_publication_matched_status(status);
+            return (double)status.current_count;
+        });
 }
 
 void PublisherKill()
 {
   // Delete all entities before termination (good practice to cleanup resources)
-    result = publisherHumidity->delete_datawriter(writerHumidity);
-    checkStatus(result, "delete_datawriter() humidity failed");
-    result = publisherTemperature->delete_datawriter(writerTemperature);
-    checkStatus(result, "delete_datawriter() temperature failed");
-    result = publisherRain->delete_datawriter(writerRain);
-    checkStatus(result, "delete_datawriter() rain failed");
-
-    result = participant->delete_publisher(publisherHumidity);
-    checkStatus(result, "delete_publisher() failed");
-    result = participant->delete_publisher(publisherTemperature);
-    checkStatus(result, "delete_publisher() failed");
-    result = participant->delete_publisher(publisherRain);
-    checkStatus(result, "delete_publisher() failed");
+    SensorKinds<>::forEach([](int k) {
+        KindPublisher &kind = kinds[k];
+        delete kind.summary;
+        delete kind.metrics;
+        delete kind.sampler;
 
-    result = participant->delete_topic(topicHumidity);
-    checkStatus(result, "delete_topic() humidity failed");
-    result = participant->delete_topic(topicTemperature);
-    checkStatus(result, "delete_topic() temperature failed");
-    result = participant->delete_topic(topicRain);
-    checkStatus(result, "delete_topic() rain failed");
+        lock_guard<mutex> lock(writersLock);
+        deleteKind(k);
+    });
 
     result = factory->delete_participant(participant);
     checkStatus(result, "delete_participant() failed");
@@ -324,6 +514,277 @@ float get_rain(){
     return (float)val(rng);
 }
 
+/* Fake reading of every sensor kind, in SensorKindId order. */
+static float (*const fakeValue[SENSOR_KIND_COUNT])() = { get_humi, get_temp, get_rain };
+
+/* The sensor board, with --serial <device> at --serial-baud (see
+ * SerialFrame.h), and the --calibration file. */
+    string                            serialDevice;
+    long                              serialBaud = 0;
+    int                               serialFd = -1;
+    bool                              serialTty = false;
+    SerialFrameParser                 serialParser;
+    vector<SerialReading>             serialReadings;
+    Calibration                       calibration;
+    vector<uint16_t>                  serialCounts;
+    vector<float>                     serialValues;     /* by kind, then frame */
+    string                            calibrationFile;
+
+static bool serialSpeed(long baud, speed_t &speed)
+{
+    static const struct { long baud; speed_t speed; } speeds[] = {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+        { 115200, B115200 }, { 230400, B230400 }
+    };
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        if (speeds[i].baud == baud) {
+            speed = speeds[i].speed;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void registerSerialMetrics()
+{
+    static bool registered = false;
+    if (registered) {
+        return;
+    }
+    registered = true;
+    metrics().counterFunction("stack_serial_frames_total", "Valid frames read from the board.", "",
+        []() { return (double)serialParser.frameCount(); });
+    metrics().counterFunction("stack_serial_crc_errors_total", "Frames dropped for a bad CRC.", "",
+        []() { return (double)serialParser.crcErrors(); });
+    metrics().counterFunction("stack_serial_framing_errors_total", "Frames dropped for a missing ETX.", "",
+        []() { return (double)serialParser.framingErrors(); });
+    metrics().counterFunction("stack_serial_skipped_bytes_total", "Bytes skipped to find a frame.", "",
+        []() { return (double)serialParser.skippedBytes(); });
+}
+
+/**
+ * Opens the board at baud in place of the one open, if any. A device
+ * that is not a terminal, such as a recorded byte stream, is only read.
+ * False with a message in error when it cannot be opened; the board open
+ * is kept then.
+ **/
+static bool openSerial(const string &device, long baud, string &error)
+{
+    speed_t speed;
+    if (!serialSpeed(baud, speed)) {
+        error = "unsupported baud rate " + to_string(baud);
+        return false;
+    }
+    int fd = open(device.c_str(), O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fd = open(device.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        error = "cannot open " + device + ": " + strerror(errno);
+        return false;
+    }
+    struct termios tty;
+    bool isTty = tcgetattr(fd, &tty) == 0;
+    if (isTty) {
+        cfmakeraw(&tty);
+        cfsetispeed(&tty, speed);
+        cfsetospeed(&tty, speed);
+        tty.c_cc[VMIN] = 0;
+        tty.c_cc[VTIME] = 5;            /* a read gives up after 0.5 s */
+        tcsetattr(fd, TCSANOW, &tty);
+    }
+
+    if (serialFd >= 0) {
+        close(serialFd);
+    }
+    serialFd = fd;
+    serialTty = isTty;
+    serialDevice = device;
+    serialBaud = baud;
+    serialParser.reset();
+    registerSerialMetrics();
+    return true;
+}
+
+static void closeSerial()
+{
+    if (serialFd >= 0) {
+        close(serialFd);
+    }
+    serialFd = -1;
+    serialDevice.clear();
+    serialParser.reset();
+}
+
+/**
+ * Asks the board for a reply and reads until a valid frame came, taking
+ * every frame already waiting along with it (a replayed stream, or
+ * replies queued while a round was published). The counts of those
+ * frames are calibrated per kind in one batch into serialValues, where
+ * frame i of count has kind k at k * count + i. Returns the frames read,
+ * 0 when none came before a read timed out or the stream ended.
+ **/
+static size_t readSerial()
+{
+    if (serialTty && write(serialFd, SERIAL_REQUEST, SERIAL_REQUEST_BYTES) != SERIAL_REQUEST_BYTES) {
+        cerr << "Error in --serial: write failed: " << strerror(errno) << endl;
+        exit(1);
+    }
+    uint8_t buffer[SERIAL_READ_FRAMES * SERIAL_FRAME_BYTES];
+    serialReadings.clear();
+    while (serialReadings.empty()) {
+        ssize_t n = read(serialFd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            serialParser.reset();
+            return 0;
+        }
+        serialParser.feed(buffer, (size_t)n, serialReadings);
+    }
+    size_t count = serialReadings.size();
+    serialCounts.resize(count);
+    serialValues.resize(count * SENSOR_KIND_COUNT);
+    SensorKinds<>::forEach([count](int k) {
+        for (size_t i = 0; i < count; i++) {
+            serialCounts[i] = serialReadings[i].raw(k);
+        }
+        calibration.apply(k, serialCounts.data(), &serialValues[k * count], count);
+    });
+    return count;
+}
+
+static bool contains(const vector<string> &files, const string &file)
+{
+    return find(files.begin(), files.end(), file) != files.end();
+}
+
+/**
+ * Watches the --config file and the QoS and calibration files in use.
+ **/
+static bool watchFiles(string &error)
+{
+    return watcher.watch(configFile, error) && watcher.watch(qosFile, error) &&
+        (calibrationFile.empty() || watcher.watch(calibrationFile, error));
+}
+
+/**
+ * Whether profile names a profile the QoS file of catalogue defines.
+ **/
+static bool qosReadable(QosCatalogue &catalogue, const char *profile)
+{
+    DDS::DataWriterQos wQos;
+    return QosCatalogue::isProfile(profile) &&
+        catalogue.provider(profile).get_datawriter_qos(wQos, NULL) == DDS::RETCODE_OK;
+}
+
+/**
+ * Applies the changes of the --config file and of the QoS and calibration
+ * files it names, between two rounds of readings. Only the kinds whose
+ * QoS changed get new entities, the others keep publishing on theirs;
+ * a new QoS file counts as a change of every kind, and is only taken
+ * when every profile in use loads from it. A bad value is reported and
+ * the previous one kept.
+ **/
+static void reloadConfig(const vector<string> &changed)
+{
+    string error;
+    if (contains(changed, configFile)) {
+        OptionSet loaded;
+        if (!loaded.load(commandArgc, commandArgv, configFile, 2, error)) {
+            cerr << "Error in --config: " << error << ", keeping the previous options" << endl;
+            return;
+        }
+        options.swap(loaded);
+    }
+    int argc = options.argc();
+    char **argv = options.argv();
+
+    /* A new QoS file is checked in a catalogue of its own first, so a
+     * broken one leaves the catalogue and every writer as they were. */
+    string file = getOption(argc, argv, "--qos-file", QOS_DEFAULT_FILE);
+    bool qosChanged = file != qosFile || contains(changed, qosFile);
+    QosCatalogue loaded(("file://" + file).c_str());
+    QosCatalogue &catalogue = qosChanged ? loaded : qos;
+    bool reload[SENSOR_KIND_COUNT];
+    bool qosValid = true;
+    SensorKinds<>::forEach([&](int k) {
+        KindPublisher &kind = kinds[k];
+        const char *topic = SENSOR_KINDS[k].topic;
+        const char *profile = qosProfile(argc, argv, topic);
+        reload[k] = qosChanged || kind.profile != profile;
+        if (reload[k] && !qosReadable(catalogue, profile)) {
+            cerr << "Error in --config: cannot load QoS profile " << profile << " from " << file
+                 << " for " << topic << ", keeping " << kind.profile << endl;
+            reload[k] = false;
+            qosValid = false;
+        }
+    });
+    if (qosChanged && !qosValid) {
+        cerr << "Error in --qos-file: keeping " << qosFile << endl;
+        fill(reload, reload + SENSOR_KIND_COUNT, false);
+        if (!watcher.watch(file, error)) {
+            cerr << "Error in --config: " << error << endl;
+        }
+    } else if (qosChanged) {
+        qos.swap(loaded);
+        qosFile = file;
+    }
+    SensorKinds<>::forEach([&](int k) {
+        if (!reload[k]) {
+            return;
+        }
+        const char *topic = SENSOR_KINDS[k].topic;
+        const char *profile = qosProfile(argc, argv, topic);
+        lock_guard<mutex> lock(writersLock);
+        deleteKind(k);
+        createKind(k, profile);
+        cout << "=== [Publisher Fake] Reloaded " << topic << " with QoS profile " << profile << endl;
+    });
+
+    bool enabled[SENSOR_KIND_COUNT];
+    if (!parseSensors(getOption(argc, argv, "--sensors", "all"), enabled, error)) {
+        cerr << "Error in --sensors: " << error << ", keeping the previous sensors" << endl;
+    } else {
+        SensorKinds<>::forEach([&enabled](int k) {
+            KindPublisher &kind = kinds[k];
+            if (kind.enabled != enabled[k]) {
+                kind.enabled = enabled[k];
+                kind.next_us = 0;
+                cout << "=== [Publisher Fake] " << (enabled[k] ? "Enabled " : "Disabled ")
+                     << SENSOR_KINDS[k].topic << endl;
+            }
+        });
+    }
+
+    const char *device = getOption(argc, argv, "--serial", NULL);
+    long baud = getIntOption(argc, argv, "--serial-baud", SERIAL_BAUD);
+    if (device == NULL && serialFd >= 0) {
+        closeSerial();
+        cout << "=== [Publisher Fake] Publishing fake values" << endl;
+    } else if (device != NULL && (device != serialDevice || baud != serialBaud)) {
+        if (!openSerial(device, baud, error)) {
+            cerr << "Error in --serial: " << error << ", keeping the previous port" << endl;
+        } else {
+            cout << "=== [Publisher Fake] Reading the sensor board on " << device << " at " << baud << endl;
+        }
+    }
+
+    string path = getOption(argc, argv, "--calibration", "");
+    if (path != calibrationFile || (!path.empty() && contains(changed, path))) {
+        Calibration loaded;
+        if (!path.empty() && !loaded.load(path.c_str(), error)) {
+            cerr << "Error in --calibration: " << error << ", keeping the previous calibration" << endl;
+        } else {
+            calibration = loaded;
+            calibrationFile = path;
+            cout << "=== [Publisher Fake] Reloaded the calibration" << endl;
+        }
+    }
+
+    if (!watchFiles(error)) {
+        cerr << "Error in --config: " << error << endl;
+    }
+}
+
 /* Main wrapper to allow embedded usage of the Publisher application. */
 int OSPL_MAIN (int argc, char *argv[])
 {
@@ -337,41 +798,146 @@ int OSPL_MAIN (int argc, char *argv[])
         return 1;
     }
 
-   os_time delay_100ms = { 0, 100000000 }; //100ms
+   /* --config <file> reads "name value" option lines from file ahead of
+    * the command line (see CommandLine.h) and applies changes to it, to
+    * the QoS file and to the calibration file while running: --qos-file,
+    * --qos-profile, --qos-<topic>, --sensors, --serial, --serial-baud and
+    * --calibration (see reloadConfig()). */
+   commandArgc = argc;
+   commandArgv = argv;
+   configFile = getOption(argc, argv, "--config", NULL);
+   string configError;
+   if (!options.load(argc, argv, configFile, 2, configError)) {
+       cerr << "Error in --config: " << configError << endl;
+       exit(1);
+   }
+   argc = options.argc();
+   argv = options.argv();
+
+   /* --period-us <us> sets the time between two rounds of readings
+    * (default 100 ms); 0 publishes as fast as the writers allow. */
+   long period = getIntOption(argc, argv, "--period-us", 100000);
+   os_time delay;
+   delay.tv_sec = period / 1000000;
+   delay.tv_nsec = period % 1000000 * 1000;
+
+   /* --adaptive reads and publishes each sensor at its own rate: every
+    * --period-us while its signal changes faster than --adaptive-rate per
+    * second or spreads more than --adaptive-sigma, backing off to every
+    * --adaptive-slow-us while it is steady (see AdaptiveSampler.h). */
+   bool adaptive = hasOption(argc, argv, "--adaptive");
+   AdaptiveConfig adaptiveConfig;
+   adaptiveConfig.fast_us = period;
+   adaptiveConfig.slow_us = getIntOption(argc, argv, "--adaptive-slow-us", 10000000);
+   adaptiveConfig.rate_limit = atof(getOption(argc, argv, "--adaptive-rate", "0.5"));
+   adaptiveConfig.sigma_limit = atof(getOption(argc, argv, "--adaptive-sigma", "1"));
+   adaptiveConfig.backoff = atof(getOption(argc, argv, "--adaptive-backoff", "2"));
+   if (adaptive && (period <= 0 || adaptiveConfig.slow_us < period || adaptiveConfig.backoff <= 1.0f)) {
+       cerr << "Error in --adaptive: --period-us must be above 0, --adaptive-slow-us at least "
+            << "--period-us and --adaptive-backoff above 1" << endl;
+       exit(1);
+   }
 
    EnvironmentalDataPublisher(argc, argv);
 
-    std::string humi_id = create_id(MACHINE_ID, NODE_ID, 0, (char*)"hum");
-    std::string temp_id = create_id(MACHINE_ID, NODE_ID, 1, (char*)"tem");
-    std::string rain_id = create_id(MACHINE_ID, NODE_ID, 2, (char*)"rai");
-
-    EnvironmentalData::Environmental humi_instance;
-    humi_instance.id = DDS::String_mgr(humi_id.c_str());
-    humi_instance.type = DDS::String_mgr("humidity sensor");
-
-    EnvironmentalData::Environmental temp_instance;
-    temp_instance.id = DDS::String_mgr(temp_id.c_str());
-    temp_instance.type = DDS::String_mgr("temperature sensor");
-
-    EnvironmentalData::Environmental rain_instance;
-    rain_instance.id = DDS::String_mgr(rain_id.c_str());
-    rain_instance.type = DDS::String_mgr("rain sensor");
-
+   SensorKinds<>::forEach([&](int k) {
+       KindPublisher &kind = kinds[k];
+       const char *topic = SENSOR_KINDS[k].topic;
+       registerWriterMetrics(k);
+       kind.sampler = adaptive ? new AdaptiveSampler(adaptiveConfig) : NULL;
+       kind.next_us = 0;
+       kind.period = &metrics().gauge("stack_sample_period_seconds", "Time between two readings of the sensor.",
+           metricsLabel("topic", topic));
+       kind.period->set(period / 1e6);
+       if (adaptive) {
+           AdaptiveSampler *sampler = kind.sampler;
+           metrics().counterFunction("stack_sample_rate_changes_total",
+               "Switches of the sensor between the fast and the slow rate.", metricsLabel("topic", topic),
+               [sampler]() { return (double)sampler->changeCount(); });
+       }
+   });
+   /* --serial <device> publishes the readings of the sensor board on the
+    * serial port (e.g. /dev/ttyS1) at --serial-baud (default 115200)
+    * instead of fake values, converted with the --calibration file (see
+    * Calibration.h); a round publishes every frame read, and nothing
+    * without a valid reply. */
+   const char *device = getOption(argc, argv, "--serial", NULL);
+   calibrationFile = getOption(argc, argv, "--calibration", "");
+   if (!calibrationFile.empty() && !calibration.load(calibrationFile.c_str(), configError)) {
+       cerr << "Error in --calibration: " << configError << endl;
+       exit(1);
+   }
+   if (device != NULL) {
+       if (!openSerial(device, getIntOption(argc, argv, "--serial-baud", SERIAL_BAUD), configError)) {
+           cerr << "Error in --serial: " << configError << endl;
+           exit(1);
+       }
+       cout << "=== [Publisher Fake] Reading the sensor board on " << device << " at " << serialBaud << endl;
+   }
+   if (configFile != NULL) {
+       if (!watchFiles(configError)) {
+           cerr << "Error in --config: " << configError << endl;
+           exit(1);
+       }
+       cout << "=== [Publisher Fake] Reloading on changes to " << configFile << endl;
+   }
+   if (adaptive) {
+       cout << "=== [Publisher Fake] Adaptive sampling between " << period << " and "
+            << adaptiveConfig.slow_us << " us" << endl;
+   }
+
+   /* --metrics-port <port> serves Prometheus metrics on 127.0.0.1,
+    * --metrics-file <path> rewrites them every --metrics-interval ms. */
+   metricsExporter.start(getIntOption(argc, argv, "--metrics-port", 0),
+       getOption(argc, argv, "--metrics-file", NULL), getIntOption(argc, argv, "--metrics-interval", 10000));
+
+    /* Sensor k of the node is of kind k. */
+    SensorKinds<>::forEach([&](int k) {
+        std::string id = create_id(MACHINE_ID, NODE_ID, k, (char*)SENSOR_KINDS[k].suffix);
+        kinds[k].instance.id = DDS::String_mgr(id.c_str());
+        kinds[k].instance.type = DDS::String_mgr(SENSOR_KINDS[k].type);
+    });
+
+    vector<string> changedFiles;
     for(;;){
 
-        humi_instance.value = get_humi();
-        HumidityPublish(humi_instance); 
-
-        temp_instance.value = get_temp();
-        TemperaturePublish(temp_instance); 
-
-        rain_instance.value = get_rain();
-        RainPublish(rain_instance); 
+        if (configFile != NULL && watcher.poll(changedFiles)) {
+            reloadConfig(changedFiles);
+        }
+
+        /* Every frame read from the board is published, in order; the
+         * fake values are one reading per round. */
+        size_t frames = serialFd >= 0 ? readSerial() : 1;
+        int64_t now = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+        for (size_t i = 0; i < frames; i++) {
+            SensorKinds<>::forEach([now, i, frames](int k) {
+                KindPublisher &kind = kinds[k];
+                if (!kind.enabled || now < kind.next_us) {
+                    return;
+                }
+                kind.instance.value = serialFd >= 0 ? serialValues[k * frames + i] : fakeValue[k]();
+                SensorPublish(kind);
+                if (kind.sampler != NULL) {
+                    int64_t next = kind.sampler->update(now, kind.instance.value);
+                    kind.period->set(next / 1e6);
+                    kind.next_us = now + next;
+                }
+            });
+        }
+        SensorKinds<>::forEach([](int k) {
+            if (kinds[k].summary != NULL) {
+                kinds[k].summary->flushDue(EdgeSummary::currentTime());
+            }
+        });
 
         //NDDSUtility::sleep(send_period);
-        os_nanoSleep(delay_100ms);
+        if (period > 0) {
+            os_nanoSleep(delay);
+        }
     }
 
+    metricsExporter.stop();
     PublisherKill();
 
     return 0;
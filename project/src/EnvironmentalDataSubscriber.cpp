@@ -40,10 +40,27 @@
  *
  ***/
 #include <iostream>
+#include <signal.h>
+#include <stdlib.h>
+#include <chrono>
 #include "ccpp_dds_dcps.h"        /* Include the DDS::DCPS API */
 #include "ccpp_EnvironmentalData.h"  /* Include the generated type specific (EnvironmentalData) DCPS API */
 #include "example_main.h"         /* Include to define the application main() wrapper OSPL_MAIN. */
 #include "QosProvider.h"
+#include "QosCatalogue.h"
+#include "CommandLine.h"
+#include "DDSTransport.h"
+#include "SensorPipeline.h"
+#include "SensorSchema.h"
+#include "MemoryBudget.h"
+#include "SensorTableWriter.h"
+#include "SeriesStore.h"
+#include "QueryServer.h"
+#include "OutputSink.h"
+#include "AnomalyDetector.h"
+#include "LivenessTracker.h"
+#include "Checkpoint.h"
+#include "Metrics.h"
 using namespace std;
 
 /**
@@ -58,6 +75,9 @@ static void checkStatus(DDS::ReturnCode_t status, const char *info);
  **/
 static void checkHandle(void *handle, string info);
 
+void createAlertWriter(DDS::QosProvider &qp);
+void createLivenessWriter(DDS::QosProvider &qp);
+
 /* entry point exported and demangled so symbol can be found in shared library */
 extern "C"
 {
@@ -70,19 +90,157 @@ extern "C"
     DDS::DomainId_t                   domain;
     DDS::DomainParticipant_var        participant;
 
-    DDS::Topic_var                    topicHumidity;
-
-    DDS::Subscriber_var               subscriberHumidity;
+    /* Readings are taken through the transport interface. */
+    DDSTransport                      *transport = NULL;
+/* c2 processes the readings of one sensor kind (see SensorSchema.h). */
+    const char                        *humidityTopic = SENSOR_KINDS[SENSOR_HUMIDITY].topic;
+    DDSTransportReader                *readerHumidity = NULL;
+    vector<TransportSample>           samplesHumidity;
 
-    DDS::DataReader_var               readerHumidity;
-    
-    EnvironmentalData::EnvironmentalDataReader_var  myReaderHumidity;   
-    
-    EnvironmentalData::EnvironmentalSeq msgListHumidity;
-    
-    DDS::SampleInfoSeq infoSeqHumidity;
-    
     DDS::ReturnCode_t result;
+
+    /* Alert topic, created when --anomaly is given. */
+    bool                              alertsEnabled = false;
+    DDS::Topic_var                    topicAlert;
+    DDS::Publisher_var                publisherAlert;
+    DDS::DataWriter_var               writerAlert;
+    EnvironmentalData::SensorAlertDataWriter_var  myWriterAlert;
+
+    /* Liveness topic, created when --liveness-timeout is given. */
+    bool                              livenessEnabled = false;
+    DDS::Topic_var                    topicLiveness;
+    DDS::Publisher_var                publisherLiveness;
+    DDS::DataWriter_var               writerLiveness;
+    EnvironmentalData::SensorLivenessDataWriter_var  myWriterLiveness;
+
+    SeriesStore store;
+    QueryServer queryServer(store);
+    OutputSink sink;
+    AnomalyDetector detector;
+    LivenessTracker tracker;
+    SensorTableWriter table;
+    SensorRegistry registry;
+    MemoryBudget budget;
+    CheckpointFile checkpoint;
+    MetricsExporter metricsExporter(metrics());
+
+/* Cleared by SIGINT/SIGTERM so the store is flushed before exiting. */
+static volatile sig_atomic_t running = 1;
+
+static void stopRunning(int signum)
+{
+    running = 0;
+}
+
+/**
+ * Local time in milliseconds since the epoch.
+ **/
+static int64_t currentTime()
+{
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+/**
+ * Exposes the DDS status counters of a reader. Reading a status resets
+ * its change counts, which nothing else in c2 uses.
+ **/
+static void registerReaderMetrics(const char *topic, DDS::DataReader_ptr reader)
+{
+    string labels = metricsLabel("topic", topic);
+    metrics().counterFunction("stack_reader_samples_lost_total",
+        "Samples lost before reaching the reader.", labels, [reader]() {
+            DDS::SampleLostStatus status = DDS::SampleLostStatus();
+            reader->get_sample_lost_status(status);
+            return (double)status.total_count;
+        });
+    metrics().counterFunction("stack_reader_samples_rejected_total",
+        "Samples rejected by the reader for lack of resources.", labels, [reader]() {
+            DDS::SampleRejectedStatus status = DDS::SampleRejectedStatus();
+            reader->get_sample_rejected_status(status);
+            return (double)status.total_count;
+        });
+    metrics().counterFunction("stack_reader_deadline_missed_total",
+        "Requested deadlines missed by the reader.", labels, [reader]() {
+            DDS::RequestedDeadlineMissedStatus status = DDS::RequestedDeadlineMissedStatus();
+            reader->get_requested_deadline_missed_status(status);
+            return (double)status.total_count;
+        });
+    metrics().gaugeFunction("stack_reader_matched_writers",
+        "Writers currently matched with the reader.", labels, [reader]() {
+            DDS::SubscriptionMatchedStatus status = DDS::SubscriptionMatchedStatus();
+            reader->get_subscription_matched_status(status);
+            return (double)status.current_count;
+        });
+    metrics().gaugeFunction("stack_reader_alive_writers",
+        "Matched writers that are alive.", labels, [reader]() {
+            DDS::LivelinessChangedStatus status = DDS::LivelinessChangedStatus();
+            reader->get_liveliness_changed_status(status);
+            return (double)status.alive_count;
+        });
+}
+
+/**
+ * Hands a snapshot of the sensor state to the --checkpoint writer. It is
+ * taken between two takes, so its parts agree. False when skipped while
+ * the last one is still being written, unless wait is set.
+ **/
+static bool saveCheckpoint(int64_t now, bool wait)
+{
+    CheckpointWriter *out = checkpoint.begin(wait);
+    if (out == NULL) {
+        return false;
+    }
+    out->begin("registry");
+    registry.save(*out);
+    out->end();
+    if (alertsEnabled) {
+        out->begin("detector");
+        detector.save(*out);
+        out->end();
+    }
+    if (livenessEnabled) {
+        out->begin("liveness");
+        tracker.save(*out);
+        out->end();
+    }
+    if (table.isOpen()) {
+        out->begin("table");
+        table.save(*out);
+        out->end();
+    }
+    checkpoint.commit(now);
+    return true;
+}
+
+/**
+ * Restores the sensor state saved in path, when there is a valid
+ * checkpoint there. A part that does not restore starts cold.
+ **/
+static void restoreCheckpoint(const char *path, int64_t now)
+{
+    CheckpointImage image;
+    CheckpointReader in;
+    string error;
+    if (!image.open(path, error)) {
+        cout << "=== [Subscriber] Starting cold, no checkpoint: " << error << endl;
+        return;
+    }
+    if (!image.section("registry", in) || !registry.restore(in)) {
+        cerr << "Error in --checkpoint: bad sensor section in " << path << ", starting cold" << endl;
+        return;
+    }
+    if (alertsEnabled && image.section("detector", in) && !detector.restore(in, registry.size())) {
+        cerr << "Error in --checkpoint: bad detector section in " << path << endl;
+    }
+    if (livenessEnabled && image.section("liveness", in) && !tracker.restore(in, registry.size(), now)) {
+        cerr << "Error in --checkpoint: bad liveness section in " << path << endl;
+    }
+    if (table.isOpen() && image.section("table", in) && !table.restore(in, registry)) {
+        cerr << "Error in --checkpoint: bad table section in " << path << endl;
+    }
+    cout << "=== [Subscriber] Restored " << registry.size() << " sensors from " << path << ", saved "
+         << (now - image.created()) / 1000 << " s ago" << endl;
+}
+
 /*
  * The main function of the Subscriber application
  */
@@ -91,11 +249,9 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     /* The DDS entities required to publish data */
 
     //=======Load Qos Policy file======
-    DDS::QosProvider qp("file://DDS_DefaultQoS.xml", "DefaultQosProfile");
-
-    /* The Application EnvironmentalData Data TypeSupport */
-    EnvironmentalData::EnvironmentalTypeSupport_var typesupport;
-    DDS::String_var typeName;
+    /* --qos-profile <name> selects the profile of every topic and
+     * --qos-<topic> <name> the profile of one topic (see QosCatalogue.h). */
+    QosCatalogue qos;
 
   // Get the DDS DomainParticipantFactory
     factory = DDS::DomainParticipantFactory::get_instance();
@@ -106,107 +262,133 @@ int EnvironmentalDataSubscriber(int argc, char *argv[])
     participant = factory->create_participant(domain, PARTICIPANT_QOS_DEFAULT, NULL, DDS::STATUS_MASK_NONE);
     checkHandle(participant, "create_participant() failed");
 
-  // Register the application data type
-    typesupport = new EnvironmentalData::EnvironmentalTypeSupport();
-    /* Get the IDL type name and use this to register the type. */
-    typeName = typesupport->get_type_name();
-    result = typesupport->register_type(participant, typeName);
-    checkStatus(result, "register_type() failed");
+  // Create the humidity reader on the participant; with --shards <n> it
+  // only reads the shards of --shard-set (see Sharding.h)
+    transport = new DDSTransport(participant, argc, argv);
 
-  // Create Topic entity
-    /* Create and initialize topic qos value on heap. */
-    DDS::TopicQos tQos;
-    //result = participant->get_default_topic_qos(tQos);
-    result = qp.get_topic_qos(tQos, NULL);
-    checkStatus(result, "get_default_topic_qos() failed");
+    /* --memory-budget-mb <mb> bounds what c2 holds (see MemoryBudget.h);
+     * the reader gets its share as resource limits and purges the samples
+     * of gone writers after --autopurge-ms. */
+    budget.configure(getIntOption(argc, argv, "--memory-budget-mb", 0) * 1024 * 1024);
+    if (budget.limited()) {
+        transport->setReaderLimits(budget.readerSamples(1), getIntOption(argc, argv, "--autopurge-ms", 5000));
+    }
+    readerHumidity = transport->createReader(humidityTopic);
+
+    if (hasOption(argc, argv, "--anomaly")) {
+        createAlertWriter(qos.provider(argc, argv, "alert"));
+    }
+    if (getIntOption(argc, argv, "--liveness-timeout", 0) > 0) {
+        createLivenessWriter(qos.provider(argc, argv, "liveness"));
+    }
 
-    /* Fine tune topic qos, i.e. make topic reliable and transient (for late joining subscribers) */
-    //tQos.reliability.kind = DDS::RELIABLE_RELIABILITY_QOS;
-    //tQos.durability.kind = DDS::TRANSIENT_DURABILITY_QOS;
-    /* Use the changed policy when defining the EnvironmentalData topic */
-    topicHumidity = participant->create_topic("humidity", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(topicHumidity, "create_topic() humidity failed");
-    
-  // Create Subscriber entity
-    /* Create on heap and initialize subscriber qos value with the default value. */
-    DDS::SubscriberQos sQos;
-    //result = participant->get_default_subscriber_qos(sQos);
-    result = qp.get_subscriber_qos(sQos, NULL);
-    checkStatus(result, "get_default_subscriber_qos() failed");
-
-    /* Fine tune the partition qos policy ito the partition from which the data will be received. */
-    //sQos.partition.name.length(1);
-    //sQos.partition.name[0] = "EnvironmentalData Partition";
-    /* Create the subscriber. */
-    subscriberHumidity = participant->create_subscriber(sQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(subscriberHumidity, "create_subscriber() humidity failed");
-    
-  // create DataReader entity
-    DDS::DataReaderQos rQos;
-    //result = subscriber->get_default_datareader_qos(rQos);
-    result = qp.get_datareader_qos(rQos, NULL);
-    checkStatus(result, "get_default_datareader_qos() failed");
-
-    readerHumidity = subscriberHumidity->create_datareader(topicHumidity, rQos, NULL, DDS::STATUS_MASK_NONE);
-    checkHandle(readerHumidity, "create_datareader() humidity failed");
-    
-    /* Cast reader to 'HelloWorld' type specific interface. */
-    myReaderHumidity = EnvironmentalData::EnvironmentalDataReader::_narrow(readerHumidity);
-    checkHandle(myReaderHumidity, "EnvironmentalDataReader::_narrow() humidity failed");
-    
     cout << "=== [Subscriber] Ready ..." << endl;
     return 0;
 }
 
-void Subscriberkill()
+/**
+ * Creates the writer for the "alert" topic the anomaly detector reports on.
+ **/
+void createAlertWriter(DDS::QosProvider &qp)
 {
-  // Delete all entities before termination (good practice to cleanup resources)
-    result = subscriberHumidity->delete_datareader(readerHumidity);
-    checkStatus(result, "delete_datareader() humidity failed");
-    
-    result = participant->delete_subscriber(subscriberHumidity);
-    checkStatus(result, "delete_publisher() humidity failed");
-    
-    result = participant->delete_topic(topicHumidity);
-    checkStatus(result, "delete_topic() humidity failed");
-    
-    result = factory->delete_participant(participant);
-    checkStatus(result, "delete_participant() failed");
+    EnvironmentalData::SensorAlertTypeSupport_var typesupport = new EnvironmentalData::SensorAlertTypeSupport();
+    DDS::String_var typeName = typesupport->get_type_name();
+    result = typesupport->register_type(participant, typeName);
+    checkStatus(result, "register_type() alert failed");
+
+    DDS::TopicQos tQos;
+    result = qp.get_topic_qos(tQos, NULL);
+    checkStatus(result, "get_default_topic_qos() failed");
+    topicAlert = participant->create_topic("alert", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(topicAlert, "create_topic() alert failed");
+
+    DDS::PublisherQos pQos;
+    result = qp.get_publisher_qos(pQos, NULL);
+    checkStatus(result, "get_default_publisher_qos() failed");
+    publisherAlert = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(publisherAlert, "create_publisher() alert failed");
+
+    DDS::DataWriterQos wQos;
+    result = qp.get_datawriter_qos(wQos, NULL);
+    checkStatus(result, "get_default_datawriter_qos() failed");
+    writerAlert = publisherAlert->create_datawriter(topicAlert, wQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(writerAlert, "create_datawriter() alert failed");
+
+    myWriterAlert = EnvironmentalData::SensorAlertDataWriter::_narrow(writerAlert);
+    checkHandle(myWriterAlert, "SensorAlertDataWriter::_narrow() alert failed");
+    alertsEnabled = true;
 }
 
-bool HumidityRead()
+/**
+ * Creates the writer for the "liveness" topic the liveness tracker reports on.
+ **/
+void createLivenessWriter(DDS::QosProvider &qp)
 {
-  EnvironmentalData::EnvironmentalSeq msgList;
-  DDS::SampleInfoSeq infoSeq;
-
-  result = myReaderHumidity->take(msgList, infoSeq, DDS::LENGTH_UNLIMITED,
-    DDS::ANY_SAMPLE_STATE, DDS::ANY_VIEW_STATE, DDS::ANY_INSTANCE_STATE);
-  checkStatus(result, "EnvironmentalDataReader::take humidity");
-  
-  msgListHumidity = msgList;
-  infoSeqHumidity = infoSeq;
-
-  result = myReaderHumidity->return_loan(msgList, infoSeq);
-  checkStatus(result, "EnvironmentalDataReader::return_loan humidity");
-
-   if(msgListHumidity.length() > 0)
-   {
-      return true;
-   }else
-   {
-      return false;
-   }
+    EnvironmentalData::SensorLivenessTypeSupport_var typesupport = new EnvironmentalData::SensorLivenessTypeSupport();
+    DDS::String_var typeName = typesupport->get_type_name();
+    result = typesupport->register_type(participant, typeName);
+    checkStatus(result, "register_type() liveness failed");
+
+    DDS::TopicQos tQos;
+    result = qp.get_topic_qos(tQos, NULL);
+    checkStatus(result, "get_default_topic_qos() failed");
+    topicLiveness = participant->create_topic("liveness", typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(topicLiveness, "create_topic() liveness failed");
+
+    DDS::PublisherQos pQos;
+    result = qp.get_publisher_qos(pQos, NULL);
+    checkStatus(result, "get_default_publisher_qos() failed");
+    publisherLiveness = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(publisherLiveness, "create_publisher() liveness failed");
+
+    DDS::DataWriterQos wQos;
+    result = qp.get_datawriter_qos(wQos, NULL);
+    checkStatus(result, "get_default_datawriter_qos() failed");
+    writerLiveness = publisherLiveness->create_datawriter(topicLiveness, wQos, NULL, DDS::STATUS_MASK_NONE);
+    checkHandle(writerLiveness, "create_datawriter() liveness failed");
+
+    myWriterLiveness = EnvironmentalData::SensorLivenessDataWriter::_narrow(writerLiveness);
+    checkHandle(myWriterLiveness, "SensorLivenessDataWriter::_narrow() liveness failed");
+    livenessEnabled = true;
 }
 
-EnvironmentalData::EnvironmentalSeq HumidityGetDataSeq()
+void LivenessPublish(EnvironmentalData::SensorLiveness& instance)
 {
-    return msgListHumidity;
+  result = myWriterLiveness->write(instance, DDS::HANDLE_NIL);
+  checkStatus(result, "SensorLivenessDataWriter::write liveness");
 }
 
+void AlertPublish(EnvironmentalData::SensorAlert& instance)
+{
+  result = myWriterAlert->write(instance, DDS::HANDLE_NIL);
+  checkStatus(result, "SensorAlertDataWriter::write alert");
+}
 
-DDS::SampleInfoSeq HumidityGetInfoSeq()
+void Subscriberkill()
 {
-    return infoSeqHumidity;
+  // Delete all entities before termination (good practice to cleanup resources)
+    if (alertsEnabled) {
+        result = publisherAlert->delete_datawriter(writerAlert);
+        checkStatus(result, "delete_datawriter() alert failed");
+        result = participant->delete_publisher(publisherAlert);
+        checkStatus(result, "delete_publisher() alert failed");
+        result = participant->delete_topic(topicAlert);
+        checkStatus(result, "delete_topic() alert failed");
+    }
+    if (livenessEnabled) {
+        result = publisherLiveness->delete_datawriter(writerLiveness);
+        checkStatus(result, "delete_datawriter() liveness failed");
+        result = participant->delete_publisher(publisherLiveness);
+        checkStatus(result, "delete_publisher() liveness failed");
+        result = participant->delete_topic(topicLiveness);
+        checkStatus(result, "delete_topic() liveness failed");
+    }
+
+    delete readerHumidity;
+    delete transport;
+
+    result = factory->delete_participant(participant);
+    checkStatus(result, "delete_participant() failed");
 }
 
 /* End of the Subscriber  example application.
@@ -249,22 +431,185 @@ static void checkHandle(void *handle, string info)
 /* Main wrapper to allow embedded usage of the Subscriber application. */
 int OSPL_MAIN (int argc, char *argv[])
 {
-  os_time delay_100ms = { 0, 100000000 }; //100ms
+  /* --poll-us <us> sets the time between two takes (default 100 ms). */
+  long period = getIntOption(argc, argv, "--poll-us", 100000);
+  os_time delay;
+  delay.tv_sec = period / 1000000;
+  delay.tv_nsec = period % 1000000 * 1000;
   EnvironmentalDataSubscriber (argc, argv);
 
-for(;;){
+  /* --store <directory> keeps every reading in compressed blocks plus
+   * 1s/1m/1h rollups and serves them on --query-socket (default
+   * <directory>/query.sock). --retention-hours drops older raw blocks. */
+  const char *storeDir = getOption(argc, argv, "--store", NULL);
+  if (storeDir != NULL) {
+      store.open(storeDir);
+      store.setRetention(getIntOption(argc, argv, "--retention-hours", 0) * 3600000LL);
+      cout << "=== [Subscriber] Storing readings in " << storeDir << endl;
+      queryServer.start(getOption(argc, argv, "--query-socket",
+          (string(storeDir) + "/query.sock").c_str()));
+  }
+
+  /* --table <name> keeps the latest reading of every sensor in the POSIX
+   * shared memory object <name> (e.g. /stack_sensors) for local readers,
+   * see SensorTable.h; --table-sensors sets its size. */
+  const char *tableName = getOption(argc, argv, "--table", NULL);
+  if (tableName != NULL) {
+      table.open(tableName, getIntOption(argc, argv, "--table-sensors", 4096));
+  }
+
+  /* Readings go to stdout or --sink-file as csv (default), jsonl or binary
+   * records, flushed every --flush-kb kilobytes or --flush-ms milliseconds. */
+  SinkFormat sinkFormat;
+  if (!OutputSink::parseFormat(getOption(argc, argv, "--sink", "csv"), sinkFormat)) {
+      cerr << "Error in --sink: expected csv, jsonl or binary" << endl;
+      exit(1);
+  }
+  sink.open(sinkFormat, getOption(argc, argv, "--sink-file", NULL),
+      getIntOption(argc, argv, "--flush-kb", 64) * 1024, getIntOption(argc, argv, "--flush-ms", 100));
+
+  /* --anomaly runs every reading through the detector and publishes alerts
+   * on the "alert" topic; the --anomaly-* options tune its rules. */
+  if (alertsEnabled) {
+      AnomalyConfig anomaly;
+      anomaly.alpha = atof(getOption(argc, argv, "--anomaly-alpha", "0.05"));
+      anomaly.z_limit = atof(getOption(argc, argv, "--anomaly-z", "4"));
+      anomaly.noise_floor = atof(getOption(argc, argv, "--anomaly-floor", "0.05"));
+      anomaly.rate_limit = atof(getOption(argc, argv, "--anomaly-rate", "0"));
+      anomaly.stuck_samples = getIntOption(argc, argv, "--anomaly-stuck", 600);
+      anomaly.warmup = getIntOption(argc, argv, "--anomaly-warmup", 20);
+      detector.configure(anomaly);
+  }
+
+  /* --liveness-timeout <ms> reports sensors without a reading for that long
+   * as stale, and again when they recover, on the "liveness" topic. */
+  if (livenessEnabled) {
+      tracker.configure(getIntOption(argc, argv, "--liveness-timeout", 0),
+          getIntOption(argc, argv, "--liveness-tick", 100));
+  }
+  vector<LivenessEvent> livenessEvents;
+  EnvironmentalData::SensorLiveness liveness;
+
+  /* --checkpoint <file> restores the sensor numbers, detector and liveness
+   * state and latest readings saved there, and saves them again every
+   * --checkpoint-ms (default 60 s) and on exit (see Checkpoint.h). */
+  const char *checkpointFile = getOption(argc, argv, "--checkpoint", NULL);
+  int64_t checkpointPeriod = getIntOption(argc, argv, "--checkpoint-ms", 60000);
+  int64_t nextCheckpoint = 0;
+  if (checkpointFile != NULL) {
+      int64_t now = currentTime();
+      restoreCheckpoint(checkpointFile, now);
+      checkpoint.open(checkpointFile);
+      nextCheckpoint = now + checkpointPeriod;
+      metrics().counterFunction("stack_checkpoints_written_total", "Checkpoints written.", "",
+          []() { return (double)checkpoint.writeCount(); });
+      metrics().counterFunction("stack_checkpoint_failures_total", "Checkpoints that failed to write.", "",
+          []() { return (double)checkpoint.failureCount(); });
+      metrics().gaugeFunction("stack_checkpoint_bytes", "Size of the last checkpoint written.", "",
+          []() { return (double)checkpoint.lastBytes(); });
+      metrics().gaugeFunction("stack_checkpoint_write_seconds", "Time spent writing the last checkpoint.", "",
+          []() { return checkpoint.lastWriteSeconds(); });
+  }
+
+
+  SensorPipeline pipeline(humidityTopic, registry, &sink, &store, alertsEnabled ? &detector : NULL,
+      livenessEnabled ? &tracker : NULL, &table);
+  Counter &alertsPublished = metrics().counter("stack_alerts_published_total",
+      "Anomaly alerts published.");
+  Gauge &staleSensors = metrics().gauge("stack_sensors_stale",
+      "Sensors currently without readings.");
+  registerReaderMetrics(humidityTopic, readerHumidity->dataReader());
+  metrics().counterFunction("stack_sink_records_total", "Records given to the output sink.", "",
+      []() { return (double)sink.recordCount(); });
+  metrics().counterFunction("stack_sink_bytes_total", "Bytes written by the output sink.", "",
+      []() { return (double)sink.bytes(); });
+  metrics().counterFunction("stack_sink_dropped_bytes_total", "Bytes dropped by the sink queue limit.", "",
+      []() { return (double)sink.droppedBytes(); });
+
+  /* Memory accounting, and with a budget the sink and sensor limits. */
+  budget.track("store", true, []() { return store.memoryUsage(); });
+  budget.track("detector", true, []() { return detector.memoryUsage(); });
+  budget.track("liveness", true, []() { return tracker.memoryUsage(); });
+  budget.track("pipeline", true, [&pipeline]() { return pipeline.memoryUsage(); });
+  budget.track("registry", true, []() { return registry.memoryUsage(); });
+  budget.track("sink", false, []() { return sink.memoryUsage(); });
+  budget.track("checkpoint", false, []() { return checkpoint.memoryUsage(); });
+  if (budget.limited()) {
+      sink.setQueueLimit(budget.bufferBytes());
+      pipeline.setSensorLimit(budget.sensorLimit(0));
+      cout << "=== [Subscriber] Memory budget " << budget.budgetBytes() / (1024 * 1024) << " MB, reader limit "
+           << budget.readerSamples(1) << " samples" << endl;
+  }
+  int64_t nextBudgetUpdate = 0;
+
+  /* --metrics-port <port> serves Prometheus metrics on 127.0.0.1,
+   * --metrics-file <path> rewrites them every --metrics-interval ms. */
+  metricsExporter.start(getIntOption(argc, argv, "--metrics-port", 0),
+      getOption(argc, argv, "--metrics-file", NULL), getIntOption(argc, argv, "--metrics-interval", 10000));
+
+  vector<AnomalyAlert> alerts;
+  EnvironmentalData::SensorAlert alert;
+
+  signal(SIGINT, stopRunning);
+  signal(SIGTERM, stopRunning);
+
+while(running){
+
+        readerHumidity->take(samplesHumidity);
+        int64_t now = currentTime();
+        pipeline.process(samplesHumidity.data(), samplesHumidity.size(), now, alerts, livenessEvents);
+
+        if (!alerts.empty()) {
+            for (size_t i = 0; i < alerts.size(); ++i) {
+                alert.id = DDS::String_mgr(registry.id(alerts[i].sensor).c_str());
+                alert.topic = DDS::String_mgr(humidityTopic);
+                alert.rule = DDS::String_mgr(AnomalyDetector::ruleName(alerts[i].rule));
+                alert.value = alerts[i].value;
+                alert.score = alerts[i].score;
+                alert.timestamp = alerts[i].timestamp;
+                AlertPublish(alert);
+            }
+            alertsPublished.add(alerts.size());
+            alerts.clear();
+        }
 
-        if(HumidityRead()){
-            for (DDS::ULong i = 0; i < HumidityGetDataSeq().length(); ++i) {
-                if (HumidityGetInfoSeq()[i].valid_data) {
-                    float sensor_val = HumidityGetDataSeq()[i].value;
-                    std::cout << "Humi: " << sensor_val << std::endl;
-                }
+        if (livenessEnabled) {
+            pipeline.advance(now, livenessEvents);
+            for (size_t i = 0; i < livenessEvents.size(); ++i) {
+                liveness.id = DDS::String_mgr(registry.id(livenessEvents[i].sensor).c_str());
+                liveness.topic = DDS::String_mgr(humidityTopic);
+                liveness.alive = livenessEvents[i].alive;
+                liveness.last_seen = livenessEvents[i].last_seen;
+                liveness.timestamp = livenessEvents[i].timestamp;
+                LivenessPublish(liveness);
             }
+            livenessEvents.clear();
+            staleSensors.set(tracker.staleCount());
+        }
+
+        if (now >= nextBudgetUpdate) {
+            budget.update();
+            if (budget.limited()) {
+                pipeline.setSensorLimit(budget.sensorLimit(pipeline.sensors()));
+            }
+            nextBudgetUpdate = now + 1000;
+        }
+
+        if (checkpointFile != NULL && now >= nextCheckpoint && saveCheckpoint(now, false)) {
+            nextCheckpoint = now + checkpointPeriod;
         }
         
-         os_nanoSleep(delay_100ms);
+         os_nanoSleep(delay);
+    }
+    if (checkpointFile != NULL) {
+        saveCheckpoint(currentTime(), true);
+        checkpoint.close();
     }
+    metricsExporter.stop();
+    queryServer.stop();
+    store.close();
+    sink.close();
+    table.close();
     Subscriberkill();
 
     return 0;
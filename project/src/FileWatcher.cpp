@@ -0,0 +1,94 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    FileWatcher.cpp
+ * FUNCTION:        Notification of changed configuration files.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the file watcher.
+ *
+ ***/
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <set>
+#include "FileWatcher.h"
+
+#define WATCH_EVENTS  (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+FileWatcher::FileWatcher()
+  : fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+}
+
+/**
+ * Splits path at its last '/' into its directory ("." for none) and name.
+ **/
+static void splitPath(const std::string &path, std::string &directory, std::string &name)
+{
+  size_t slash = path.rfind('/');
+  directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+  name = slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool FileWatcher::watch(const std::string &path, std::string &error)
+{
+  if (fd < 0)
+  {
+    error = std::string("inotify_init1 failed: ") + strerror(errno);
+    return false;
+  }
+  std::string directory, name;
+  splitPath(path, directory, name);
+  int wd = inotify_add_watch(fd, directory.c_str(), WATCH_EVENTS);
+  if (wd < 0)
+  {
+    error = "cannot watch " + directory + ": " + strerror(errno);
+    return false;
+  }
+  directories[wd] = directory;
+  files[directory + "/" + name] = path;
+  return true;
+}
+
+bool FileWatcher::poll(std::vector<std::string> &changed)
+{
+  changed.clear();
+  if (fd < 0)
+  {
+    return false;
+  }
+  std::set<std::string> seen;
+  char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+  {
+    for (char *p = buffer; p < buffer + n; p += sizeof(struct inotify_event) + ((struct inotify_event *)p)->len)
+    {
+      const struct inotify_event *event = (const struct inotify_event *)p;
+      std::map<int, std::string>::const_iterator directory = directories.find(event->wd);
+      if (event->len == 0 || directory == directories.end())
+      {
+        continue;
+      }
+      std::map<std::string, std::string>::const_iterator file =
+        files.find(directory->second + "/" + event->name);
+      if (file != files.end() && seen.insert(file->second).second)
+      {
+        changed.push_back(file->second);
+      }
+    }
+  }
+  return !changed.empty();
+}
@@ -0,0 +1,48 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    FileWatcher.h
+ * FUNCTION:        Notification of changed configuration files.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for watching configuration files with
+ * inotify. The directory of every file is watched rather than the file,
+ * so a file an editor replaces by renaming a new one over it is still
+ * seen. A file counts as changed when it is closed after writing or moved
+ * into place; poll() never blocks, so a main loop can call it between
+ * two rounds of work.
+ *
+ ***/
+
+#ifndef __FILEWATCHER_H__
+  #define __FILEWATCHER_H__
+
+  #include <map>
+  #include <string>
+  #include <vector>
+
+  class FileWatcher
+  {
+      int fd;
+      std::map<int, std::string> directories;     /* by watch descriptor */
+      std::map<std::string, std::string> files;   /* path as given by directory/name */
+    public:
+      FileWatcher();
+      ~FileWatcher();
+
+      /**
+       * Adds path to the files watched. Returns false with a message in
+       * error when its directory cannot be watched.
+       **/
+      bool watch(const std::string &path, std::string &error);
+
+      /**
+       * Sets changed to the files watched that changed since the last
+       * call, each once and as given to watch(). Returns whether there was
+       * any.
+       **/
+      bool poll(std::vector<std::string> &changed);
+  };
+
+#endif
@@ -0,0 +1,273 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    LivenessTracker.cpp
+ * FUNCTION:        Per sensor liveness tracking.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the liveness tracker.
+ *
+ ***/
+
+#include "LivenessTracker.h"
+#include "Checkpoint.h"
+#include "MemoryUsage.h"
+
+#define LIVENESS_NONE 0xffffffffu
+
+/* Tick distance the outermost wheel can hold; later timers are parked at
+ * its end and re-armed when they get there. */
+#define LIVENESS_SPAN ((int64_t)1 << (LIVENESS_LEVELS * LIVENESS_BITS))
+
+enum
+{
+    SENSOR_NEW,
+    SENSOR_ALIVE,
+    SENSOR_STALE
+};
+
+LivenessTracker::LivenessTracker()
+  : tick_ms(100), default_timeout(5000), current_tick(-1), stale_count(0)
+{
+  for (int i = 0; i < LIVENESS_LEVELS * LIVENESS_SLOTS; i++)
+  {
+    heads[i] = LIVENESS_NONE;
+  }
+}
+
+/**
+ * Sets the timeout of sensors added from now on and the wheel resolution.
+ * Timeouts are rounded up to whole ticks.
+ **/
+void LivenessTracker::configure(int64_t timeoutMs, int64_t tickMs)
+{
+  default_timeout = timeoutMs;
+  tick_ms = tickMs > 0 ? tickMs : 1;
+}
+
+void LivenessTracker::reserve(size_t sensors)
+{
+  if (state.size() >= sensors)
+  {
+    return;
+  }
+  next.resize(sensors, LIVENESS_NONE);
+  prev.resize(sensors, LIVENESS_NONE);
+  bucket.resize(sensors, LIVENESS_NONE);
+  expires.resize(sensors, 0);
+  timeout.resize(sensors, default_timeout);
+  last_seen.resize(sensors, 0);
+  state.resize(sensors, SENSOR_NEW);
+}
+
+/**
+ * Overrides the timeout of one sensor; 0 stops tracking it. Applies from
+ * its next reading.
+ **/
+void LivenessTracker::setTimeout(uint32_t sensor, int64_t timeoutMs)
+{
+  reserve((size_t)sensor + 1);
+  timeout[sensor] = timeoutMs;
+}
+
+bool LivenessTracker::isAlive(uint32_t sensor) const
+{
+  return sensor < state.size() && state[sensor] == SENSOR_ALIVE;
+}
+
+/**
+ * Puts a timer in the bucket matching its distance from the current tick.
+ **/
+void LivenessTracker::link(uint32_t sensor)
+{
+  int64_t when = expires[sensor];
+  if (when - current_tick >= LIVENESS_SPAN)
+  {
+    when = current_tick + LIVENESS_SPAN - 1;
+  }
+
+  int64_t delta = when - current_tick;
+  int level = 0;
+  while (level < LIVENESS_LEVELS - 1 && delta >= ((int64_t)1 << ((level + 1) * LIVENESS_BITS)))
+  {
+    level++;
+  }
+
+  uint32_t b = level * LIVENESS_SLOTS + (uint32_t)((when >> (level * LIVENESS_BITS)) & (LIVENESS_SLOTS - 1));
+  next[sensor] = heads[b];
+  prev[sensor] = LIVENESS_NONE;
+  if (heads[b] != LIVENESS_NONE)
+  {
+    prev[heads[b]] = sensor;
+  }
+  heads[b] = sensor;
+  bucket[sensor] = b;
+}
+
+void LivenessTracker::unlink(uint32_t sensor)
+{
+  if (prev[sensor] == LIVENESS_NONE)
+  {
+    heads[bucket[sensor]] = next[sensor];
+  }
+  else
+  {
+    next[prev[sensor]] = next[sensor];
+  }
+  if (next[sensor] != LIVENESS_NONE)
+  {
+    prev[next[sensor]] = prev[sensor];
+  }
+  bucket[sensor] = LIVENESS_NONE;
+}
+
+/**
+ * Moves the timers of the bucket of level that the wheel just reached to
+ * the inner levels.
+ **/
+void LivenessTracker::cascade(int level)
+{
+  uint32_t b = level * LIVENESS_SLOTS +
+    (uint32_t)((current_tick >> (level * LIVENESS_BITS)) & (LIVENESS_SLOTS - 1));
+  uint32_t sensor = heads[b];
+  heads[b] = LIVENESS_NONE;
+  while (sensor != LIVENESS_NONE)
+  {
+    uint32_t following = next[sensor];
+    link(sensor);
+    sensor = following;
+  }
+}
+
+/**
+ * Records a reading of sensor at time now (ms) and re-arms its timer.
+ **/
+void LivenessTracker::touch(uint32_t sensor, int64_t now, std::vector<LivenessEvent> &events)
+{
+  if (current_tick < 0)
+  {
+    current_tick = now / tick_ms;
+  }
+  reserve((size_t)sensor + 1);
+  last_seen[sensor] = now;
+
+  if (state[sensor] == SENSOR_STALE)
+  {
+    LivenessEvent event;
+    event.sensor = sensor;
+    event.alive = true;
+    event.timestamp = now;
+    event.last_seen = now;
+    events.push_back(event);
+    stale_count--;
+  }
+  state[sensor] = SENSOR_ALIVE;
+
+  if (bucket[sensor] != LIVENESS_NONE)
+  {
+    unlink(sensor);
+  }
+  if (timeout[sensor] <= 0)
+  {
+    return;
+  }
+
+  int64_t when = now / tick_ms + (timeout[sensor] + tick_ms - 1) / tick_ms;
+  expires[sensor] = when > current_tick ? when : current_tick + 1;
+  link(sensor);
+}
+
+/**
+ * Turns the wheel up to time now (ms) and reports the sensors whose timer
+ * expired on the way.
+ **/
+void LivenessTracker::advance(int64_t now, std::vector<LivenessEvent> &events)
+{
+  int64_t target = now / tick_ms;
+  if (current_tick < 0)
+  {
+    current_tick = target;
+    return;
+  }
+
+  while (current_tick < target)
+  {
+    current_tick++;
+    for (int level = 1; level < LIVENESS_LEVELS; level++)
+    {
+      if ((current_tick & (((int64_t)1 << (level * LIVENESS_BITS)) - 1)) != 0)
+      {
+        break;
+      }
+      cascade(level);
+    }
+
+    uint32_t b = (uint32_t)(current_tick & (LIVENESS_SLOTS - 1));
+    uint32_t sensor = heads[b];
+    heads[b] = LIVENESS_NONE;
+    while (sensor != LIVENESS_NONE)
+    {
+      uint32_t following = next[sensor];
+      bucket[sensor] = LIVENESS_NONE;
+      if (expires[sensor] > current_tick)
+      {
+        /* Parked beyond the span of the wheel. */
+        link(sensor);
+      }
+      else
+      {
+        LivenessEvent event;
+        event.sensor = sensor;
+        event.alive = false;
+        event.timestamp = current_tick * tick_ms;
+        event.last_seen = last_seen[sensor];
+        events.push_back(event);
+        state[sensor] = SENSOR_STALE;
+        stale_count++;
+      }
+      sensor = following;
+    }
+  }
+}
+
+size_t LivenessTracker::memoryUsage() const
+{
+  return memoryOf(next) + memoryOf(prev) +
+    memoryOf(bucket) + memoryOf(expires) + memoryOf(timeout) + memoryOf(last_seen) + memoryOf(state);
+}
+
+void LivenessTracker::save(CheckpointWriter &out) const
+{
+  out.putVector(last_seen);
+  out.putVector(state);
+}
+
+bool LivenessTracker::restore(CheckpointReader &in, size_t sensors, int64_t now)
+{
+  std::vector<int64_t> seen;
+  std::vector<uint8_t> states;
+  if (!state.empty() || !in.getVector(seen) || !in.getVector(states) || !in.done() ||
+      states.size() != seen.size() || seen.size() > sensors)
+  {
+    return false;
+  }
+
+  reserve(seen.size());
+  current_tick = now / tick_ms;
+  for (uint32_t sensor = 0; sensor < seen.size(); sensor++)
+  {
+    last_seen[sensor] = seen[sensor];
+    state[sensor] = states[sensor];
+    if (states[sensor] == SENSOR_STALE)
+    {
+      stale_count++;
+    }
+    else if (states[sensor] == SENSOR_ALIVE && timeout[sensor] > 0)
+    {
+      expires[sensor] = current_tick + (timeout[sensor] + tick_ms - 1) / tick_ms;
+      link(sensor);
+    }
+  }
+  return true;
+}
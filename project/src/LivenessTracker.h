@@ -0,0 +1,100 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    LivenessTracker.h
+ * FUNCTION:        Per sensor liveness tracking.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the liveness tracker used by the
+ * subscriber. The topics are keyless, so a DDS deadline only tells that
+ * some writer went quiet; the tracker instead keeps one timer per sensor
+ * id and reports a sensor as stale when no reading arrived within its
+ * timeout, and as recovered on its next reading.
+ *
+ * Timers live in a hierarchical timer wheel: LIVENESS_LEVELS wheels of
+ * LIVENESS_SLOTS buckets, each level covering LIVENESS_SLOTS times the
+ * span of the previous one. A bucket is an intrusive doubly linked list
+ * over the sensor slots, so re-arming a timer on every reading is an O(1)
+ * unlink and push. Timers in the outer wheels move inwards as the wheel
+ * turns and expire from the innermost one.
+ *
+ * Sensors are the dense numbers of the SensorRegistry; the per sensor
+ * arrays grow to the highest number touched.
+ *
+ ***/
+
+#ifndef __LIVENESSTRACKER_H__
+  #define __LIVENESSTRACKER_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <vector>
+
+  class CheckpointWriter;
+  class CheckpointReader;
+
+  #define LIVENESS_LEVELS  4
+  #define LIVENESS_BITS    6
+  #define LIVENESS_SLOTS   (1 << LIVENESS_BITS)
+
+  struct LivenessEvent
+  {
+      uint32_t sensor;
+      bool     alive;           /* false: went stale, true: recovered */
+      int64_t  timestamp;       /* when the change was noticed (ms) */
+      int64_t  last_seen;       /* last reading of the sensor (ms) */
+  };
+
+  class LivenessTracker
+  {
+      int64_t tick_ms;
+      int64_t default_timeout;
+      int64_t current_tick;
+
+      /* Per sensor state. */
+      std::vector<uint32_t> next;
+      std::vector<uint32_t> prev;
+      std::vector<uint32_t> bucket;
+      std::vector<int64_t>  expires;
+      std::vector<int64_t>  timeout;
+      std::vector<int64_t>  last_seen;
+      std::vector<uint8_t>  state;
+      size_t stale_count;
+
+      uint32_t heads[LIVENESS_LEVELS * LIVENESS_SLOTS];
+
+      void link(uint32_t sensor);
+      void unlink(uint32_t sensor);
+      void cascade(int level);
+    public:
+      LivenessTracker();
+      void configure(int64_t timeoutMs, int64_t tickMs = 100);
+
+      /**
+       * Makes room for the sensors below sensors; touch() and
+       * setTimeout() call it as needed.
+       **/
+      void reserve(size_t sensors);
+      void setTimeout(uint32_t sensor, int64_t timeoutMs);
+      void touch(uint32_t sensor, int64_t now, std::vector<LivenessEvent> &events);
+      void advance(int64_t now, std::vector<LivenessEvent> &events);
+      bool isAlive(uint32_t sensor) const;
+      size_t size() const { return state.size(); }
+      size_t staleCount() const { return stale_count; }
+      size_t memoryUsage() const;
+
+      /**
+       * Saves when every sensor was last seen and whether it is stale (see
+       * Checkpoint.h). restore() at time now (ms) puts them back into an
+       * empty tracker with the current timeouts; sensors that were alive
+       * get a full timeout from now, so the time c2 was down does not
+       * report them all stale at once. It returns false, changing nothing,
+       * for a malformed section, more than sensors sensors or a tracker in
+       * use.
+       **/
+      void save(CheckpointWriter &out) const;
+      bool restore(CheckpointReader &in, size_t sensors, int64_t now);
+  };
+
+#endif
@@ -0,0 +1,79 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    MemoryBudget.cpp
+ * FUNCTION:        Memory budget of the subscriber.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the memory budget.
+ *
+ ***/
+
+#include <stdint.h>
+#include "MemoryBudget.h"
+
+MemoryBudget::MemoryBudget()
+  : budget(0), sensor_usage(0), buffer_usage(0),
+    used(metrics().gauge("stack_memory_used_bytes", "Memory held by the tracked components.")),
+    limit(metrics().gauge("stack_memory_budget_bytes", "Memory budget, 0 when unlimited."))
+{
+}
+
+void MemoryBudget::configure(size_t budgetBytes)
+{
+  budget = budgetBytes;
+  limit.set((double)budget);
+}
+
+long MemoryBudget::readerSamples(size_t readers) const
+{
+  if (!limited())
+  {
+    return -1;
+  }
+  size_t samples = readerBytes() / MEMORY_READER_SAMPLE_BYTES / (readers > 0 ? readers : 1);
+  return samples > 0 ? (long)samples : 1;
+}
+
+void MemoryBudget::track(const char *component, bool perSensor, std::function<size_t()> usage)
+{
+  Component entry;
+  entry.name = component;
+  entry.per_sensor = perSensor;
+  entry.usage = usage;
+  entry.bytes = &metrics().gauge("stack_memory_bytes", "Memory held per component (estimate).",
+    metricsLabel("component", component));
+  components.push_back(entry);
+}
+
+void MemoryBudget::update()
+{
+  sensor_usage = 0;
+  buffer_usage = 0;
+  for (size_t i = 0; i < components.size(); i++)
+  {
+    size_t bytes = components[i].usage();
+    components[i].bytes->set((double)bytes);
+    (components[i].per_sensor ? sensor_usage : buffer_usage) += bytes;
+  }
+  used.set((double)(sensor_usage + buffer_usage));
+}
+
+size_t MemoryBudget::sensorLimit(size_t sensors) const
+{
+  if (!limited())
+  {
+    return SIZE_MAX;
+  }
+  size_t perSensor = sensors > 0 ? sensor_usage / sensors : 0;
+  if (perSensor < MEMORY_SENSOR_BYTES)
+  {
+    perSensor = MEMORY_SENSOR_BYTES;
+  }
+  if (sensor_usage >= sensorBytes())
+  {
+    return sensors;
+  }
+  return sensors + (sensorBytes() - sensor_usage) / perSensor;
+}
@@ -0,0 +1,98 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    MemoryBudget.h
+ * FUNCTION:        Memory budget of the subscriber.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the memory budget c2 takes with
+ * "--memory-budget-mb". The budget is split in three shares:
+ *
+ *   readers  1/4  resource limits of the DDS readers, at an estimated
+ *                 MEMORY_READER_SAMPLE_BYTES per queued sample, plus
+ *                 autopurge of the samples of gone writers
+ *   buffers  1/4  output sink buffers waiting for the disk
+ *   sensors  1/2  per sensor state: store, detector, liveness, ...
+ *
+ * Past its share each part sheds load instead of growing: the readers
+ * reject samples, the sink drops buffers and the pipeline drops the
+ * readings of sensors it has not seen yet. Known sensors keep flowing.
+ *
+ * The components report what they hold (estimated as in MemoryUsage.h)
+ * through track(); update() sums them and exports
+ * stack_memory_bytes{component=...}. Without a budget the usage is still
+ * reported and nothing is shed.
+ *
+ ***/
+
+#ifndef __MEMORYBUDGET_H__
+  #define __MEMORYBUDGET_H__
+
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <functional>
+  #include <string>
+  #include <vector>
+  #include "Metrics.h"
+
+  #define MEMORY_READER_SAMPLE_BYTES  256    /* one sample queued in a DDS reader */
+  #define MEMORY_SENSOR_BYTES         1024   /* per sensor state until measured */
+
+  class MemoryBudget
+  {
+      struct Component
+      {
+          std::string name;
+          bool per_sensor;
+          std::function<size_t()> usage;
+          Gauge *bytes;
+      };
+
+      size_t budget;
+      std::vector<Component> components;
+      size_t sensor_usage;
+      size_t buffer_usage;
+      Gauge &used;
+      Gauge &limit;
+    public:
+      MemoryBudget();
+
+      /**
+       * Sets the budget in bytes; 0 means unlimited.
+       **/
+      void configure(size_t budgetBytes);
+      bool limited() const { return budget > 0; }
+      size_t budgetBytes() const { return budget; }
+      size_t readerBytes() const { return budget / 4; }
+      size_t bufferBytes() const { return budget / 4; }
+      size_t sensorBytes() const { return budget - readerBytes() - bufferBytes(); }
+
+      /**
+       * max_samples of each of readers readers, LENGTH_UNLIMITED (-1)
+       * without a budget.
+       **/
+      long readerSamples(size_t readers) const;
+
+      /**
+       * Adds a component; usage() is only called from update(), on the
+       * caller's thread. perSensor components count towards the sensor
+       * share, the others towards the buffer share.
+       **/
+      void track(const char *component, bool perSensor, std::function<size_t()> usage);
+
+      /**
+       * Measures every component and updates the metrics.
+       **/
+      void update();
+      size_t sensorUsage() const { return sensor_usage; }
+      size_t bufferUsage() const { return buffer_usage; }
+
+      /**
+       * How many sensors fit, given that sensors sensors use the last
+       * measured sensor usage. SIZE_MAX without a budget.
+       **/
+      size_t sensorLimit(size_t sensors) const;
+  };
+
+#endif
@@ -0,0 +1,48 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    MemoryUsage.h
+ * FUNCTION:        Memory accounting helpers.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the helpers the components use to estimate the
+ * memory they hold for the memory budget (see MemoryBudget.h). The
+ * estimates count container storage and string heap buffers, with a
+ * flat MEMORY_NODE_BYTES per map node; allocator overhead is ignored.
+ *
+ ***/
+
+#ifndef __MEMORYUSAGE_H__
+  #define __MEMORYUSAGE_H__
+
+  #include <stddef.h>
+  #include <string>
+  #include <vector>
+
+  #define MEMORY_NODE_BYTES  48     /* one node of a map or hash map */
+
+  /**
+   * Heap bytes of s beyond the string object itself.
+   **/
+  inline size_t memoryOf(const std::string &s)
+  {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+  }
+
+  template <typename T> inline size_t memoryOf(const std::vector<T> &v)
+  {
+    return v.capacity() * sizeof(T);
+  }
+
+  inline size_t memoryOf(const std::vector<std::string> &v)
+  {
+    size_t bytes = v.capacity() * sizeof(std::string);
+    for (size_t i = 0; i < v.size(); i++)
+    {
+      bytes += memoryOf(v[i]);
+    }
+    return bytes;
+  }
+
+#endif
@@ -0,0 +1,529 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Metrics.cpp
+ * FUNCTION:        Process metrics in the Prometheus text format.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the metrics subsystem.
+ *
+ ***/
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "Metrics.h"
+
+const double METRICS_LATENCY_BOUNDS[] =
+{
+  0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+  0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+const size_t METRICS_LATENCY_BOUND_COUNT = sizeof(METRICS_LATENCY_BOUNDS) / sizeof(double);
+
+static std::atomic<unsigned> nextShard(0);
+
+unsigned metricsShard()
+{
+  static thread_local unsigned shard = nextShard++ % METRICS_SHARDS;
+  return shard;
+}
+
+static inline uint64_t doubleBits(double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline double bitsDouble(uint64_t bits)
+{
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void addDouble(std::atomic<uint64_t> &target, double delta)
+{
+  uint64_t old = target.load(std::memory_order_relaxed);
+  while (!target.compare_exchange_weak(old, doubleBits(bitsDouble(old) + delta),
+    std::memory_order_relaxed))
+  {
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+Counter::Counter()
+{
+  for (int i = 0; i < METRICS_SHARDS; i++)
+  {
+    cells[i].value = 0;
+  }
+}
+
+uint64_t Counter::value() const
+{
+  uint64_t sum = 0;
+  for (int i = 0; i < METRICS_SHARDS; i++)
+  {
+    sum += cells[i].value.load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+Gauge::Gauge()
+  : bits(doubleBits(0.0))
+{
+}
+
+void Gauge::set(double value)
+{
+  bits.store(doubleBits(value), std::memory_order_relaxed);
+}
+
+void Gauge::add(double delta)
+{
+  addDouble(bits, delta);
+}
+
+double Gauge::value() const
+{
+  return bitsDouble(bits.load(std::memory_order_relaxed));
+}
+
+Histogram::Histogram(const double *upperBounds, size_t count)
+  : bound_count(std::min(count, (size_t)METRICS_MAX_BUCKETS))
+{
+  std::copy(upperBounds, upperBounds + bound_count, bounds);
+  for (int s = 0; s < METRICS_SHARDS; s++)
+  {
+    for (int i = 0; i <= METRICS_MAX_BUCKETS; i++)
+    {
+      shards[s].counts[i] = 0;
+    }
+    shards[s].sum_bits = doubleBits(0.0);
+  }
+}
+
+void Histogram::observe(double value)
+{
+  size_t i = std::lower_bound(bounds, bounds + bound_count, value) - bounds;
+  Shard &shard = shards[metricsShard()];
+  shard.counts[i].fetch_add(1, std::memory_order_relaxed);
+  addDouble(shard.sum_bits, value);
+}
+
+/**
+ * Per bucket counts (not cumulative, the last one is +Inf) and the sum.
+ **/
+void Histogram::snapshot(uint64_t *counts, double &sum) const
+{
+  sum = 0;
+  for (size_t i = 0; i <= bound_count; i++)
+  {
+    counts[i] = 0;
+  }
+  for (int s = 0; s < METRICS_SHARDS; s++)
+  {
+    for (size_t i = 0; i <= bound_count; i++)
+    {
+      counts[i] += shards[s].counts[i].load(std::memory_order_relaxed);
+    }
+    sum += bitsDouble(shards[s].sum_bits.load(std::memory_order_relaxed));
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+std::string metricsLabel(const char *name, const char *value)
+{
+  std::string label(name);
+  label += "=\"";
+  for (; *value; value++)
+  {
+    if (*value == '"' || *value == '\\')
+    {
+      label += '\\';
+    }
+    label += *value;
+  }
+  label += '"';
+  return label;
+}
+
+MetricsRegistry &metrics()
+{
+  static MetricsRegistry registry;
+  return registry;
+}
+
+MetricsRegistry::Entry *MetricsRegistry::find(const char *name, const std::string &labels, Kind kind)
+{
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    if (entries[i]->name == name && entries[i]->labels == labels && entries[i]->kind == kind)
+    {
+      return entries[i].get();
+    }
+  }
+  return NULL;
+}
+
+MetricsRegistry::Entry &MetricsRegistry::add(const char *name, const char *help,
+  const std::string &labels, Kind kind)
+{
+  Entry *entry = new Entry();
+  entry->name = name;
+  entry->help = help;
+  entry->labels = labels;
+  entry->kind = kind;
+  entries.push_back(std::unique_ptr<Entry>(entry));
+  return *entry;
+}
+
+/**
+ * Returns the counter called name with the given labels (e.g.
+ * topic="humidity"), creating it on first use. Callers keep the reference;
+ * registering is not meant for the hot path.
+ **/
+Counter &MetricsRegistry::counter(const char *name, const char *help, const std::string &labels)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  Entry *entry = find(name, labels, METRIC_COUNTER);
+  if (entry == NULL)
+  {
+    entry = &add(name, help, labels, METRIC_COUNTER);
+    entry->counter.reset(new Counter());
+  }
+  return *entry->counter;
+}
+
+Gauge &MetricsRegistry::gauge(const char *name, const char *help, const std::string &labels)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  Entry *entry = find(name, labels, METRIC_GAUGE);
+  if (entry == NULL)
+  {
+    entry = &add(name, help, labels, METRIC_GAUGE);
+    entry->gauge.reset(new Gauge());
+  }
+  return *entry->gauge;
+}
+
+Histogram &MetricsRegistry::histogram(const char *name, const char *help, const std::string &labels,
+  const double *bounds, size_t count)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  Entry *entry = find(name, labels, METRIC_HISTOGRAM);
+  if (entry == NULL)
+  {
+    entry = &add(name, help, labels, METRIC_HISTOGRAM);
+    entry->histogram.reset(new Histogram(bounds, count));
+  }
+  return *entry->histogram;
+}
+
+/**
+ * Registers a counter whose total is read from function at render time.
+ **/
+void MetricsRegistry::counterFunction(const char *name, const char *help, const std::string &labels,
+  std::function<double()> function)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  add(name, help, labels, METRIC_COUNTER_FUNCTION).function = function;
+}
+
+void MetricsRegistry::gaugeFunction(const char *name, const char *help, const std::string &labels,
+  std::function<double()> function)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  add(name, help, labels, METRIC_GAUGE_FUNCTION).function = function;
+}
+
+static void appendSample(std::string &out, const std::string &name, const char *suffix,
+  const std::string &labels, const char *extra, double value)
+{
+  char text[64];
+  out += name;
+  out += suffix;
+  if (!labels.empty() || extra != NULL)
+  {
+    out += '{';
+    out += labels;
+    if (extra != NULL)
+    {
+      if (!labels.empty())
+      {
+        out += ',';
+      }
+      out += extra;
+    }
+    out += '}';
+  }
+  snprintf(text, sizeof(text), " %.17g\n", value);
+  out += text;
+}
+
+/**
+ * Renders all metrics in the Prometheus text exposition format (0.0.4).
+ **/
+void MetricsRegistry::render(std::string &out)
+{
+  std::vector<Entry *> sorted;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+      sorted.push_back(entries[i].get());
+    }
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+    [](const Entry *a, const Entry *b) { return a->name < b->name; });
+
+  uint64_t counts[METRICS_MAX_BUCKETS + 1];
+  char bound[48];
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    const Entry &entry = *sorted[i];
+    if (i == 0 || sorted[i - 1]->name != entry.name)
+    {
+      static const char *types[] = { "counter", "gauge", "histogram", "counter", "gauge" };
+      out += "# HELP " + entry.name + " " + entry.help + "\n";
+      out += "# TYPE " + entry.name + " " + types[entry.kind] + "\n";
+    }
+
+    switch (entry.kind)
+    {
+      case METRIC_COUNTER:
+        appendSample(out, entry.name, "", entry.labels, NULL, (double)entry.counter->value());
+        break;
+      case METRIC_GAUGE:
+        appendSample(out, entry.name, "", entry.labels, NULL, entry.gauge->value());
+        break;
+      case METRIC_COUNTER_FUNCTION:
+      case METRIC_GAUGE_FUNCTION:
+        appendSample(out, entry.name, "", entry.labels, NULL, entry.function());
+        break;
+      case METRIC_HISTOGRAM:
+      {
+        double sum;
+        const Histogram &histogram = *entry.histogram;
+        histogram.snapshot(counts, sum);
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < histogram.bucketCount(); b++)
+        {
+          cumulative += counts[b];
+          snprintf(bound, sizeof(bound), "le=\"%g\"", histogram.bound(b));
+          appendSample(out, entry.name, "_bucket", entry.labels, bound, (double)cumulative);
+        }
+        cumulative += counts[histogram.bucketCount()];
+        appendSample(out, entry.name, "_bucket", entry.labels, "le=\"+Inf\"", (double)cumulative);
+        appendSample(out, entry.name, "_sum", entry.labels, NULL, sum);
+        appendSample(out, entry.name, "_count", entry.labels, NULL, (double)cumulative);
+        break;
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+MetricsExporter::MetricsExporter(MetricsRegistry &registry)
+  : registry(registry), listen_fd(-1), file_interval(10000), running(false)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+  stop();
+}
+
+/**
+ * Serves the metrics on 127.0.0.1:port (0 disables) and rewrites path
+ * (NULL disables) every intervalMs milliseconds.
+ **/
+void MetricsExporter::start(int port, const char *path, int64_t intervalMs)
+{
+  if (port > 0)
+  {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+      std::cerr << "Error in MetricsExporter::start: socket: " << strerror(errno) << std::endl;
+      exit(1);
+    }
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+    if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(listen_fd, 8) != 0)
+    {
+      std::cerr << "Error in MetricsExporter::start: cannot listen on port " << port
+                << ": " << strerror(errno) << std::endl;
+      exit(1);
+    }
+    std::cout << "=== [Metrics] Serving on http://127.0.0.1:" << port << "/metrics" << std::endl;
+  }
+  if (path != NULL)
+  {
+    file_path = path;
+    file_interval = intervalMs > 0 ? intervalMs : 10000;
+    std::cout << "=== [Metrics] Writing " << file_path << std::endl;
+  }
+  if (listen_fd < 0 && file_path.empty())
+  {
+    return;
+  }
+
+  running = true;
+  worker = std::thread(&MetricsExporter::run, this);
+}
+
+void MetricsExporter::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+  running = false;
+  worker.join();
+  if (listen_fd >= 0)
+  {
+    close(listen_fd);
+    listen_fd = -1;
+  }
+  if (!file_path.empty())
+  {
+    writeFile();
+  }
+}
+
+/**
+ * Replaces the file atomically so a collector never reads half of it.
+ **/
+void MetricsExporter::writeFile()
+{
+  std::string text;
+  registry.render(text);
+
+  std::string temporary = file_path + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "w");
+  if (file == NULL)
+  {
+    std::cerr << "Error in MetricsExporter::writeFile: cannot open " << temporary
+              << ": " << strerror(errno) << std::endl;
+    return;
+  }
+  bool written = fwrite(text.data(), 1, text.size(), file) == text.size();
+  written = fclose(file) == 0 && written;
+  if (!written || rename(temporary.c_str(), file_path.c_str()) != 0)
+  {
+    std::cerr << "Error in MetricsExporter::writeFile: cannot write " << file_path << std::endl;
+  }
+}
+
+void MetricsExporter::answer(int client)
+{
+  /* Read the request head; the path is not checked, every GET gets the
+   * metrics. */
+  struct timeval timeout = { 1, 0 };
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192)
+  {
+    ssize_t got = recv(client, buffer, sizeof(buffer), 0);
+    if (got < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (got <= 0)
+    {
+      return;
+    }
+    request.append(buffer, (size_t)got);
+  }
+
+  std::string body;
+  const char *status = "200 OK";
+  if (request.compare(0, 4, "GET ") == 0)
+  {
+    registry.render(body);
+  }
+  else
+  {
+    status = "405 Method Not Allowed";
+  }
+
+  char head[256];
+  snprintf(head, sizeof(head),
+    "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n"
+    "Connection: close\r\n\r\n", status, body.size());
+  std::string response = head + body;
+
+  const char *data = response.data();
+  size_t size = response.size();
+  while (size > 0)
+  {
+    ssize_t sent = send(client, data, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (sent <= 0)
+    {
+      return;
+    }
+    data += sent;
+    size -= (size_t)sent;
+  }
+}
+
+void MetricsExporter::run()
+{
+  std::chrono::steady_clock::time_point nextWrite = std::chrono::steady_clock::now();
+  while (running)
+  {
+    if (!file_path.empty() && std::chrono::steady_clock::now() >= nextWrite)
+    {
+      writeFile();
+      nextWrite = std::chrono::steady_clock::now() + std::chrono::milliseconds(file_interval);
+    }
+
+    if (listen_fd < 0)
+    {
+      usleep(200000);
+      continue;
+    }
+
+    struct pollfd ready;
+    ready.fd = listen_fd;
+    ready.events = POLLIN;
+    if (poll(&ready, 1, 200) <= 0)
+    {
+      continue;
+    }
+    int client = accept(listen_fd, NULL, NULL);
+    if (client >= 0)
+    {
+      answer(client);
+      close(client);
+    }
+  }
+}
@@ -0,0 +1,169 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Metrics.h
+ * FUNCTION:        Process metrics in the Prometheus text format.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the metrics subsystem shared by the
+ * publisher and the subscriber.
+ *
+ * Counters and histograms are split in METRICS_SHARDS cache line sized
+ * cells; every thread updates the cell picked by its shard index with a
+ * relaxed atomic add, so the hot path takes no lock and threads do not
+ * share cache lines. The cells are summed when the metrics are rendered.
+ * Values that already live elsewhere (DDS status totals, queue lengths)
+ * are registered as callbacks and read at render time.
+ *
+ * MetricsExporter renders the registry on a local HTTP port (GET /metrics)
+ * and/or rewrites a file at a fixed interval, e.g. for the node exporter
+ * textfile collector.
+ *
+ ***/
+
+#ifndef __METRICS_H__
+  #define __METRICS_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <atomic>
+  #include <functional>
+  #include <memory>
+  #include <mutex>
+  #include <string>
+  #include <thread>
+  #include <vector>
+
+  #define METRICS_SHARDS       16
+  #define METRICS_MAX_BUCKETS  24
+
+  /**
+   * Shard index of the calling thread.
+   **/
+  unsigned metricsShard();
+
+  /* Padded to a cache line; alignas is not honoured by new in C++11. */
+  struct MetricsCell
+  {
+      std::atomic<uint64_t> value;
+      char pad[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  class Counter
+  {
+      MetricsCell cells[METRICS_SHARDS];
+    public:
+      Counter();
+      void add(uint64_t n = 1)
+      {
+        cells[metricsShard()].value.fetch_add(n, std::memory_order_relaxed);
+      }
+      uint64_t value() const;
+  };
+
+  class Gauge
+  {
+      std::atomic<uint64_t> bits;
+    public:
+      Gauge();
+      void set(double value);
+      void add(double delta);
+      double value() const;
+  };
+
+  class Histogram
+  {
+      struct Shard
+      {
+          std::atomic<uint64_t> counts[METRICS_MAX_BUCKETS + 1];
+          std::atomic<uint64_t> sum_bits;
+          char pad[64 - (METRICS_MAX_BUCKETS + 2) * sizeof(uint64_t) % 64];
+      };
+
+      double bounds[METRICS_MAX_BUCKETS];
+      size_t bound_count;
+      Shard shards[METRICS_SHARDS];
+    public:
+      Histogram(const double *upperBounds, size_t count);
+      void observe(double value);
+      size_t bucketCount() const { return bound_count; }
+      double bound(size_t i) const { return bounds[i]; }
+      void snapshot(uint64_t *counts, double &sum) const;
+  };
+
+  /* Upper bounds in seconds from 100 us to 10 s. */
+  extern const double METRICS_LATENCY_BOUNDS[];
+  extern const size_t METRICS_LATENCY_BOUND_COUNT;
+
+  class MetricsRegistry
+  {
+      enum Kind
+      {
+          METRIC_COUNTER,
+          METRIC_GAUGE,
+          METRIC_HISTOGRAM,
+          METRIC_COUNTER_FUNCTION,
+          METRIC_GAUGE_FUNCTION
+      };
+
+      struct Entry
+      {
+          std::string name;
+          std::string help;
+          std::string labels;
+          Kind kind;
+          std::unique_ptr<Counter> counter;
+          std::unique_ptr<Gauge> gauge;
+          std::unique_ptr<Histogram> histogram;
+          std::function<double()> function;
+      };
+
+      std::mutex lock;
+      std::vector<std::unique_ptr<Entry> > entries;
+
+      Entry *find(const char *name, const std::string &labels, Kind kind);
+      Entry &add(const char *name, const char *help, const std::string &labels, Kind kind);
+    public:
+      Counter &counter(const char *name, const char *help, const std::string &labels = "");
+      Gauge &gauge(const char *name, const char *help, const std::string &labels = "");
+      Histogram &histogram(const char *name, const char *help, const std::string &labels = "",
+        const double *bounds = METRICS_LATENCY_BOUNDS, size_t count = METRICS_LATENCY_BOUND_COUNT);
+      void counterFunction(const char *name, const char *help, const std::string &labels,
+        std::function<double()> function);
+      void gaugeFunction(const char *name, const char *help, const std::string &labels,
+        std::function<double()> function);
+      void render(std::string &out);
+  };
+
+  /**
+   * Formats a label pair, e.g. metricsLabel("topic", "rain") gives
+   * topic="rain".
+   **/
+  std::string metricsLabel(const char *name, const char *value);
+
+  /**
+   * Registry shared by the whole process.
+   **/
+  MetricsRegistry &metrics();
+
+  class MetricsExporter
+  {
+      MetricsRegistry &registry;
+      int listen_fd;
+      std::string file_path;
+      int64_t file_interval;
+      std::thread worker;
+      std::atomic<bool> running;
+
+      void writeFile();
+      void answer(int client);
+      void run();
+    public:
+      MetricsExporter(MetricsRegistry &registry);
+      ~MetricsExporter();
+      void start(int port, const char *path = NULL, int64_t intervalMs = 10000);
+      void stop();
+  };
+
+#endif
@@ -0,0 +1,396 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    OutputSink.cpp
+ * FUNCTION:        Buffered output of received readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the output sink.
+ *
+ ***/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <utility>
+#include "OutputSink.h"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* Spare buffers kept for reuse by the producing threads. */
+#define SINK_SPARE_BUFFERS 8
+
+/* Longest formatted text record (ids and types are string<50>). */
+#define SINK_RECORD_MAX 256
+
+static std::atomic<uint64_t> nextSinkId(1);
+
+/* Buffers of the calling thread, keyed by sink id so a sink created at the
+ * address of a closed one does not inherit its buffer. */
+static thread_local std::vector<std::pair<uint64_t, void *> > threadBuffers;
+
+static void appendEscaped(std::vector<char> &out, const char *text)
+{
+  for (; *text; text++)
+  {
+    if (*text == '"' || *text == '\\')
+    {
+      out.push_back('\\');
+    }
+    out.push_back(*text);
+  }
+}
+
+OutputSink::OutputSink()
+  : fd(-1), owns_fd(false), sink_id(0), sink_format(SINK_CSV), flush_bytes(64 * 1024), flush_interval(100),
+    queue_limit(0), queued_bytes(0), running(false), records(0), written_bytes(0), dropped_bytes(0)
+{
+}
+
+OutputSink::~OutputSink()
+{
+  close();
+}
+
+bool OutputSink::parseFormat(const char *name, SinkFormat &format)
+{
+  if (strcmp(name, "csv") == 0)
+  {
+    format = SINK_CSV;
+  }
+  else if (strcmp(name, "jsonl") == 0)
+  {
+    format = SINK_JSONL;
+  }
+  else if (strcmp(name, "binary") == 0)
+  {
+    format = SINK_BINARY;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Opens the sink on a file (appending) or on stdout when path is NULL or
+ * "-". Records are flushed once a thread has flushBytes buffered or
+ * flushIntervalMs after they were written, whichever comes first.
+ **/
+void OutputSink::open(SinkFormat sinkFormat, const char *path, size_t flushBytes,
+  int64_t flushIntervalMs)
+{
+  sink_format = sinkFormat;
+  flush_bytes = flushBytes;
+  flush_interval = flushIntervalMs;
+  sink_id = nextSinkId++;
+
+  if (path == NULL || strcmp(path, "-") == 0)
+  {
+    fd = STDOUT_FILENO;
+    owns_fd = false;
+  }
+  else
+  {
+    fd = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0)
+    {
+      std::cerr << "Error in OutputSink::open: cannot open " << path
+                << ": " << strerror(errno) << std::endl;
+      exit(1);
+    }
+    owns_fd = true;
+  }
+
+  running = true;
+  flusher = std::thread(&OutputSink::run, this);
+}
+
+OutputSink::ThreadBuffer &OutputSink::localBuffer()
+{
+  for (size_t i = 0; i < threadBuffers.size(); i++)
+  {
+    if (threadBuffers[i].first == sink_id)
+    {
+      return *(ThreadBuffer *)threadBuffers[i].second;
+    }
+  }
+
+  ThreadBuffer *buffer = new ThreadBuffer();
+  buffer->data.reserve(flush_bytes + SINK_RECORD_MAX);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    buffers.push_back(std::unique_ptr<ThreadBuffer>(buffer));
+  }
+  threadBuffers.push_back(std::make_pair(sink_id, (void *)buffer));
+  return *buffer;
+}
+
+void OutputSink::format(std::vector<char> &out, const char *topic, const char *id,
+  int64_t timestamp, float value) const
+{
+  char text[SINK_RECORD_MAX];
+  int length;
+
+  switch (sink_format)
+  {
+    case SINK_CSV:
+      if (isfinite(value))
+      {
+        length = snprintf(text, sizeof(text), "%s,%s,%lld,%.7g\n", topic, id,
+          (long long)timestamp, value);
+      }
+      else
+      {
+        length = snprintf(text, sizeof(text), "%s,%s,%lld,\n", topic, id, (long long)timestamp);
+      }
+      out.insert(out.end(), text, text + (length < (int)sizeof(text) ? length : (int)sizeof(text) - 1));
+      break;
+    case SINK_JSONL:
+      length = snprintf(text, sizeof(text), "{\"topic\":\"%s\",\"id\":\"", topic);
+      out.insert(out.end(), text, text + length);
+      appendEscaped(out, id);
+      if (isfinite(value))
+      {
+        length = snprintf(text, sizeof(text), "\",\"timestamp\":%lld,\"value\":%.7g}\n",
+          (long long)timestamp, value);
+      }
+      else
+      {
+        length = snprintf(text, sizeof(text), "\",\"timestamp\":%lld,\"value\":null}\n",
+          (long long)timestamp);
+      }
+      out.insert(out.end(), text, text + length);
+      break;
+    case SINK_BINARY:
+    {
+      SinkBinaryRecord record;
+      size_t topicLength = strlen(topic);
+      size_t idLength = strlen(id);
+      record.timestamp = timestamp;
+      record.value = value;
+      record.topic_length = (uint8_t)(topicLength < 255 ? topicLength : 255);
+      record.id_length = (uint8_t)(idLength < 255 ? idLength : 255);
+      record.reserved = 0;
+      const char *raw = (const char *)&record;
+      out.insert(out.end(), raw, raw + sizeof(record));
+      out.insert(out.end(), topic, topic + record.topic_length);
+      out.insert(out.end(), id, id + record.id_length);
+      break;
+    }
+  }
+}
+
+/**
+ * Passes a full buffer to the flusher and gives the thread an empty one.
+ * Called with the buffer lock held.
+ **/
+void OutputSink::handOver(ThreadBuffer &buffer)
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (queue_limit > 0 && queued_bytes + buffer.data.size() > queue_limit)
+    {
+      /* The flusher is behind: shed this buffer rather than grow. */
+      dropped_bytes += buffer.data.size();
+      buffer.data.clear();
+      return;
+    }
+    queued_bytes += buffer.data.size();
+    filled.push_back(std::vector<char>());
+    filled.back().swap(buffer.data);
+    if (!spare.empty())
+    {
+      buffer.data.swap(spare.back());
+      spare.pop_back();
+    }
+  }
+  if (buffer.data.capacity() < flush_bytes)
+  {
+    buffer.data.reserve(flush_bytes + SINK_RECORD_MAX);
+  }
+  wakeup.notify_one();
+}
+
+void OutputSink::write(const char *topic, const char *id, int64_t timestamp, float value)
+{
+  ThreadBuffer &buffer = localBuffer();
+  std::lock_guard<std::mutex> guard(buffer.lock);
+
+  format(buffer.data, topic, id, timestamp, value);
+  records++;
+  if (buffer.data.size() >= flush_bytes)
+  {
+    handOver(buffer);
+  }
+}
+
+/**
+ * Writes the batch with as few writev() calls as possible.
+ **/
+void OutputSink::writeAll(std::vector<std::vector<char> > &batch)
+{
+  std::vector<struct iovec> vectors;
+  for (size_t i = 0; i < batch.size(); i++)
+  {
+    if (!batch[i].empty())
+    {
+      struct iovec entry;
+      entry.iov_base = &batch[i][0];
+      entry.iov_len = batch[i].size();
+      vectors.push_back(entry);
+    }
+  }
+
+  size_t first = 0;
+  while (first < vectors.size())
+  {
+    int count = (int)std::min(vectors.size() - first, (size_t)IOV_MAX);
+    ssize_t done = writev(fd, &vectors[first], count);
+    if (done < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      std::cerr << "Error in OutputSink::writeAll: " << strerror(errno) << std::endl;
+      return;
+    }
+    written_bytes += (uint64_t)done;
+
+    /* Skip what was written, resuming inside a partially written buffer. */
+    while (first < vectors.size() && (size_t)done >= vectors[first].iov_len)
+    {
+      done -= (ssize_t)vectors[first].iov_len;
+      first++;
+    }
+    if (first < vectors.size())
+    {
+      vectors[first].iov_base = (char *)vectors[first].iov_base + done;
+      vectors[first].iov_len -= (size_t)done;
+    }
+  }
+}
+
+void OutputSink::run()
+{
+  std::chrono::steady_clock::time_point deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(flush_interval);
+  std::vector<std::vector<char> > batch;
+  std::vector<ThreadBuffer *> partial;
+
+  std::unique_lock<std::mutex> guard(lock);
+  for (;;)
+  {
+    wakeup.wait_until(guard, deadline);
+    bool stopping = !running;
+
+    batch.swap(filled);
+    size_t taken = queued_bytes;
+    partial.clear();
+    bool late = std::chrono::steady_clock::now() >= deadline;
+    if (late || stopping)
+    {
+      for (size_t i = 0; i < buffers.size(); i++)
+      {
+        partial.push_back(buffers[i].get());
+      }
+      deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(flush_interval);
+    }
+    guard.unlock();
+
+    /* Records older than the time limit: take what the threads hold. */
+    for (size_t i = 0; i < partial.size(); i++)
+    {
+      std::lock_guard<std::mutex> hold(partial[i]->lock);
+      if (!partial[i]->data.empty())
+      {
+        batch.push_back(std::vector<char>());
+        batch.back().swap(partial[i]->data);
+        partial[i]->data.reserve(flush_bytes + SINK_RECORD_MAX);
+      }
+    }
+
+    writeAll(batch);
+
+    guard.lock();
+    queued_bytes -= taken;
+    for (size_t i = 0; i < batch.size() && spare.size() < SINK_SPARE_BUFFERS; i++)
+    {
+      batch[i].clear();
+      spare.push_back(std::vector<char>());
+      spare.back().swap(batch[i]);
+    }
+    batch.clear();
+    if (stopping && filled.empty())
+    {
+      break;
+    }
+  }
+}
+
+void OutputSink::close()
+{
+  if (fd < 0)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    running = false;
+  }
+  wakeup.notify_one();
+  flusher.join();
+
+  if (owns_fd)
+  {
+    ::close(fd);
+  }
+  fd = -1;
+}
+
+void OutputSink::setQueueLimit(size_t bytes)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  queue_limit = bytes;
+}
+
+size_t OutputSink::memoryUsage()
+{
+  /* Queued and in flight buffers by size, the others by capacity. The
+   * thread buffers are locked one at a time, never under the sink lock,
+   * as write() takes them in the other order. */
+  std::vector<ThreadBuffer *> threads;
+  size_t bytes = 0;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    bytes += queued_bytes;
+    for (size_t i = 0; i < spare.size(); i++)
+    {
+      bytes += spare[i].capacity();
+    }
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+      threads.push_back(buffers[i].get());
+    }
+  }
+  for (size_t i = 0; i < threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> hold(threads[i]->lock);
+    bytes += threads[i]->data.capacity();
+  }
+  return bytes;
+}
@@ -0,0 +1,115 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    OutputSink.h
+ * FUNCTION:        Buffered output of received readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the output sink. The subscribers
+ * format every reading into a buffer owned by the calling thread; a
+ * dedicated flusher thread collects the buffers and writes them to the
+ * output file descriptor with a single writev(). A buffer is handed over
+ * when it reaches the size limit, and the flusher picks up partially
+ * filled buffers once the time limit has passed, so the reader never
+ * blocks on the terminal or the disk. With a queue limit, full buffers
+ * that would push the bytes waiting for the flusher past it are dropped
+ * and counted instead of queued.
+ *
+ * Record formats:
+ *   csv     topic,id,timestamp,value
+ *   jsonl   {"topic":"...","id":"...","timestamp":...,"value":...}
+ *   binary  SinkBinaryRecord | topic | id
+ *
+ * A NaN or infinite value is written as an empty csv field and as a
+ * jsonl null; binary records keep the float as it is.
+ *
+ ***/
+
+#ifndef __OUTPUTSINK_H__
+  #define __OUTPUTSINK_H__
+
+  #include <stdint.h>
+  #include <atomic>
+  #include <condition_variable>
+  #include <memory>
+  #include <mutex>
+  #include <string>
+  #include <thread>
+  #include <vector>
+
+  enum SinkFormat
+  {
+      SINK_CSV,
+      SINK_JSONL,
+      SINK_BINARY
+  };
+
+  struct SinkBinaryRecord
+  {
+      int64_t  timestamp;
+      float    value;
+      uint8_t  topic_length;
+      uint8_t  id_length;
+      uint16_t reserved;
+  };
+
+  class OutputSink
+  {
+      /* Buffer of one producing thread. The mutex is only contended when
+       * the flusher takes a partially filled buffer. */
+      struct ThreadBuffer
+      {
+          std::mutex lock;
+          std::vector<char> data;
+      };
+
+      int fd;
+      bool owns_fd;
+      uint64_t sink_id;
+      SinkFormat sink_format;
+      size_t flush_bytes;
+      int64_t flush_interval;
+
+      std::mutex lock;
+      std::condition_variable wakeup;
+      std::vector<std::unique_ptr<ThreadBuffer> > buffers;
+      std::vector<std::vector<char> > filled;
+      std::vector<std::vector<char> > spare;
+      size_t queue_limit;
+      size_t queued_bytes;
+      std::thread flusher;
+      bool running;
+
+      std::atomic<uint64_t> records;
+      std::atomic<uint64_t> written_bytes;
+      std::atomic<uint64_t> dropped_bytes;
+
+      ThreadBuffer &localBuffer();
+      void handOver(ThreadBuffer &buffer);
+      void format(std::vector<char> &out, const char *topic, const char *id,
+        int64_t timestamp, float value) const;
+      void writeAll(std::vector<std::vector<char> > &batch);
+      void run();
+    public:
+      OutputSink();
+      ~OutputSink();
+      void open(SinkFormat format, const char *path = NULL, size_t flushBytes = 64 * 1024,
+        int64_t flushIntervalMs = 100);
+      void write(const char *topic, const char *id, int64_t timestamp, float value);
+      void close();
+      bool isOpen() const { return fd >= 0; }
+      uint64_t recordCount() const { return records; }
+      uint64_t bytes() const { return written_bytes; }
+
+      /**
+       * Bytes of full buffers allowed to wait for the flusher, 0 for no
+       * limit.
+       **/
+      void setQueueLimit(size_t bytes);
+      uint64_t droppedBytes() const { return dropped_bytes; }
+      size_t memoryUsage();
+      static bool parseFormat(const char *name, SinkFormat &format);
+  };
+
+#endif
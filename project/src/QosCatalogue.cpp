@@ -0,0 +1,83 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QosCatalogue.cpp
+ * FUNCTION:        Named QoS profiles selected on the command line.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the QoS profile catalogue.
+ *
+ ***/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "CommandLine.h"
+#include "QosCatalogue.h"
+
+static const char *profileNames[] =
+{
+    QOS_DEFAULT_PROFILE,
+    "low-latency",
+    "high-throughput",
+    "lossless-reliable",
+    "late-joiner-transient"
+};
+
+QosCatalogue::QosCatalogue(const char *uri)
+  : uri(uri)
+{
+}
+
+bool QosCatalogue::isProfile(const char *name)
+{
+  for (size_t i = 0; i < sizeof(profileNames) / sizeof(profileNames[0]); i++)
+  {
+    if (strcmp(name, profileNames[i]) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+DDS::QosProvider &QosCatalogue::provider(const char *profile)
+{
+  if (!isProfile(profile))
+  {
+    std::cerr << "Error in QoS profile: unknown profile " << profile << ", expected one of";
+    for (size_t i = 0; i < sizeof(profileNames) / sizeof(profileNames[0]); i++)
+    {
+      std::cerr << " " << profileNames[i];
+    }
+    std::cerr << std::endl;
+    exit(1);
+  }
+
+  std::unique_ptr<DDS::QosProvider> &slot = providers[profile];
+  if (!slot)
+  {
+    slot.reset(new DDS::QosProvider(uri.c_str(), profile));
+  }
+  return *slot;
+}
+
+void QosCatalogue::reload(const std::string &uri)
+{
+  this->uri = uri;
+  providers.clear();
+}
+
+DDS::QosProvider &QosCatalogue::provider(int argc, char *argv[], const char *topic)
+{
+  return provider(qosProfile(argc, argv, topic));
+}
+
+const char *qosProfile(int argc, char *argv[], const char *topic)
+{
+  std::string option = std::string("--qos-") + topic;
+  const char *name = getOption(argc, argv, option.c_str(),
+    getOption(argc, argv, "--qos-profile", QOS_DEFAULT_PROFILE));
+  return strcmp(name, "default") == 0 ? QOS_DEFAULT_PROFILE : name;
+}
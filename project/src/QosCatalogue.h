@@ -0,0 +1,77 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QosCatalogue.h
+ * FUNCTION:        Named QoS profiles selected on the command line.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the QoS profile catalogue. The
+ * profiles are defined in DDS_DefaultQoS.xml:
+ *
+ *   DefaultQosProfile      best effort reader, reliable writer, depth 1
+ *   low-latency            best effort end to end, depth 1
+ *   high-throughput        reliable, depth 1000, 10 ms latency budget
+ *   lossless-reliable      reliable KEEP_ALL, writer blocks when full
+ *   late-joiner-transient  reliable TRANSIENT, last 100 kept for late readers
+ *
+ * "--qos-profile <name>" picks the profile of the whole process and
+ * "--qos-<topic> <name>" overrides it for one topic. One QosProvider is
+ * loaded per profile in use; reload() drops them after the file changed.
+ *
+ ***/
+
+#ifndef __QOSCATALOGUE_H__
+  #define __QOSCATALOGUE_H__
+
+  #include <map>
+  #include <memory>
+  #include <string>
+  #include "ccpp_dds_dcps.h"
+  #include "QosProvider.h"
+
+  #define QOS_DEFAULT_FILE     "DDS_DefaultQoS.xml"
+  #define QOS_DEFAULT_URI      "file://" QOS_DEFAULT_FILE
+  #define QOS_DEFAULT_PROFILE  "DefaultQosProfile"
+
+  class QosCatalogue
+  {
+      std::string uri;
+      std::map<std::string, std::unique_ptr<DDS::QosProvider> > providers;
+    public:
+      QosCatalogue(const char *uri = QOS_DEFAULT_URI);
+
+      /**
+       * Returns the provider of a profile, loading it on first use. Exits
+       * with an error for a name that is not in the catalogue.
+       **/
+      DDS::QosProvider &provider(const char *profile);
+
+      /**
+       * Returns the provider for topic according to the command line.
+       **/
+      DDS::QosProvider &provider(int argc, char *argv[], const char *topic);
+
+      /**
+       * Drops the providers loaded so far, so the profiles are read again
+       * from uri when next used. The entities created with them keep
+       * their QoS.
+       **/
+      void reload(const std::string &uri);
+
+      /**
+       * Exchanges the file and providers with those of other, e.g. one a
+       * new file was checked with.
+       **/
+      void swap(QosCatalogue &other) { uri.swap(other.uri); providers.swap(other.providers); }
+
+      static bool isProfile(const char *name);
+  };
+
+  /**
+   * Profile name for topic: "--qos-<topic>", else "--qos-profile", else
+   * QOS_DEFAULT_PROFILE. "default" stands for QOS_DEFAULT_PROFILE.
+   **/
+  const char *qosProfile(int argc, char *argv[], const char *topic);
+
+#endif
@@ -0,0 +1,184 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QueryClient.cpp
+ * FUNCTION:        Command line client for the c2 query endpoint.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'c2_query' executable.
+ *
+ * This executable:
+ * - connects to the query socket of a running c2
+ * - requests one sensor id (--id) or all ids with a prefix (--prefix)
+ *   between --from and --to (milliseconds since the epoch)
+ * - prints the samples as "id,timestamp,value" lines, or with --rollup
+ *   the 1s/1m/1h/auto buckets as "id,start,min,max,mean,count" lines
+ * - reports the sample count and elapsed time on stderr
+ *
+ * Usage: c2_query --socket store/query.sock (--id ID | --prefix P)
+ *                 [--from MS] [--to MS] [--rollup 1s|1m|1h|auto]
+ *
+ ***/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CommandLine.h"
+#include "QueryProtocol.h"
+#include "SeriesRollup.h"
+
+using namespace std;
+
+static bool readAll(int fd, void *buffer, size_t size)
+{
+  uint8_t *data = (uint8_t *)buffer;
+  while (size > 0)
+  {
+    ssize_t got = read(fd, data, size);
+    if (got <= 0)
+    {
+      return false;
+    }
+    data += got;
+    size -= (size_t)got;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  const char *socketPath = getOption(argc, argv, "--socket", "store/query.sock");
+  const char *id = getOption(argc, argv, "--id", NULL);
+  const char *prefix = getOption(argc, argv, "--prefix", NULL);
+  const char *from = getOption(argc, argv, "--from", "0");
+  const char *to = getOption(argc, argv, "--to", "9223372036854775807");
+  const char *rollup = getOption(argc, argv, "--rollup", NULL);
+
+  int resolution = -1;
+  if (rollup != NULL)
+  {
+    resolution = QUERY_RESOLUTION_AUTO;
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      if (strcmp(rollup, RollupStore::name[l]) == 0)
+      {
+        resolution = l;
+      }
+    }
+  }
+
+  if ((id == NULL) == (prefix == NULL))
+  {
+    cerr << "Usage: c2_query --socket PATH (--id ID | --prefix PREFIX) [--from MS] [--to MS]"
+         << " [--rollup 1s|1m|1h|auto]" << endl;
+    return 1;
+  }
+  string key = id != NULL ? id : prefix;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0)
+  {
+    cerr << "Error in connect(): cannot reach " << socketPath << endl;
+    return 1;
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  QueryRequest request;
+  memset(&request, 0, sizeof(request));
+  request.magic = QUERY_REQUEST_MAGIC;
+  if (resolution < 0)
+  {
+    request.kind = id != NULL ? QUERY_SENSOR : QUERY_PREFIX;
+  }
+  else
+  {
+    request.kind = id != NULL ? QUERY_SENSOR_ROLLUP : QUERY_PREFIX_ROLLUP;
+    request.resolution = (uint8_t)resolution;
+  }
+  request.key_length = (uint16_t)key.size();
+  request.from = strtoll(from, NULL, 10);
+  request.to = strtoll(to, NULL, 10);
+  if (write(fd, &request, sizeof(request)) != (ssize_t)sizeof(request) ||
+      write(fd, key.data(), key.size()) != (ssize_t)key.size())
+  {
+    cerr << "Error in write(): request not sent" << endl;
+    return 1;
+  }
+
+  uint64_t total = 0;
+  string sensor;
+  vector<int64_t> timestamps;
+  vector<float> values;
+  vector<RollupBucket> buckets;
+  for (;;)
+  {
+    QueryFrame frame;
+    if (!readAll(fd, &frame, sizeof(frame)))
+    {
+      cerr << "Error in read(): connection closed" << endl;
+      return 1;
+    }
+    if (frame.id_length == 0)
+    {
+      if (frame.status != QUERY_OK)
+      {
+        cerr << "Error in query: bad request" << endl;
+        return 1;
+      }
+      break;
+    }
+
+    sensor.resize(frame.id_length);
+    if (resolution >= 0)
+    {
+      buckets.resize(frame.count);
+      if (!readAll(fd, &sensor[0], sensor.size()) ||
+          !readAll(fd, &buckets[0], frame.count * sizeof(RollupBucket)))
+      {
+        cerr << "Error in read(): truncated frame" << endl;
+        return 1;
+      }
+      for (uint32_t i = 0; i < frame.count; i++)
+      {
+        printf("%s,%lld,%g,%g,%g,%u\n", sensor.c_str(), (long long)buckets[i].start,
+          buckets[i].min_value, buckets[i].max_value, buckets[i].sum / buckets[i].count,
+          buckets[i].count);
+      }
+      total += frame.count;
+      continue;
+    }
+
+    timestamps.resize(frame.count);
+    values.resize(frame.count);
+    if (!readAll(fd, &sensor[0], sensor.size()) ||
+        !readAll(fd, &timestamps[0], frame.count * sizeof(int64_t)) ||
+        !readAll(fd, &values[0], frame.count * sizeof(float)))
+    {
+      cerr << "Error in read(): truncated frame" << endl;
+      return 1;
+    }
+    for (uint32_t i = 0; i < frame.count; i++)
+    {
+      printf("%s,%lld,%g\n", sensor.c_str(), (long long)timestamps[i], values[i]);
+    }
+    total += frame.count;
+  }
+
+  double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  cerr << total << (resolution >= 0 ? " buckets in " : " samples in ") << elapsed << " ms" << endl;
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,67 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QueryProtocol.h
+ * FUNCTION:        Wire format of the c2 query endpoint.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the message layouts exchanged over the Unix domain
+ * socket of the query server (host byte order, the socket is local).
+ *
+ * Request:  QueryRequest | key (key_length bytes)
+ * Response: QueryFrame | id | count timestamps (int64) | count values (float)
+ *           ... repeated, terminated by a frame with id_length == 0.
+ *
+ * Rollup requests are answered with QueryFrame | id | count RollupBucket
+ * (SeriesRollup.h) frames. The resolution field selects 1 s, 1 min or 1 h
+ * buckets; QUERY_RESOLUTION_AUTO picks the finest one that answers the
+ * range in at most QUERY_AUTO_POINTS buckets per sensor. The level that
+ * was used is returned in the status field of the frames.
+ *
+ * A connection may carry any number of requests.
+ *
+ ***/
+
+#ifndef __QUERYPROTOCOL_H__
+  #define __QUERYPROTOCOL_H__
+
+  #include <stdint.h>
+
+  #define QUERY_REQUEST_MAGIC  0x52513253   /* "S2QR" */
+
+  /* Request kinds */
+  #define QUERY_SENSOR  1   /* key is a full sensor id */
+  #define QUERY_PREFIX  2   /* key is an id prefix, e.g. "<host>N<node>S" */
+  #define QUERY_SENSOR_ROLLUP  3
+  #define QUERY_PREFIX_ROLLUP  4
+
+  /* Rollup resolutions */
+  #define QUERY_RESOLUTION_1S    0
+  #define QUERY_RESOLUTION_1M    1
+  #define QUERY_RESOLUTION_1H    2
+  #define QUERY_RESOLUTION_AUTO  255
+  #define QUERY_AUTO_POINTS      2000
+
+  struct QueryRequest
+  {
+      uint32_t magic;
+      uint8_t  kind;
+      uint8_t  resolution;
+      uint16_t key_length;
+      int64_t  from;
+      int64_t  to;
+  };
+
+  struct QueryFrame
+  {
+      uint16_t id_length;
+      uint16_t status;
+      uint32_t count;
+  };
+
+  /* Frame status of raw queries and of the terminating frame */
+  #define QUERY_OK           0
+  #define QUERY_BAD_REQUEST  0xffff
+
+#endif
@@ -0,0 +1,304 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QueryServer.cpp
+ * FUNCTION:        Local query endpoint over the stored readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the query server. Clients are
+ * served one at a time on a single thread; queries are short and the
+ * endpoint is meant for local tools and dashboards.
+ *
+ ***/
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <iostream>
+#include <vector>
+#include "QueryProtocol.h"
+#include "QueryServer.h"
+
+/* Frames are flushed to the socket once this much is buffered. */
+#define QUERY_SEND_CHUNK (256 * 1024)
+
+static bool sendAll(int fd, const uint8_t *data, size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    data += sent;
+    size -= (size_t)sent;
+  }
+  return true;
+}
+
+static bool recvAll(int fd, void *buffer, size_t size)
+{
+  uint8_t *data = (uint8_t *)buffer;
+  while (size > 0)
+  {
+    ssize_t got = recv(fd, data, size, 0);
+    if (got < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (got <= 0)
+    {
+      return false;
+    }
+    data += got;
+    size -= (size_t)got;
+  }
+  return true;
+}
+
+/**
+ * Encodes the visited blocks as frames and streams them to the client.
+ **/
+class FrameWriter : public SeriesVisitor, public RollupVisitor
+{
+    int fd;
+    std::vector<uint8_t> buffer;
+  public:
+    bool failed;
+
+    FrameWriter(int fd) : fd(fd), failed(false)
+    {
+      buffer.reserve(QUERY_SEND_CHUNK + 4096);
+    }
+
+    void frame(const std::string &id, uint16_t status, const int64_t *timestamps,
+      const float *values, uint32_t count)
+    {
+      QueryFrame header;
+      header.id_length = (uint16_t)id.size();
+      header.status = status;
+      header.count = count;
+
+      const uint8_t *raw = (const uint8_t *)&header;
+      buffer.insert(buffer.end(), raw, raw + sizeof(header));
+      buffer.insert(buffer.end(), id.begin(), id.end());
+      raw = (const uint8_t *)timestamps;
+      buffer.insert(buffer.end(), raw, raw + count * sizeof(int64_t));
+      raw = (const uint8_t *)values;
+      buffer.insert(buffer.end(), raw, raw + count * sizeof(float));
+
+      if (buffer.size() >= QUERY_SEND_CHUNK)
+      {
+        flush();
+      }
+    }
+
+    void rollupFrame(const std::string &id, uint16_t level, const RollupBucket *buckets,
+      uint32_t count)
+    {
+      QueryFrame header;
+      header.id_length = (uint16_t)id.size();
+      header.status = level;
+      header.count = count;
+
+      const uint8_t *raw = (const uint8_t *)&header;
+      buffer.insert(buffer.end(), raw, raw + sizeof(header));
+      buffer.insert(buffer.end(), id.begin(), id.end());
+      raw = (const uint8_t *)buckets;
+      buffer.insert(buffer.end(), raw, raw + count * sizeof(RollupBucket));
+
+      if (buffer.size() >= QUERY_SEND_CHUNK)
+      {
+        flush();
+      }
+    }
+
+    virtual void visit(const std::string &id, const int64_t *timestamps,
+      const float *values, uint32_t count)
+    {
+      if (!failed)
+      {
+        frame(id, QUERY_OK, timestamps, values, count);
+      }
+    }
+
+    virtual void visit(const std::string &id, int level, const RollupBucket *buckets,
+      uint32_t count)
+    {
+      if (!failed)
+      {
+        rollupFrame(id, (uint16_t)level, buckets, count);
+      }
+    }
+
+    void flush()
+    {
+      if (!failed && !buffer.empty())
+      {
+        failed = !sendAll(fd, &buffer[0], buffer.size());
+      }
+      buffer.clear();
+    }
+};
+
+QueryServer::QueryServer(const SeriesStore &store)
+  : store(store), listen_fd(-1), running(false)
+{
+}
+
+QueryServer::~QueryServer()
+{
+  stop();
+}
+
+void QueryServer::start(const std::string &socketPath)
+{
+  struct sockaddr_un address;
+  if (socketPath.size() >= sizeof(address.sun_path))
+  {
+    std::cerr << "Error in QueryServer::start: socket path too long: " << socketPath << std::endl;
+    exit(1);
+  }
+  socket_path = socketPath;
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+  {
+    std::cerr << "Error in QueryServer::start: socket: " << strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socket_path.c_str());
+  unlink(socket_path.c_str());
+  if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(listen_fd, 8) != 0)
+  {
+    std::cerr << "Error in QueryServer::start: cannot listen on " << socket_path
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  running = true;
+  worker = std::thread(&QueryServer::serve, this);
+  std::cout << "=== [QueryServer] Listening on " << socket_path << std::endl;
+}
+
+void QueryServer::stop()
+{
+  if (!running)
+  {
+    return;
+  }
+  running = false;
+  worker.join();
+  close(listen_fd);
+  listen_fd = -1;
+  unlink(socket_path.c_str());
+}
+
+void QueryServer::serve()
+{
+  while (running)
+  {
+    struct pollfd ready;
+    ready.fd = listen_fd;
+    ready.events = POLLIN;
+    if (poll(&ready, 1, 200) <= 0)
+    {
+      continue;
+    }
+
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd >= 0)
+    {
+      handle(fd);
+      close(fd);
+    }
+  }
+}
+
+void QueryServer::handle(int fd)
+{
+  /* A client stalling in the middle of a request is dropped. */
+  struct timeval timeout = { 1, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  while (running)
+  {
+    /* Wait for the next request without blocking shutdown. */
+    struct pollfd ready;
+    ready.fd = fd;
+    ready.events = POLLIN;
+    int events = poll(&ready, 1, 200);
+    if (events == 0 || (events < 0 && errno == EINTR))
+    {
+      continue;
+    }
+
+    QueryRequest request;
+    if (events < 0 || !recvAll(fd, &request, sizeof(request)))
+    {
+      return;
+    }
+
+    std::string key(request.key_length, '\0');
+    if (request.key_length > 0 && !recvAll(fd, &key[0], key.size()))
+    {
+      return;
+    }
+
+    FrameWriter writer(fd);
+    if (request.magic != QUERY_REQUEST_MAGIC)
+    {
+      writer.frame(std::string(), QUERY_BAD_REQUEST, NULL, NULL, 0);
+      writer.flush();
+      return;
+    }
+
+    int level = request.resolution;
+    if (level == QUERY_RESOLUTION_AUTO)
+    {
+      level = RollupStore::chooseLevel(request.from, request.to, QUERY_AUTO_POINTS);
+    }
+
+    uint16_t status = QUERY_OK;
+    if (request.kind == QUERY_SENSOR)
+    {
+      store.query(key, request.from, request.to, writer);
+    }
+    else if (request.kind == QUERY_PREFIX)
+    {
+      store.queryPrefix(key, request.from, request.to, writer);
+    }
+    else if (request.kind == QUERY_SENSOR_ROLLUP && level < ROLLUP_LEVELS)
+    {
+      store.queryRollup(key, level, request.from, request.to, writer);
+    }
+    else if (request.kind == QUERY_PREFIX_ROLLUP && level < ROLLUP_LEVELS)
+    {
+      store.queryRollupPrefix(key, level, request.from, request.to, writer);
+    }
+    else
+    {
+      status = QUERY_BAD_REQUEST;
+    }
+    writer.frame(std::string(), status, NULL, NULL, 0);
+    writer.flush();
+    if (writer.failed)
+    {
+      return;
+    }
+  }
+}
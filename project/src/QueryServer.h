@@ -0,0 +1,40 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    QueryServer.h
+ * FUNCTION:        Local query endpoint over the stored readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the query server. It listens on a
+ * Unix domain socket and streams the samples of a (sensor id, time range)
+ * or (id prefix, time range) query in the format of QueryProtocol.h.
+ *
+ ***/
+
+#ifndef __QUERYSERVER_H__
+  #define __QUERYSERVER_H__
+
+  #include <atomic>
+  #include <string>
+  #include <thread>
+  #include "SeriesStore.h"
+
+  class QueryServer
+  {
+      const SeriesStore &store;
+      std::string socket_path;
+      int listen_fd;
+      std::atomic<bool> running;
+      std::thread worker;
+
+      void serve();
+      void handle(int fd);
+    public:
+      QueryServer(const SeriesStore &store);
+      ~QueryServer();
+      void start(const std::string &socketPath);
+      void stop();
+  };
+
+#endif
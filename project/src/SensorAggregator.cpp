@@ -0,0 +1,104 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorAggregator.cpp
+ * FUNCTION:        Per sensor windowed reduction.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the windowed reduction.
+ *
+ ***/
+
+#include <cstring>
+#include "SensorAggregator.h"
+
+float SensorWindow::value(AggregateReduce reduce) const
+{
+  switch (reduce)
+  {
+    case REDUCE_MEAN:
+      return (float)(sum / count);
+    case REDUCE_MIN:
+      return min_value;
+    case REDUCE_MAX:
+      return max_value;
+    default:
+      return last_value;
+  }
+}
+
+SensorAggregator::SensorAggregator(int64_t windowMs)
+  : window_ms(windowMs > 0 ? windowMs : 1), window_end(0), samples_in(0), summaries_out(0)
+{
+}
+
+bool SensorAggregator::parseReduce(const char *name, AggregateReduce &reduce)
+{
+  static const char *names[] = { "last", "mean", "min", "max" };
+  for (int i = 0; i < 4; i++)
+  {
+    if (strcmp(name, names[i]) == 0)
+    {
+      reduce = (AggregateReduce)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SensorAggregator::add(const TransportSample *samples, size_t count, int64_t now)
+{
+  if (window_end == 0)
+  {
+    window_end = now - now % window_ms + window_ms;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    const TransportSample &sample = samples[i];
+    uint32_t sensor = registry.intern(sample.id);
+    if (sensor == windows.size())
+    {
+      types.push_back(sample.type);
+      windows.push_back(SensorWindow());
+      windows.back().sensor = sensor;
+      windows.back().count = 0;
+    }
+
+    SensorWindow &window = windows[sensor];
+    if (window.count == 0)
+    {
+      active.push_back(sensor);
+      window.min_value = sample.value;
+      window.max_value = sample.value;
+      window.sum = 0;
+      window.first = sample.timestamp;
+    }
+    else
+    {
+      window.min_value = sample.value < window.min_value ? sample.value : window.min_value;
+      window.max_value = sample.value > window.max_value ? sample.value : window.max_value;
+    }
+    window.sum += sample.value;
+    window.last_value = sample.value;
+    window.last = sample.timestamp;
+    window.count++;
+  }
+  samples_in += count;
+}
+
+size_t SensorAggregator::flush(int64_t now, std::vector<SensorWindow> &out)
+{
+  out.clear();
+  out.reserve(active.size());
+  for (size_t i = 0; i < active.size(); i++)
+  {
+    SensorWindow &window = windows[active[i]];
+    out.push_back(window);
+    window.count = 0;
+  }
+  active.clear();
+  window_end = now - now % window_ms + window_ms;
+  summaries_out += out.size();
+  return out.size();
+}
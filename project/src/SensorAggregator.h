@@ -0,0 +1,90 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorAggregator.h
+ * FUNCTION:        Per sensor windowed reduction.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the reduction done by the
+ * aggregator tier. The readings of one topic are gathered per sensor id
+ * over fixed windows of window_ms (aligned on multiples of it); when a
+ * window closes, every sensor that had readings in it yields one
+ * SensorWindow with their min, max, mean, last value and count. Sensors
+ * without readings yield nothing, so the output rate is at most one
+ * summary per sensor per window whatever the input rate.
+ *
+ ***/
+
+#ifndef __SENSORAGGREGATOR_H__
+  #define __SENSORAGGREGATOR_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <string>
+  #include <vector>
+  #include "Transport.h"
+  #include "SensorRegistry.h"
+
+  enum AggregateReduce
+  {
+      REDUCE_LAST,
+      REDUCE_MEAN,
+      REDUCE_MIN,
+      REDUCE_MAX
+  };
+
+  struct SensorWindow
+  {
+      uint32_t sensor;
+      float    min_value;
+      float    max_value;
+      double   sum;
+      float    last_value;
+      uint32_t count;
+      int64_t  first;           /* source timestamps (ms) */
+      int64_t  last;
+
+      float value(AggregateReduce reduce) const;
+  };
+
+  class SensorAggregator
+  {
+      int64_t window_ms;
+      int64_t window_end;
+
+      SensorRegistry registry;
+      std::vector<std::string> types;
+      std::vector<SensorWindow> windows;
+      std::vector<uint32_t> active;     /* sensors with readings in the window */
+      uint64_t samples_in;
+      uint64_t summaries_out;
+    public:
+      SensorAggregator(int64_t windowMs = 1000);
+
+      void add(const TransportSample *samples, size_t count, int64_t now);
+
+      /**
+       * True once the window of now is past the current one. No window is
+       * open before the first add().
+       **/
+      bool due(int64_t now) const { return window_end != 0 && now >= window_end; }
+
+      /**
+       * Closes the current window: replaces out with the summaries of the
+       * sensors that had readings and starts the window of now.
+       **/
+      size_t flush(int64_t now, std::vector<SensorWindow> &out);
+
+      const std::string &id(uint32_t sensor) const { return registry.id(sensor); }
+      const std::string &type(uint32_t sensor) const { return types[sensor]; }
+      int64_t windowMs() const { return window_ms; }
+      int64_t windowEnd() const { return window_end; }
+      size_t size() const { return registry.size(); }
+      uint64_t samplesIn() const { return samples_in; }
+      uint64_t summariesOut() const { return summaries_out; }
+
+      static bool parseReduce(const char *name, AggregateReduce &reduce);
+  };
+
+#endif
@@ -0,0 +1,98 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorPipeline.cpp
+ * FUNCTION:        Processing of the readings of one topic.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the processing of the
+ * readings of one topic.
+ *
+ ***/
+
+#include "SensorPipeline.h"
+#include "MemoryUsage.h"
+
+SensorPipeline::SensorPipeline(const char *topic, SensorRegistry &registry, OutputSink *sink,
+  SeriesStore *store, AnomalyDetector *detector, LivenessTracker *tracker, SensorTableWriter *table)
+  : topic(topic), registry(registry), sink(sink), store(store), detector(detector), tracker(tracker), table(table),
+    received(metrics().counter("stack_samples_received_total",
+      "Valid samples taken from the reader.", metricsLabel("topic", topic))),
+    latency(metrics().histogram("stack_sample_latency_seconds",
+      "Delay from the source timestamp to the take.", metricsLabel("topic", topic))),
+    batch(metrics().gauge("stack_reader_batch_samples",
+      "Samples returned by the last take.", metricsLabel("topic", topic))),
+    shed(metrics().counter("stack_samples_shed_total",
+      "Samples of new sensors dropped by the sensor limit.", metricsLabel("topic", topic))),
+    max_sensors(SIZE_MAX)
+{
+}
+
+void SensorPipeline::process(const TransportSample *samples, size_t count, int64_t now,
+  std::vector<AnomalyAlert> &alerts, std::vector<LivenessEvent> &events)
+{
+  bool sinkOpen = sink != NULL && sink->isOpen();
+  bool storeOpen = store != NULL && store->isOpen();
+  bool tableOpen = table != NULL && table->isOpen();
+  batch.set(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    const TransportSample &sample = samples[i];
+    uint32_t sensor = registry.find(sample.id);
+    if (sensor == SENSOR_NONE)
+    {
+      if (registry.size() >= max_sensors)
+      {
+        shed.add();
+        continue;
+      }
+      sensor = registry.intern(sample.id);
+    }
+    if (sinkOpen)
+    {
+      sink->write(topic.c_str(), sample.id, sample.timestamp, sample.value);
+    }
+    received.add();
+    latency.observe(now > sample.timestamp ? (now - sample.timestamp) / 1000.0 : 0.0);
+    if (storeOpen)
+    {
+      store->append(sample.id, sample.timestamp, sample.value);
+    }
+    if (tableOpen)
+    {
+      table->write(sample, sensor, now);
+    }
+    if (tracker != NULL)
+    {
+      tracker->touch(sensor, now, events);
+    }
+    if (detector != NULL)
+    {
+      batch_sensors.push_back(sensor);
+      batch_times.push_back(sample.timestamp);
+      batch_values.push_back(sample.value);
+    }
+  }
+
+  if (!batch_sensors.empty())
+  {
+    detector->process(&batch_sensors[0], &batch_times[0], &batch_values[0], batch_sensors.size(), alerts);
+    batch_sensors.clear();
+    batch_times.clear();
+    batch_values.clear();
+  }
+}
+
+void SensorPipeline::advance(int64_t now, std::vector<LivenessEvent> &events)
+{
+  if (tracker != NULL)
+  {
+    tracker->advance(now, events);
+  }
+}
+
+size_t SensorPipeline::memoryUsage() const
+{
+  return memoryOf(batch_sensors) + memoryOf(batch_times) + memoryOf(batch_values);
+}
@@ -0,0 +1,94 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorPipeline.h
+ * FUNCTION:        Processing of the readings of one topic.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the processing the subscriber runs
+ * on every batch taken from a transport reader:
+ * - the sample counter and latency histogram of the topic
+ * - the sensor registry, which turns the id into the dense number the
+ *   later stages index their per sensor state by
+ * - the output sink and the series store, when open
+ * - the liveness tracker, the anomaly detector and the shared memory
+ *   sensor table, when given
+ *
+ * With a sensor limit set, readings of sensors beyond the limit that
+ * were not seen before are dropped and counted before they are interned,
+ * so the per sensor state stays bounded.
+ *
+ * It does not publish anything: the alerts and liveness changes are
+ * returned to the caller, so the same processing runs on any transport.
+ *
+ ***/
+
+#ifndef __SENSORPIPELINE_H__
+  #define __SENSORPIPELINE_H__
+
+  #include <stdint.h>
+  #include <string>
+  #include <vector>
+  #include "Transport.h"
+  #include "SensorRegistry.h"
+  #include "OutputSink.h"
+  #include "SeriesStore.h"
+  #include "AnomalyDetector.h"
+  #include "LivenessTracker.h"
+  #include "SensorTableWriter.h"
+  #include "Metrics.h"
+
+  class SensorPipeline
+  {
+      std::string topic;
+      SensorRegistry &registry;
+      OutputSink *sink;
+      SeriesStore *store;
+      AnomalyDetector *detector;
+      LivenessTracker *tracker;
+      SensorTableWriter *table;
+
+      Counter &received;
+      Histogram &latency;
+      Gauge &batch;
+      Counter &shed;
+
+      size_t max_sensors;
+
+      /* Detector input, kept to avoid reallocating per batch. */
+      std::vector<uint32_t> batch_sensors;
+      std::vector<int64_t>  batch_times;
+      std::vector<float>    batch_values;
+    public:
+      /**
+       * The registry and the stages are not owned; a NULL stage is
+       * skipped. Pipelines sharing stages must share the registry.
+       **/
+      SensorPipeline(const char *topic, SensorRegistry &registry, OutputSink *sink, SeriesStore *store,
+        AnomalyDetector *detector, LivenessTracker *tracker, SensorTableWriter *table = NULL);
+
+      /**
+       * Runs count samples taken at now (ms) through every stage. Appends
+       * the anomalies found to alerts and the sensors that recovered to
+       * events.
+       **/
+      void process(const TransportSample *samples, size_t count, int64_t now,
+        std::vector<AnomalyAlert> &alerts, std::vector<LivenessEvent> &events);
+
+      /**
+       * Moves the liveness tracker to now, appending the sensors that went
+       * stale to events.
+       **/
+      void advance(int64_t now, std::vector<LivenessEvent> &events);
+
+      /**
+       * Interns at most maxSensors distinct sensors in the registry from
+       * now on; the ones already interned stay.
+       **/
+      void setSensorLimit(size_t maxSensors) { max_sensors = maxSensors; }
+      size_t sensors() const { return registry.size(); }
+      size_t memoryUsage() const;
+  };
+
+#endif
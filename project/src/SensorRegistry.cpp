@@ -0,0 +1,186 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorRegistry.cpp
+ * FUNCTION:        Interning of the sensor ids.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the sensor registry.
+ *
+ ***/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SensorRegistry.h"
+#include "Checkpoint.h"
+#include "MemoryUsage.h"
+
+#define REGISTRY_INITIAL_SLOTS  256
+
+SensorRegistry::SensorRegistry() : table(REGISTRY_INITIAL_SLOTS, 0), mask(REGISTRY_INITIAL_SLOTS - 1)
+{
+}
+
+/**
+ * FNV-1a of the id.
+ **/
+uint32_t SensorRegistry::hash(const char *id)
+{
+  uint32_t h = 2166136261u;
+  for (const unsigned char *p = (const unsigned char *)id; *p != 0; p++)
+  {
+    h = (h ^ *p) * 16777619u;
+  }
+  return h;
+}
+
+/**
+ * Slot holding id, or the empty slot where it would go.
+ **/
+size_t SensorRegistry::probe(const char *id, uint32_t hash) const
+{
+  size_t at = hash & mask;
+  while (table[at] != 0)
+  {
+    if ((uint32_t)(table[at] >> 32) == hash)
+    {
+      uint32_t sensor = (uint32_t)table[at] - 1;
+      if (strcmp(names[sensor].id.c_str(), id) == 0)
+      {
+        return at;
+      }
+    }
+    at = (at + 1) & mask;
+  }
+  return at;
+}
+
+uint32_t SensorRegistry::find(const char *id) const
+{
+  uint64_t entry = table[probe(id, hash(id))];
+  return entry != 0 ? (uint32_t)entry - 1 : SENSOR_NONE;
+}
+
+uint32_t SensorRegistry::intern(const char *id)
+{
+  uint32_t h = hash(id);
+  size_t at = probe(id, h);
+  if (table[at] != 0)
+  {
+    return (uint32_t)table[at] - 1;
+  }
+
+  uint32_t sensor = (uint32_t)names.size();
+  names.push_back(SensorName());
+  parse(id, names.back());
+  hashes.push_back(h);
+  table[at] = ((uint64_t)h << 32) | (sensor + 1);
+  if (names.size() * 2 > table.size())
+  {
+    grow();
+  }
+  return sensor;
+}
+
+/**
+ * Doubles the table, reinserting from the kept hashes.
+ **/
+void SensorRegistry::grow()
+{
+  table.assign(table.size() * 2, 0);
+  mask = (uint32_t)table.size() - 1;
+  for (uint32_t sensor = 0; sensor < hashes.size(); sensor++)
+  {
+    size_t at = hashes[sensor] & mask;
+    while (table[at] != 0)
+    {
+      at = (at + 1) & mask;
+    }
+    table[at] = ((uint64_t)hashes[sensor] << 32) | (sensor + 1);
+  }
+}
+
+size_t SensorRegistry::memoryUsage() const
+{
+  size_t bytes = memoryOf(table) + memoryOf(hashes) + names.capacity() * sizeof(SensorName);
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    bytes += memoryOf(names[i].id) + memoryOf(names[i].machine) + memoryOf(names[i].node) +
+      memoryOf(names[i].type);
+  }
+  return bytes;
+}
+
+/**
+ * Reads "<machine>N<node>S<index><type>" from the end: the type letters,
+ * the index digits after an 'S' and the node up to the last 'N' before.
+ **/
+bool SensorRegistry::parse(const char *id, SensorName &name)
+{
+  name.id = id;
+  name.machine.clear();
+  name.node.clear();
+  name.type.clear();
+  name.index = -1;
+
+  size_t length = strlen(id);
+  size_t type = length;
+  while (type > 0 && isalpha((unsigned char)id[type - 1]))
+  {
+    type--;
+  }
+  size_t digits = type;
+  while (digits > 0 && isdigit((unsigned char)id[digits - 1]))
+  {
+    digits--;
+  }
+  if (digits == type || digits == 0 || id[digits - 1] != 'S' || type - digits > 9)
+  {
+    return false;
+  }
+  size_t separator = digits - 1;
+  size_t node = separator;
+  while (node > 0 && id[node - 1] != 'N')
+  {
+    node--;
+  }
+  if (node == 0 || node == separator)
+  {
+    return false;
+  }
+
+  name.machine.assign(id, node - 1);
+  name.node.assign(id + node, separator - node);
+  name.index = (int32_t)strtol(id + digits, NULL, 10);
+  name.type.assign(id + type, length - type);
+  return true;
+}
+
+void SensorRegistry::save(CheckpointWriter &out) const
+{
+  out.put((uint32_t)names.size());
+  for (size_t sensor = 0; sensor < names.size(); sensor++)
+  {
+    out.putString(names[sensor].id);
+  }
+}
+
+bool SensorRegistry::restore(CheckpointReader &in)
+{
+  uint32_t count;
+  if (!names.empty() || !in.get(count))
+  {
+    return false;
+  }
+  std::string id;
+  for (uint32_t sensor = 0; sensor < count; sensor++)
+  {
+    if (!in.getString(id) || intern(id.c_str()) != sensor)
+    {
+      return false;
+    }
+  }
+  return in.done();
+}
@@ -0,0 +1,92 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorRegistry.h
+ * FUNCTION:        Interning of the sensor ids.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the sensor registry of the
+ * subscriber. The readings carry their sensor as a string such as
+ * "hostN3S1tem"; the registry maps each distinct id to a dense number
+ * 0, 1, 2, ... once, so the stages after it index flat per sensor arrays
+ * instead of hashing and comparing strings on every sample.
+ *
+ * The lookup is an open addressing table with linear probing: one 64 bit
+ * entry per slot holding the hash of the id and its number, kept at most
+ * half full, so a probe rarely leaves its cache line and the id itself is
+ * only compared on a hash match.
+ *
+ * On first sight the id is also split into the parts create_id() of the
+ * edge node puts together, "<machine>N<node>S<index><type>". Ids that do
+ * not follow it keep an empty node and type and an index of -1.
+ *
+ ***/
+
+#ifndef __SENSORREGISTRY_H__
+  #define __SENSORREGISTRY_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <string>
+  #include <vector>
+
+  #define SENSOR_NONE  0xffffffffu
+
+  class CheckpointWriter;
+  class CheckpointReader;
+
+  struct SensorName
+  {
+      std::string id;
+      std::string machine;
+      std::string node;
+      int32_t     index;        /* -1 when the id does not parse */
+      std::string type;
+  };
+
+  class SensorRegistry
+  {
+      std::vector<uint64_t> table;      /* hash << 32 | sensor + 1, 0 empty */
+      std::vector<uint32_t> hashes;
+      std::vector<SensorName> names;
+      uint32_t mask;
+
+      void grow();
+      size_t probe(const char *id, uint32_t hash) const;
+    public:
+      SensorRegistry();
+
+      /**
+       * Number of id, adding it on first use.
+       **/
+      uint32_t intern(const char *id);
+
+      /**
+       * Number of id, SENSOR_NONE if it was never interned.
+       **/
+      uint32_t find(const char *id) const;
+
+      const std::string &id(uint32_t sensor) const { return names[sensor].id; }
+      const SensorName &name(uint32_t sensor) const { return names[sensor]; }
+      size_t size() const { return names.size(); }
+      size_t memoryUsage() const;
+
+      /**
+       * Saves the ids in number order (see Checkpoint.h). restore() interns
+       * them into an empty registry, so they get their numbers back; it
+       * returns false for a malformed section or a registry in use.
+       **/
+      void save(CheckpointWriter &out) const;
+      bool restore(CheckpointReader &in);
+
+      static uint32_t hash(const char *id);
+
+      /**
+       * Splits id into name; returns false when it does not follow the
+       * edge node format, leaving only name.id set.
+       **/
+      static bool parse(const char *id, SensorName &name);
+  };
+
+#endif
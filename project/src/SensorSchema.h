@@ -0,0 +1,107 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorSchema.h
+ * FUNCTION:        Compile time table of the sensor kinds.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the one place the sensor kinds of an edge node are
+ * listed. Each kind has the topic its readings go to, the suffix that
+ * ends the ids of its sensors ("<machine>N<node>S<index><suffix>", see
+ * SensorRegistry.h) and the type string of its samples; the index of a
+ * sensor on its node is the position of its kind in the table.
+ *
+ * The table is constexpr, so its checks run at compile time, and
+ * SensorKinds<>::forEach() calls a function once per kind through
+ * templates the compiler fully unrolls: the loop over the kinds in a
+ * publisher costs no branch and no index bounds.
+ *
+ *   SensorKinds<>::forEach([&](int kind) {
+ *       publish(writers[kind], SENSOR_KINDS[kind].topic);
+ *   });
+ *
+ * Adding a kind is one line in SensorKindId and one in SENSOR_KINDS.
+ *
+ ***/
+
+#ifndef __SENSORSCHEMA_H__
+  #define __SENSORSCHEMA_H__
+
+  #include <stddef.h>
+  #include <string>
+
+  enum SensorKindId
+  {
+      SENSOR_HUMIDITY,
+      SENSOR_TEMPERATURE,
+      SENSOR_RAIN,
+      SENSOR_KIND_COUNT
+  };
+
+  struct SensorKind
+  {
+      const char *topic;
+      const char *suffix;       /* ends the sensor ids of the kind */
+      const char *type;         /* Environmental::type */
+  };
+
+  constexpr SensorKind SENSOR_KINDS[] =
+  {
+      { "humidity",    "hum", "humidity sensor" },
+      { "temperature", "tem", "temperature sensor" },
+      { "rain",        "rai", "rain sensor" }
+  };
+
+  static_assert(sizeof(SENSOR_KINDS) / sizeof(SENSOR_KINDS[0]) == SENSOR_KIND_COUNT,
+    "SENSOR_KINDS must list every SensorKindId");
+
+  /* Ids are parsed back from the end, so a suffix must be letters only. */
+  constexpr bool sensorSuffixValid(const char *suffix)
+  {
+    return *suffix == 0 ||
+      (((*suffix >= 'a' && *suffix <= 'z') || (*suffix >= 'A' && *suffix <= 'Z')) &&
+       sensorSuffixValid(suffix + 1));
+  }
+
+  constexpr bool sensorKindsValid(int kind = 0)
+  {
+    return kind == SENSOR_KIND_COUNT ||
+      (SENSOR_KINDS[kind].suffix[0] != 0 && sensorSuffixValid(SENSOR_KINDS[kind].suffix) &&
+       sensorKindsValid(kind + 1));
+  }
+
+  static_assert(sensorKindsValid(), "sensor id suffixes must be non empty and letters only");
+
+  /**
+   * Calls f(kind) for every kind, unrolled at compile time.
+   **/
+  template <int K = 0> struct SensorKinds
+  {
+      template <typename F> static inline void forEach(F &&f)
+      {
+          f(K);
+          SensorKinds<K + 1>::forEach(f);
+      }
+  };
+
+  template <> struct SensorKinds<SENSOR_KIND_COUNT>
+  {
+      template <typename F> static inline void forEach(F &&) {}
+  };
+
+  /**
+   * The topics of every kind as a comma separated list, the default of
+   * the --topics options.
+   **/
+  inline std::string sensorKindTopics()
+  {
+    std::string topics;
+    SensorKinds<>::forEach([&topics](int kind) {
+        topics += (topics.empty() ? "" : ",");
+        topics += SENSOR_KINDS[kind].topic;
+    });
+    return topics;
+  }
+
+#endif
@@ -0,0 +1,238 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorTable.h
+ * FUNCTION:        Latest reading per sensor in shared memory.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the layout of the shared memory table c2 keeps with
+ * "--table <name>" and the header-only client to read it. Include this
+ * file and link with -lrt (older glibc); no DDS is needed.
+ *
+ * The table is a POSIX shared memory object of a header and a power of
+ * two number of fixed slots, open addressed on the FNV-1a hash of the
+ * sensor id with linear probing. c2 is the only writer; a slot gets its
+ * id once and is never freed, and it is filled under a sequence lock:
+ * the sequence is odd while the slot is written. A reader copies the
+ * slot and keeps the copy when the sequence was even and unchanged, so
+ * it never blocks the writer and never sees a torn reading. It retries
+ * at most SENSOR_TABLE_RETRIES times and gives up while the writer keeps
+ * rewriting the same slot.
+ *
+ *   SensorTableReader table;
+ *   if (table.open("/stack_sensors"))
+ *   {
+ *     SensorReading reading;
+ *     if (table.read("node1-humidity", reading) == SENSOR_TABLE_OK) ...
+ *   }
+ *
+ ***/
+
+#ifndef __SENSORTABLE_H__
+  #define __SENSORTABLE_H__
+
+  #include <fcntl.h>
+  #include <stdint.h>
+  #include <string.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <atomic>
+
+  #define SENSOR_TABLE_MAGIC    "STKTAB1"
+  #define SENSOR_TABLE_ID_SIZE  51     /* string<50> of the IDL plus the terminator */
+  #define SENSOR_TABLE_RETRIES  64
+
+  struct SensorTableHeader
+  {
+      char     magic[8];
+      uint32_t capacity;                /* slots, a power of two */
+      uint32_t slot_size;
+      int64_t  generation;              /* start time of the writer (ms) */
+      std::atomic<uint32_t> count;      /* slots in use */
+      std::atomic<uint32_t> closed;     /* set when the writer exits */
+      std::atomic<uint64_t> dropped;    /* sensors that did not fit */
+      char     pad[24];
+  };
+
+  struct SensorTableSlot
+  {
+      std::atomic<uint32_t> sequence;   /* 0: empty, odd: being written */
+      float    value;
+      int64_t  timestamp;               /* source timestamp (ms) */
+      int64_t  updated;                 /* when c2 took it (ms) */
+      char     id[SENSOR_TABLE_ID_SIZE];
+      char     type[SENSOR_TABLE_ID_SIZE];
+      char     pad[128 - 24 - 2 * SENSOR_TABLE_ID_SIZE];
+  };
+
+  struct SensorReading
+  {
+      char    id[SENSOR_TABLE_ID_SIZE];
+      char    type[SENSOR_TABLE_ID_SIZE];
+      float   value;
+      int64_t timestamp;
+      int64_t updated;
+  };
+
+  enum SensorTableStatus
+  {
+      SENSOR_TABLE_OK,
+      SENSOR_TABLE_MISSING,             /* no reading for that id */
+      SENSOR_TABLE_BUSY                 /* the slot kept changing, try again */
+  };
+
+  inline uint32_t sensorTableHash(const char *id)
+  {
+    uint32_t hash = 2166136261u;
+    for (; *id != '\0'; id++)
+    {
+      hash = (hash ^ (uint8_t)*id) * 16777619u;
+    }
+    return hash;
+  }
+
+  inline size_t sensorTableBytes(uint32_t capacity)
+  {
+    return sizeof(SensorTableHeader) + (size_t)capacity * sizeof(SensorTableSlot);
+  }
+
+  inline SensorTableSlot *sensorTableSlots(SensorTableHeader *header)
+  {
+    return (SensorTableSlot *)(header + 1);
+  }
+
+  class SensorTableReader
+  {
+      SensorTableHeader *header;
+      size_t size;
+
+      /**
+       * Copies slot into reading under its sequence lock.
+       **/
+      SensorTableStatus copy(const SensorTableSlot &slot, SensorReading &reading) const
+      {
+        for (int attempt = 0; attempt < SENSOR_TABLE_RETRIES; attempt++)
+        {
+          uint32_t before = slot.sequence.load(std::memory_order_acquire);
+          if (before == 0)
+          {
+            return SENSOR_TABLE_MISSING;
+          }
+          if (before & 1)
+          {
+            continue;
+          }
+          memcpy(reading.id, slot.id, sizeof(reading.id));
+          memcpy(reading.type, slot.type, sizeof(reading.type));
+          reading.value = slot.value;
+          reading.timestamp = slot.timestamp;
+          reading.updated = slot.updated;
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (slot.sequence.load(std::memory_order_relaxed) == before)
+          {
+            reading.id[SENSOR_TABLE_ID_SIZE - 1] = '\0';
+            reading.type[SENSOR_TABLE_ID_SIZE - 1] = '\0';
+            return SENSOR_TABLE_OK;
+          }
+        }
+        return SENSOR_TABLE_BUSY;
+      }
+    public:
+      SensorTableReader() : header(NULL), size(0) {}
+      ~SensorTableReader() { close(); }
+
+      /**
+       * Maps the table read only. Returns false when it does not exist or
+       * is not a sensor table.
+       **/
+      bool open(const char *name)
+      {
+        close();
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+        {
+          return false;
+        }
+        struct stat info;
+        void *map = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(SensorTableHeader))
+        {
+          map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (map == MAP_FAILED)
+        {
+          return false;
+        }
+        header = (SensorTableHeader *)map;
+        size = (size_t)info.st_size;
+        if (memcmp(header->magic, SENSOR_TABLE_MAGIC, sizeof(SENSOR_TABLE_MAGIC)) != 0 ||
+            header->slot_size != sizeof(SensorTableSlot) || sensorTableBytes(header->capacity) > size)
+        {
+          close();
+          return false;
+        }
+        return true;
+      }
+
+      void close()
+      {
+        if (header != NULL)
+        {
+          munmap(header, size);
+          header = NULL;
+          size = 0;
+        }
+      }
+
+      bool isOpen() const { return header != NULL; }
+
+      /**
+       * False once the writer exited; reopen to follow a new one.
+       **/
+      bool isLive() const { return header != NULL && header->closed.load(std::memory_order_acquire) == 0; }
+      int64_t generation() const { return header->generation; }
+      uint32_t count() const { return header->count.load(std::memory_order_acquire); }
+      uint32_t capacity() const { return header->capacity; }
+
+      SensorTableStatus read(const char *id, SensorReading &reading) const
+      {
+        const SensorTableSlot *slots = sensorTableSlots(header);
+        uint32_t mask = header->capacity - 1;
+        for (uint32_t i = 0, at = sensorTableHash(id) & mask; i < header->capacity; i++, at = (at + 1) & mask)
+        {
+          /* The id of a slot is written once, with its first reading. */
+          uint32_t sequence = slots[at].sequence.load(std::memory_order_acquire);
+          if (sequence == 0)
+          {
+            return SENSOR_TABLE_MISSING;
+          }
+          if (sequence >= 2 && strncmp(slots[at].id, id, SENSOR_TABLE_ID_SIZE) == 0)
+          {
+            return copy(slots[at], reading);
+          }
+        }
+        return SENSOR_TABLE_MISSING;
+      }
+
+      /**
+       * Calls visit(const SensorReading &) for every sensor. Slots that
+       * kept changing are skipped.
+       **/
+      template <typename Visitor> void forEach(Visitor visit) const
+      {
+        const SensorTableSlot *slots = sensorTableSlots(header);
+        SensorReading reading;
+        for (uint32_t i = 0; i < header->capacity; i++)
+        {
+          if (copy(slots[i], reading) == SENSOR_TABLE_OK)
+          {
+            visit(reading);
+          }
+        }
+      }
+  };
+
+#endif
@@ -0,0 +1,186 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorTableWriter.cpp
+ * FUNCTION:        Latest reading per sensor in shared memory.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the writer side of the
+ * shared memory sensor table.
+ *
+ ***/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include "SensorTableWriter.h"
+#include "Checkpoint.h"
+
+SensorTableWriter::SensorTableWriter()
+  : header(NULL), slots(NULL), mask(0), limit(0), filled(0)
+{
+}
+
+SensorTableWriter::~SensorTableWriter()
+{
+  close();
+}
+
+void SensorTableWriter::open(const char *tableName, uint32_t capacity)
+{
+  uint32_t size = 64;
+  while (size < capacity + capacity / 3)
+  {
+    size <<= 1;
+  }
+  size_t bytes = sensorTableBytes(size);
+
+  /* A table left by a writer that did not exit cleanly is replaced. */
+  shm_unlink(tableName);
+  int fd = shm_open(tableName, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0)
+  {
+    std::cerr << "Error in SensorTableWriter::open: cannot create " << tableName << ": "
+              << strerror(errno) << std::endl;
+    exit(1);
+  }
+  void *map = MAP_FAILED;
+  if (ftruncate(fd, (off_t)bytes) == 0)
+  {
+    map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  ::close(fd);
+  if (map == MAP_FAILED)
+  {
+    std::cerr << "Error in SensorTableWriter::open: cannot map " << tableName << ": "
+              << strerror(errno) << std::endl;
+    shm_unlink(tableName);
+    exit(1);
+  }
+
+  /* The object comes zeroed: every slot is empty. The magic goes last so
+   * a reader never accepts a half initialized header. */
+  name = tableName;
+  header = (SensorTableHeader *)map;
+  slots = sensorTableSlots(header);
+  mask = size - 1;
+  limit = size / 4 * 3;
+  header->capacity = size;
+  header->slot_size = sizeof(SensorTableSlot);
+  header->generation = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(header->magic, SENSOR_TABLE_MAGIC, sizeof(SENSOR_TABLE_MAGIC));
+  std::cout << "=== [SensorTable] Latest readings in shared memory " << name << " ("
+            << size << " slots)" << std::endl;
+}
+
+void SensorTableWriter::close()
+{
+  if (header == NULL)
+  {
+    return;
+  }
+  header->closed.store(1, std::memory_order_release);
+  munmap(header, sensorTableBytes(mask + 1));
+  shm_unlink(name.c_str());
+  header = NULL;
+  slots = NULL;
+  index.clear();
+  filled = 0;
+}
+
+/**
+ * Slot of id, claimed on first use. NULL when the table is full.
+ **/
+SensorTableSlot *SensorTableWriter::slot(const char *id, uint32_t sensor)
+{
+  if (sensor >= index.size())
+  {
+    index.resize((size_t)sensor + 1, SENSOR_NONE);
+  }
+  if (index[sensor] != SENSOR_NONE)
+  {
+    return &slots[index[sensor]];
+  }
+  if (filled >= limit)
+  {
+    header->dropped.fetch_add(1, std::memory_order_relaxed);
+    return NULL;
+  }
+
+  /* Ids are only added, so the first empty slot of the probe is free. */
+  uint32_t at = sensorTableHash(id) & mask;
+  while (slots[at].sequence.load(std::memory_order_relaxed) != 0)
+  {
+    at = (at + 1) & mask;
+  }
+  index[sensor] = at;
+  header->count.store(++filled, std::memory_order_release);
+  return &slots[at];
+}
+
+void SensorTableWriter::write(const TransportSample &sample, uint32_t sensor, int64_t now)
+{
+  SensorTableSlot *target = slot(sample.id, sensor);
+  if (target == NULL)
+  {
+    return;
+  }
+  uint32_t sequence = target->sequence.load(std::memory_order_relaxed);
+  target->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  if (sequence == 0)
+  {
+    memcpy(target->id, sample.id, sizeof(target->id));
+  }
+  memcpy(target->type, sample.type, sizeof(target->type));
+  target->value = sample.value;
+  target->timestamp = sample.timestamp;
+  target->updated = now;
+  target->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void SensorTableWriter::save(CheckpointWriter &out) const
+{
+  out.put(filled);
+  for (uint32_t sensor = 0; sensor < index.size(); sensor++)
+  {
+    if (index[sensor] == SENSOR_NONE)
+    {
+      continue;
+    }
+    const SensorTableSlot &from = slots[index[sensor]];
+    out.put(sensor);
+    out.put(from.value);
+    out.put(from.timestamp);
+    out.put(from.updated);
+    out.put(from.type, sizeof(from.type));
+  }
+}
+
+bool SensorTableWriter::restore(CheckpointReader &in, const SensorRegistry &registry)
+{
+  uint32_t count;
+  if (!in.get(count))
+  {
+    return false;
+  }
+  TransportSample sample;
+  for (uint32_t i = 0; i < count; i++)
+  {
+    uint32_t sensor;
+    int64_t updated;
+    if (!in.get(sensor) || !in.get(sample.value) || !in.get(sample.timestamp) || !in.get(updated) ||
+        !in.get(sample.type, SENSOR_TABLE_ID_SIZE) || sensor >= registry.size())
+    {
+      return false;
+    }
+    sample.type[SENSOR_TABLE_ID_SIZE - 1] = 0;
+    transportCopy(sample.id, registry.id(sensor).c_str());
+    write(sample, sensor, updated);
+  }
+  return in.done();
+}
@@ -0,0 +1,70 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SensorTableWriter.h
+ * FUNCTION:        Latest reading per sensor in shared memory.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the writer side of the shared
+ * memory sensor table (see SensorTable.h for the layout and the client).
+ * There is one writer per table; it creates the shared memory object on
+ * open and removes its name on close, so readers still mapping it keep
+ * the last readings and see it closed.
+ *
+ ***/
+
+#ifndef __SENSORTABLEWRITER_H__
+  #define __SENSORTABLEWRITER_H__
+
+  #include <string>
+  #include <vector>
+  #include "SensorTable.h"
+  #include "SensorRegistry.h"
+  #include "Transport.h"
+
+  class SensorTableWriter
+  {
+      std::string name;
+      SensorTableHeader *header;
+      SensorTableSlot *slots;
+      uint32_t mask;
+      uint32_t limit;           /* slots filled at most, to keep probes short */
+
+      /* Slot of every sensor written by registry number, so updates skip
+       * the probing. */
+      std::vector<uint32_t> index;
+      uint32_t filled;
+
+      SensorTableSlot *slot(const char *id, uint32_t sensor);
+    public:
+      SensorTableWriter();
+      ~SensorTableWriter();
+
+      /**
+       * Creates the table name ("/name") with room for capacity sensors
+       * (rounded up to a power of two, the table is kept under 3/4 full).
+       **/
+      void open(const char *name, uint32_t capacity = 4096);
+      void close();
+      bool isOpen() const { return header != NULL; }
+
+      /**
+       * Stores the reading of sample, taken at now (ms); sensor is its
+       * number in the SensorRegistry. A new sensor that does not fit is
+       * counted in the header and dropped.
+       **/
+      void write(const TransportSample &sample, uint32_t sensor, int64_t now);
+      uint32_t count() const { return header->count.load(std::memory_order_relaxed); }
+
+      /**
+       * Saves the latest reading of every sensor written (see
+       * Checkpoint.h). restore() writes them back into the open table,
+       * taking the ids from registry; it returns false for a malformed
+       * section or a sensor registry does not know.
+       **/
+      void save(CheckpointWriter &out) const;
+      bool restore(CheckpointReader &in, const SensorRegistry &registry);
+  };
+
+#endif
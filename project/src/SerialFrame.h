@@ -0,0 +1,103 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SerialFrame.h
+ * FUNCTION:        Framing of the serial sensor board replies.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for reading the replies of the sensor
+ * board on the serial port. A reply is SERIAL_FRAME_BYTES long:
+ *
+ *   0       STX (0x02)
+ *   1..20   body; big endian 16 bit counts at 9 (temperature),
+ *           11 (humidity) and 19 (rain), see Calibration.h for their
+ *           conversion
+ *   21..22  CRC-16/CCITT (0x1021, initial 0xffff) of the body, big endian
+ *   23      ETX (0x03)
+ *
+ * The parser is a resynchronising state machine fed with whatever the
+ * port returned. Bytes outside a frame are skipped up to the next STX; a
+ * frame with a bad ETX or CRC is dropped and the search restarts at the
+ * byte after its STX, so a frame starting inside the bad one is still
+ * found. Frames whole in the input are validated in place, the others
+ * gathered in a frame buffer. ETX is checked before the table driven CRC,
+ * so most misaligned candidates cost one compare.
+ *
+ ***/
+
+#ifndef __SERIALFRAME_H__
+  #define __SERIALFRAME_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <vector>
+
+  #define SERIAL_STX            0x02
+  #define SERIAL_ETX            0x03
+  #define SERIAL_FRAME_BYTES    24
+  #define SERIAL_BODY_BYTES     20
+  #define SERIAL_CRC_OFFSET     21
+  #define SERIAL_TEMPERATURE    9
+  #define SERIAL_HUMIDITY       11
+  #define SERIAL_RAIN           19
+  #define SERIAL_REQUEST_BYTES  11
+
+  /* The request that makes the board send one reply. */
+  extern const uint8_t SERIAL_REQUEST[SERIAL_REQUEST_BYTES];
+
+  struct SerialReading
+  {
+      uint16_t temperature;     /* raw counts */
+      uint16_t humidity;
+      uint16_t rain;
+
+      /**
+       * The count of a SensorKindId (see SensorSchema.h).
+       **/
+      uint16_t raw(int kind) const;
+  };
+
+  uint16_t serialCrc16(const uint8_t *data, size_t count);
+
+  /**
+   * Writes the frame of reading to frame[SERIAL_FRAME_BYTES].
+   **/
+  void serialEncode(const SerialReading &reading, uint8_t *frame);
+
+  class SerialFrameParser
+  {
+      uint8_t frame[SERIAL_FRAME_BYTES];
+      size_t fill;
+      uint64_t frames;
+      uint64_t crc_errors;
+      uint64_t framing_errors;
+      uint64_t skipped;
+
+      bool accept(const uint8_t *candidate, std::vector<SerialReading> &out);
+    public:
+      SerialFrameParser();
+
+      /**
+       * Parses count bytes, appending the valid frames to out. Returns the
+       * number of frames appended.
+       **/
+      size_t feed(const uint8_t *data, size_t count, std::vector<SerialReading> &out);
+
+      /**
+       * Drops a partial frame, e.g. after a port timeout.
+       **/
+      void reset() { fill = 0; }
+
+      uint64_t frameCount() const { return frames; }
+      uint64_t crcErrors() const { return crc_errors; }
+      uint64_t framingErrors() const { return framing_errors; }
+
+      /**
+       * Bytes dropped while looking for a frame, those of bad frames
+       * included.
+       **/
+      uint64_t skippedBytes() const { return skipped; }
+  };
+
+#endif
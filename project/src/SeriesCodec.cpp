@@ -0,0 +1,368 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesCodec.cpp
+ * FUNCTION:        Compressed encoding of sensor time series.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the series codec.
+ *
+ * Timestamp control codes (delta of delta, milliseconds). The buckets are
+ * narrower than Gorilla's because a 10 Hz sleep loop jitters by a few ms:
+ *   0                  dod == 0
+ *   10   + 4 bits      dod in [-7, 8]
+ *   110  + 7 bits      dod in [-63, 64]
+ *   1110 + 12 bits     dod in [-2047, 2048]
+ *   1111 + 64 bits     anything else
+ *
+ * Value control codes (XOR with the previous float):
+ *   0                  same value
+ *   10   + n bits      meaningful bits fit the previous window
+ *   11   + 5 bits leading zeros + 5 bits (length - 1) + length bits
+ *
+ ***/
+
+#include <string.h>
+#include "SeriesCodec.h"
+
+static inline uint32_t floatBits(float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static inline float bitsFloat(uint32_t bits)
+{
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SeriesEncoder::SeriesEncoder()
+{
+  reset();
+}
+
+void SeriesEncoder::reset()
+{
+  payload.clear();
+  bit_buffer = 0;
+  bit_count = 0;
+  sample_count = 0;
+  first_timestamp = 0;
+  last_timestamp = 0;
+  last_delta = 0;
+  last_bits = 0;
+  last_leading = 32;
+  last_trailing = 0;
+  min_value = 0;
+  max_value = 0;
+}
+
+void SeriesEncoder::writeBits(uint64_t value, unsigned count)
+{
+  if (count > 32)
+  {
+    writeBits(value >> 32, count - 32);
+    count = 32;
+  }
+  bit_buffer = (bit_buffer << count) | (value & ((1ULL << count) - 1));
+  bit_count += count;
+  while (bit_count >= 8)
+  {
+    bit_count -= 8;
+    payload.push_back((uint8_t)(bit_buffer >> bit_count));
+  }
+}
+
+void SeriesEncoder::writeTimestamp(int64_t timestamp)
+{
+  int64_t delta = timestamp - last_timestamp;
+  int64_t dod = delta - last_delta;
+
+  if (dod == 0)
+  {
+    writeBits(0x0, 1);
+  }
+  else if (dod >= -7 && dod <= 8)
+  {
+    writeBits(0x2, 2);
+    writeBits((uint64_t)(dod + 7), 4);
+  }
+  else if (dod >= -63 && dod <= 64)
+  {
+    writeBits(0x6, 3);
+    writeBits((uint64_t)(dod + 63), 7);
+  }
+  else if (dod >= -2047 && dod <= 2048)
+  {
+    writeBits(0xe, 4);
+    writeBits((uint64_t)(dod + 2047), 12);
+  }
+  else
+  {
+    writeBits(0xf, 4);
+    writeBits((uint64_t)dod, 64);
+  }
+  last_delta = delta;
+}
+
+void SeriesEncoder::writeValue(uint32_t bits)
+{
+  uint32_t xored = bits ^ last_bits;
+
+  if (xored == 0)
+  {
+    writeBits(0x0, 1);
+    return;
+  }
+
+  unsigned leading = __builtin_clz(xored);
+  unsigned trailing = __builtin_ctz(xored);
+
+  if (last_leading < 32 && leading >= last_leading && trailing >= last_trailing)
+  {
+    writeBits(0x2, 2);
+    writeBits(xored >> last_trailing, 32 - last_leading - last_trailing);
+  }
+  else
+  {
+    unsigned length = 32 - leading - trailing;
+    writeBits(0x3, 2);
+    writeBits(leading, 5);
+    writeBits(length - 1, 5);
+    writeBits(xored >> trailing, length);
+    last_leading = leading;
+    last_trailing = trailing;
+  }
+  last_bits = bits;
+}
+
+void SeriesEncoder::append(int64_t timestamp, float value)
+{
+  uint32_t bits = floatBits(value);
+
+  if (sample_count == 0)
+  {
+    writeBits((uint64_t)timestamp, 64);
+    writeBits(bits, 32);
+    first_timestamp = timestamp;
+    last_bits = bits;
+    min_value = value;
+    max_value = value;
+  }
+  else
+  {
+    writeTimestamp(timestamp);
+    writeValue(bits);
+    if (value < min_value)
+    {
+      min_value = value;
+    }
+    if (value > max_value)
+    {
+      max_value = value;
+    }
+  }
+  last_timestamp = timestamp;
+  sample_count++;
+}
+
+size_t SeriesEncoder::encodedBytes() const
+{
+  return sizeof(SeriesBlockHeader) + payload.size() + (bit_count ? 1 : 0);
+}
+
+void SeriesEncoder::finish(const std::string &id, std::vector<uint8_t> &out)
+{
+  if (bit_count)
+  {
+    payload.push_back((uint8_t)(bit_buffer << (8 - bit_count)));
+    bit_count = 0;
+  }
+
+  SeriesBlockHeader header;
+  header.magic = SERIES_BLOCK_MAGIC;
+  header.version = SERIES_BLOCK_VERSION;
+  header.id_length = (uint16_t)id.size();
+  header.sample_count = sample_count;
+  header.payload_bytes = (uint32_t)payload.size();
+  header.first_timestamp = first_timestamp;
+  header.last_timestamp = last_timestamp;
+  header.min_value = min_value;
+  header.max_value = max_value;
+
+  const uint8_t *raw = (const uint8_t *)&header;
+  out.insert(out.end(), raw, raw + sizeof(header));
+  out.insert(out.end(), id.begin(), id.end());
+  out.insert(out.end(), payload.begin(), payload.end());
+
+  reset();
+}
+
+/* ---------------------------------------------------------------------- */
+
+SeriesDecoder::SeriesDecoder(const uint8_t *payload, size_t bytes, uint32_t count)
+  : next_byte(payload), end_byte(payload + bytes), bit_buffer(0), bit_count(0),
+    remaining(count), started(false), last_timestamp(0), last_delta(0),
+    last_bits(0), last_leading(0), last_trailing(0)
+{
+}
+
+void SeriesDecoder::refill()
+{
+  unsigned take = (64 - bit_count) >> 3;
+
+  if (take == 0)
+  {
+    return;
+  }
+  if (end_byte - next_byte >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, next_byte, sizeof(word));
+    word = __builtin_bswap64(word);
+    bit_buffer = (take == 8) ? word : (bit_buffer << (take * 8)) | (word >> (64 - take * 8));
+    next_byte += take;
+    bit_count += take * 8;
+    return;
+  }
+
+  /* Tail of the payload: pad with zero bytes, the sample count bounds reads. */
+  while (take--)
+  {
+    bit_buffer = (bit_buffer << 8) | (next_byte < end_byte ? *next_byte++ : 0);
+    bit_count += 8;
+  }
+}
+
+inline uint64_t SeriesDecoder::readBits(unsigned count)
+{
+  if (bit_count < count)
+  {
+    refill();
+  }
+  bit_count -= count;
+  return (bit_buffer >> bit_count) & ((1ULL << count) - 1);
+}
+
+bool SeriesDecoder::next(int64_t &timestamp, float &value)
+{
+  if (remaining == 0)
+  {
+    return false;
+  }
+  remaining--;
+
+  if (!started)
+  {
+    uint64_t high = readBits(32);
+    last_timestamp = (int64_t)((high << 32) | readBits(32));
+    last_bits = (uint32_t)readBits(32);
+    started = true;
+    timestamp = last_timestamp;
+    value = bitsFloat(last_bits);
+    return true;
+  }
+
+  int64_t dod;
+  if (readBits(1) == 0)
+  {
+    dod = 0;
+  }
+  else if (readBits(1) == 0)
+  {
+    dod = (int64_t)readBits(4) - 7;
+  }
+  else if (readBits(1) == 0)
+  {
+    dod = (int64_t)readBits(7) - 63;
+  }
+  else if (readBits(1) == 0)
+  {
+    dod = (int64_t)readBits(12) - 2047;
+  }
+  else
+  {
+    uint64_t high = readBits(32);
+    dod = (int64_t)((high << 32) | readBits(32));
+  }
+  last_delta += dod;
+  last_timestamp += last_delta;
+
+  if (readBits(1) != 0)
+  {
+    if (readBits(1) == 0)
+    {
+      unsigned length = 32 - last_leading - last_trailing;
+      last_bits ^= (uint32_t)readBits(length) << last_trailing;
+    }
+    else
+    {
+      last_leading = (unsigned)readBits(5);
+      unsigned length = (unsigned)readBits(5) + 1;
+      last_trailing = 32 - last_leading - length;
+      last_bits ^= (uint32_t)readBits(length) << last_trailing;
+    }
+  }
+
+  timestamp = last_timestamp;
+  value = bitsFloat(last_bits);
+  return true;
+}
+
+uint32_t SeriesDecoder::decode(int64_t *timestamps, float *values, uint32_t max)
+{
+  uint32_t n = 0;
+  while (n < max && next(timestamps[n], values[n]))
+  {
+    n++;
+  }
+  return n;
+}
+
+/* ---------------------------------------------------------------------- */
+
+SeriesBlockCursor::SeriesBlockCursor(const uint8_t *data, size_t size)
+  : data(data), size(size), offset(0), next_offset(0)
+{
+  memset(&current, 0, sizeof(current));
+}
+
+bool SeriesBlockCursor::next()
+{
+  offset = next_offset;
+  if (offset + sizeof(SeriesBlockHeader) > size)
+  {
+    return false;
+  }
+  memcpy(&current, data + offset, sizeof(current));
+  if (current.magic != SERIES_BLOCK_MAGIC || current.version != SERIES_BLOCK_VERSION)
+  {
+    return false;
+  }
+
+  /* A block cut short by a crash ends the stream. */
+  size_t end = offset + sizeof(SeriesBlockHeader) + current.id_length + current.payload_bytes;
+  if (end > size)
+  {
+    return false;
+  }
+  next_offset = end;
+  return true;
+}
+
+std::string SeriesBlockCursor::id() const
+{
+  return std::string((const char *)data + offset + sizeof(SeriesBlockHeader), current.id_length);
+}
+
+SeriesDecoder SeriesBlockCursor::decoder() const
+{
+  const uint8_t *payload = data + offset + sizeof(SeriesBlockHeader) + current.id_length;
+  return SeriesDecoder(payload, current.payload_bytes, current.sample_count);
+}
@@ -0,0 +1,133 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesCodec.h
+ * FUNCTION:        Compressed encoding of sensor time series.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the Gorilla style series codec used
+ * by the subscriber to store readings.
+ *
+ * A series is stored as a sequence of self describing blocks:
+ *
+ *   SeriesBlockHeader | sensor id (id_length bytes) | payload
+ *
+ * The header carries the byte length of the payload and the time and value
+ * range of the block, so a reader can skip blocks without decoding them.
+ * Inside the payload timestamps (milliseconds) are stored as a delta of
+ * delta and values as the XOR with the previous value, which costs one bit
+ * per component when the reading period and the value do not change.
+ *
+ ***/
+
+#ifndef __SERIESCODEC_H__
+  #define __SERIESCODEC_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <string>
+  #include <vector>
+
+  #define SERIES_BLOCK_MAGIC   0x4b423253   /* "S2BK" */
+  #define SERIES_BLOCK_VERSION 1
+
+  /**
+   * Fixed size header in front of every block (host byte order).
+   **/
+  struct SeriesBlockHeader
+  {
+      uint32_t magic;
+      uint16_t version;
+      uint16_t id_length;
+      uint32_t sample_count;
+      uint32_t payload_bytes;
+      int64_t  first_timestamp;
+      int64_t  last_timestamp;
+      float    min_value;
+      float    max_value;
+  };
+
+  /**
+   * Streaming encoder for one sensor series. Samples are appended one at
+   * a time and finish() emits the block and starts a new one.
+   **/
+  class SeriesEncoder
+  {
+      std::vector<uint8_t> payload;
+      uint64_t bit_buffer;
+      unsigned bit_count;
+
+      uint32_t sample_count;
+      int64_t  first_timestamp;
+      int64_t  last_timestamp;
+      int64_t  last_delta;
+      uint32_t last_bits;
+      unsigned last_leading;
+      unsigned last_trailing;
+      float    min_value;
+      float    max_value;
+
+      void writeBits(uint64_t value, unsigned count);
+      void writeTimestamp(int64_t timestamp);
+      void writeValue(uint32_t bits);
+    public:
+      SeriesEncoder();
+      void reset();
+      void append(int64_t timestamp, float value);
+      uint32_t size() const { return sample_count; }
+      bool empty() const { return sample_count == 0; }
+      int64_t firstTimestamp() const { return first_timestamp; }
+      int64_t lastTimestamp() const { return last_timestamp; }
+      size_t encodedBytes() const;
+      size_t capacity() const { return payload.capacity(); }
+      void finish(const std::string &id, std::vector<uint8_t> &out);
+  };
+
+  /**
+   * Streaming decoder for the payload of one block.
+   **/
+  class SeriesDecoder
+  {
+      const uint8_t *next_byte;
+      const uint8_t *end_byte;
+      uint64_t bit_buffer;
+      unsigned bit_count;
+
+      uint32_t remaining;
+      bool     started;
+      int64_t  last_timestamp;
+      int64_t  last_delta;
+      uint32_t last_bits;
+      unsigned last_leading;
+      unsigned last_trailing;
+
+      void refill();
+      uint64_t readBits(unsigned count);
+    public:
+      SeriesDecoder(const uint8_t *payload, size_t bytes, uint32_t count);
+      bool next(int64_t &timestamp, float &value);
+      uint32_t decode(int64_t *timestamps, float *values, uint32_t max);
+  };
+
+  /**
+   * Walks the blocks of an encoded buffer, skipping payloads unless the
+   * caller asks for a decoder.
+   **/
+  class SeriesBlockCursor
+  {
+      const uint8_t *data;
+      size_t size;
+      size_t offset;
+      size_t next_offset;
+      SeriesBlockHeader current;
+    public:
+      SeriesBlockCursor(const uint8_t *data, size_t size);
+      bool next();
+      const SeriesBlockHeader &header() const { return current; }
+      size_t blockOffset() const { return offset; }
+      std::string id() const;
+      SeriesDecoder decoder() const;
+  };
+
+#endif
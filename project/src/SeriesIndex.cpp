@@ -0,0 +1,151 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesIndex.cpp
+ * FUNCTION:        Sparse block index over the stored series.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the block index.
+ *
+ ***/
+
+#include <unistd.h>
+#include <algorithm>
+#include "SeriesIndex.h"
+#include "MemoryUsage.h"
+
+static bool endsBefore(const SeriesBlockRef &ref, int64_t timestamp)
+{
+  return ref.last_timestamp < timestamp;
+}
+
+static bool startsBefore(const SeriesBlockRef &a, const SeriesBlockRef &b)
+{
+  return a.first_timestamp < b.first_timestamp;
+}
+
+SeriesIndex::SeriesIndex()
+  : block_count(0)
+{
+}
+
+void SeriesIndex::clear()
+{
+  blocks.clear();
+  block_count = 0;
+}
+
+void SeriesIndex::add(const std::string &id, const SeriesBlockRef &ref)
+{
+  std::vector<SeriesBlockRef> &list = blocks[id];
+
+  /* Blocks normally arrive in time order; keep the list sorted otherwise. */
+  if (list.empty() || list.back().first_timestamp <= ref.first_timestamp)
+  {
+    list.push_back(ref);
+  }
+  else
+  {
+    list.insert(std::upper_bound(list.begin(), list.end(), ref, startsBefore), ref);
+  }
+  block_count++;
+}
+
+/**
+ * Indexes the blocks of a file by reading their headers only. Rollup files
+ * share the block framing under their own magic.
+ * Returns the offset of the end of the last complete block.
+ **/
+uint64_t SeriesIndex::load(int fd, uint64_t size, uint32_t magic)
+{
+  uint64_t offset = 0;
+  SeriesBlockHeader header;
+  std::string id;
+
+  while (offset + sizeof(header) <= size)
+  {
+    if (pread(fd, &header, sizeof(header), offset) != (ssize_t)sizeof(header) ||
+        header.magic != magic || header.version != SERIES_BLOCK_VERSION)
+    {
+      break;
+    }
+    uint64_t end = offset + sizeof(header) + header.id_length + header.payload_bytes;
+    if (end > size)
+    {
+      break;
+    }
+    id.resize(header.id_length);
+    if (pread(fd, &id[0], header.id_length, offset + sizeof(header)) != (ssize_t)header.id_length)
+    {
+      break;
+    }
+
+    SeriesBlockRef ref;
+    ref.offset = offset;
+    ref.bytes = (uint32_t)(end - offset);
+    ref.sample_count = header.sample_count;
+    ref.first_timestamp = header.first_timestamp;
+    ref.last_timestamp = header.last_timestamp;
+    add(id, ref);
+
+    offset = end;
+  }
+  return offset;
+}
+
+void SeriesIndex::find(const std::string &id, int64_t from, int64_t to,
+  std::vector<SeriesBlockRef> &out) const
+{
+  std::map<std::string, std::vector<SeriesBlockRef> >::const_iterator it = blocks.find(id);
+  if (it == blocks.end())
+  {
+    return;
+  }
+
+  const std::vector<SeriesBlockRef> &list = it->second;
+  std::vector<SeriesBlockRef>::const_iterator block =
+    std::lower_bound(list.begin(), list.end(), from, endsBefore);
+  for (; block != list.end() && block->first_timestamp <= to; ++block)
+  {
+    out.push_back(*block);
+  }
+}
+
+void SeriesIndex::matchPrefix(const std::string &prefix, std::vector<std::string> &ids) const
+{
+  std::map<std::string, std::vector<SeriesBlockRef> >::const_iterator it = blocks.lower_bound(prefix);
+  for (; it != blocks.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+  {
+    ids.push_back(it->first);
+  }
+}
+
+/**
+ * Smallest last_timestamp over the first block of every sensor, i.e. the
+ * end of the oldest block in the index.
+ **/
+int64_t SeriesIndex::oldest() const
+{
+  int64_t result = INT64_MAX;
+  std::map<std::string, std::vector<SeriesBlockRef> >::const_iterator it = blocks.begin();
+  for (; it != blocks.end(); ++it)
+  {
+    if (!it->second.empty() && it->second.front().last_timestamp < result)
+    {
+      result = it->second.front().last_timestamp;
+    }
+  }
+  return result;
+}
+
+size_t SeriesIndex::memoryUsage() const
+{
+  size_t bytes = 0;
+  for (std::map<std::string, std::vector<SeriesBlockRef> >::const_iterator it = blocks.begin();
+       it != blocks.end(); ++it)
+  {
+    bytes += MEMORY_NODE_BYTES + memoryOf(it->first) + memoryOf(it->second);
+  }
+  return bytes;
+}
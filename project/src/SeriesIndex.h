@@ -0,0 +1,52 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesIndex.h
+ * FUNCTION:        Sparse block index over the stored series.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the block index. Only block headers
+ * are indexed: for every sensor id the index keeps the file offset and the
+ * time range of each of its blocks, ordered by time. Ids are kept sorted
+ * so "<host>N<node>S" prefixes select all sensors of a node.
+ *
+ ***/
+
+#ifndef __SERIESINDEX_H__
+  #define __SERIESINDEX_H__
+
+  #include <stdint.h>
+  #include <map>
+  #include <string>
+  #include <vector>
+  #include "SeriesCodec.h"
+
+  struct SeriesBlockRef
+  {
+      uint64_t offset;
+      uint32_t bytes;
+      uint32_t sample_count;
+      int64_t  first_timestamp;
+      int64_t  last_timestamp;
+  };
+
+  class SeriesIndex
+  {
+      std::map<std::string, std::vector<SeriesBlockRef> > blocks;
+      uint64_t block_count;
+    public:
+      SeriesIndex();
+      void clear();
+      void add(const std::string &id, const SeriesBlockRef &ref);
+      uint64_t load(int fd, uint64_t size, uint32_t magic = SERIES_BLOCK_MAGIC);
+      void find(const std::string &id, int64_t from, int64_t to,
+        std::vector<SeriesBlockRef> &out) const;
+      void matchPrefix(const std::string &prefix, std::vector<std::string> &ids) const;
+      int64_t oldest() const;
+      size_t sensors() const { return blocks.size(); }
+      uint64_t size() const { return block_count; }
+      size_t memoryUsage() const;
+  };
+
+#endif
@@ -0,0 +1,417 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesRollup.cpp
+ * FUNCTION:        Multi-resolution rollups of the stored readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the rollup store.
+ *
+ ***/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <set>
+#include "SeriesRollup.h"
+#include "MemoryUsage.h"
+
+const int64_t RollupStore::resolution[ROLLUP_LEVELS] = { 1000, 60000, 3600000 };
+const char *const RollupStore::name[ROLLUP_LEVELS] = { "1s", "1m", "1h" };
+
+/* Closed buckets written per chunk: one minute, one hour and one day. */
+static const size_t chunkBuckets[ROLLUP_LEVELS] = { 60, 60, 24 };
+
+static int64_t bucketStart(int64_t timestamp, int64_t width)
+{
+  int64_t start = timestamp - timestamp % width;
+  return timestamp < 0 && start != timestamp ? start - width : start;
+}
+
+static void resetBucket(RollupBucket &bucket)
+{
+  memset(&bucket, 0, sizeof(bucket));
+}
+
+static void mergeBucket(RollupBucket &into, const RollupBucket &from)
+{
+  if (into.count == 0)
+  {
+    into.min_value = from.min_value;
+    into.max_value = from.max_value;
+  }
+  else
+  {
+    if (from.min_value < into.min_value)
+    {
+      into.min_value = from.min_value;
+    }
+    if (from.max_value > into.max_value)
+    {
+      into.max_value = from.max_value;
+    }
+  }
+  into.sum += from.sum;
+  into.count += from.count;
+}
+
+RollupStore::RollupStore()
+{
+  for (int l = 0; l < ROLLUP_LEVELS; l++)
+  {
+    levels[l].file = NULL;
+    levels[l].read_fd = -1;
+    levels[l].file_size = 0;
+  }
+}
+
+RollupStore::~RollupStore()
+{
+  close();
+}
+
+void RollupStore::open(const std::string &directory)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  for (int l = 0; l < ROLLUP_LEVELS; l++)
+  {
+    std::string file = directory + "/rollup_" + name[l] + ".dat";
+    Level &level = levels[l];
+
+    level.read_fd = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+    if (level.read_fd < 0)
+    {
+      std::cerr << "Error in RollupStore::open: cannot open " << file
+                << ": " << strerror(errno) << std::endl;
+      exit(1);
+    }
+
+    struct stat info;
+    fstat(level.read_fd, &info);
+    level.file_size = level.index.load(level.read_fd, (uint64_t)info.st_size, ROLLUP_BLOCK_MAGIC);
+    if (level.file_size != (uint64_t)info.st_size &&
+        ftruncate(level.read_fd, (off_t)level.file_size) != 0)
+    {
+      std::cerr << "Error in RollupStore::open: cannot truncate " << file
+                << ": " << strerror(errno) << std::endl;
+      exit(1);
+    }
+
+    level.file = fopen(file.c_str(), "ab");
+    if (level.file == NULL)
+    {
+      std::cerr << "Error in RollupStore::open: cannot open " << file
+                << ": " << strerror(errno) << std::endl;
+      exit(1);
+    }
+  }
+}
+
+/* Called with the lock held. */
+void RollupStore::writeChunk(const std::string &id, int l, std::vector<RollupBucket> &buckets)
+{
+  Level &level = levels[l];
+
+  SeriesBlockHeader header;
+  header.magic = ROLLUP_BLOCK_MAGIC;
+  header.version = SERIES_BLOCK_VERSION;
+  header.id_length = (uint16_t)id.size();
+  header.sample_count = (uint32_t)buckets.size();
+  header.payload_bytes = (uint32_t)(buckets.size() * sizeof(RollupBucket));
+  header.first_timestamp = buckets.front().start;
+  header.last_timestamp = buckets.back().start;
+  header.min_value = buckets.front().min_value;
+  header.max_value = buckets.front().max_value;
+  for (size_t i = 1; i < buckets.size(); i++)
+  {
+    if (buckets[i].min_value < header.min_value)
+    {
+      header.min_value = buckets[i].min_value;
+    }
+    if (buckets[i].max_value > header.max_value)
+    {
+      header.max_value = buckets[i].max_value;
+    }
+  }
+
+  block_buffer.clear();
+  const uint8_t *raw = (const uint8_t *)&header;
+  block_buffer.insert(block_buffer.end(), raw, raw + sizeof(header));
+  block_buffer.insert(block_buffer.end(), id.begin(), id.end());
+  raw = (const uint8_t *)&buckets[0];
+  block_buffer.insert(block_buffer.end(), raw, raw + header.payload_bytes);
+
+  if (fwrite(&block_buffer[0], 1, block_buffer.size(), level.file) != block_buffer.size())
+  {
+    std::cerr << "Error in RollupStore::writeChunk: " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  fflush(level.file);
+
+  SeriesBlockRef ref;
+  ref.offset = level.file_size;
+  ref.bytes = (uint32_t)block_buffer.size();
+  ref.sample_count = header.sample_count;
+  ref.first_timestamp = header.first_timestamp;
+  ref.last_timestamp = header.last_timestamp;
+  level.index.add(id, ref);
+  level.file_size += block_buffer.size();
+
+  buckets.clear();
+}
+
+/**
+ * Moves the open bucket of a level to its closed list and merges it into
+ * the next coarser level, closing that one first when the bucket belongs
+ * to a later period. Called with the lock held.
+ **/
+void RollupStore::closeBucket(const std::string &id, SensorRollup &sensor, int level)
+{
+  RollupBucket &bucket = sensor.open[level];
+
+  if (level + 1 < ROLLUP_LEVELS)
+  {
+    RollupBucket &coarse = sensor.open[level + 1];
+    int64_t start = bucketStart(bucket.start, resolution[level + 1]);
+    if (coarse.count > 0 && coarse.start != start)
+    {
+      closeBucket(id, sensor, level + 1);
+    }
+    if (coarse.count == 0)
+    {
+      coarse.start = start;
+    }
+    mergeBucket(coarse, bucket);
+  }
+
+  sensor.closed[level].push_back(bucket);
+  if (sensor.closed[level].size() >= chunkBuckets[level] && levels[level].file != NULL)
+  {
+    writeChunk(id, level, sensor.closed[level]);
+  }
+  resetBucket(bucket);
+}
+
+void RollupStore::add(const std::string &id, int64_t timestamp, float value)
+{
+  std::lock_guard<std::mutex> guard(lock);
+  std::map<std::string, SensorRollup>::iterator it = sensors.find(id);
+  if (it == sensors.end())
+  {
+    it = sensors.insert(std::make_pair(id, SensorRollup())).first;
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      resetBucket(it->second.open[l]);
+    }
+  }
+
+  SensorRollup &sensor = it->second;
+  RollupBucket &bucket = sensor.open[0];
+  int64_t start = bucketStart(timestamp, resolution[0]);
+
+  /* Late samples are folded into the open bucket rather than reopening
+   * one that was already merged upwards. */
+  if (bucket.count > 0 && start > bucket.start)
+  {
+    closeBucket(id, sensor, 0);
+  }
+  if (bucket.count == 0)
+  {
+    bucket.start = start;
+  }
+
+  RollupBucket sample;
+  sample.start = start;
+  sample.min_value = value;
+  sample.max_value = value;
+  sample.sum = value;
+  sample.count = 1;
+  mergeBucket(bucket, sample);
+}
+
+void RollupStore::flush()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  for (std::map<std::string, SensorRollup>::iterator it = sensors.begin(); it != sensors.end(); ++it)
+  {
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      if (!it->second.closed[l].empty() && levels[l].file != NULL)
+      {
+        writeChunk(it->first, l, it->second.closed[l]);
+      }
+    }
+  }
+}
+
+void RollupStore::close()
+{
+  if (levels[0].file == NULL)
+  {
+    return;
+  }
+
+  /* Open buckets are written as well; a restart starts new ones. */
+  std::lock_guard<std::mutex> guard(lock);
+  for (std::map<std::string, SensorRollup>::iterator it = sensors.begin(); it != sensors.end(); ++it)
+  {
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      if (it->second.open[l].count > 0)
+      {
+        closeBucket(it->first, it->second, l);
+      }
+      if (!it->second.closed[l].empty())
+      {
+        writeChunk(it->first, l, it->second.closed[l]);
+      }
+    }
+  }
+  sensors.clear();
+
+  for (int l = 0; l < ROLLUP_LEVELS; l++)
+  {
+    fclose(levels[l].file);
+    levels[l].file = NULL;
+    ::close(levels[l].read_fd);
+    levels[l].read_fd = -1;
+    levels[l].index.clear();
+  }
+}
+
+void RollupStore::query(const std::string &id, int l, int64_t from, int64_t to,
+  RollupVisitor &visitor) const
+{
+  std::vector<SeriesBlockRef> refs;
+  std::vector<RollupBucket> recent;
+  int fd;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    fd = levels[l].read_fd;
+    levels[l].index.find(id, from, to, refs);
+
+    std::map<std::string, SensorRollup>::const_iterator it = sensors.find(id);
+    if (it != sensors.end())
+    {
+      recent = it->second.closed[l];
+
+      /* The open buckets of the finer levels hold the readings that have
+       * not cascaded up yet; fold them in, coarsest (oldest) first. */
+      for (int k = l; k >= 0; k--)
+      {
+        RollupBucket bucket = it->second.open[k];
+        if (bucket.count == 0)
+        {
+          continue;
+        }
+        bucket.start = bucketStart(bucket.start, resolution[l]);
+        if (!recent.empty() && recent.back().start >= bucket.start)
+        {
+          mergeBucket(recent.back(), bucket);
+        }
+        else
+        {
+          recent.push_back(bucket);
+        }
+      }
+    }
+  }
+
+  /* Collect everything first: a restart leaves the period it happened in
+   * split over two buckets, which are merged back here. */
+  std::vector<uint8_t> raw;
+  std::vector<RollupBucket> buckets;
+  for (size_t b = 0; b < refs.size(); b++)
+  {
+    raw.resize(refs[b].bytes);
+    if (pread(fd, &raw[0], raw.size(), (off_t)refs[b].offset) != (ssize_t)raw.size())
+    {
+      continue;
+    }
+    size_t first = buckets.size();
+    buckets.resize(first + refs[b].sample_count);
+    memcpy(&buckets[first], &raw[sizeof(SeriesBlockHeader) + id.size()],
+      refs[b].sample_count * sizeof(RollupBucket));
+  }
+  buckets.insert(buckets.end(), recent.begin(), recent.end());
+
+  uint32_t kept = 0;
+  for (size_t i = 0; i < buckets.size(); i++)
+  {
+    if (buckets[i].start < from || buckets[i].start > to)
+    {
+      continue;
+    }
+    if (kept > 0 && buckets[kept - 1].start == buckets[i].start)
+    {
+      mergeBucket(buckets[kept - 1], buckets[i]);
+    }
+    else
+    {
+      buckets[kept++] = buckets[i];
+    }
+  }
+  if (kept > 0)
+  {
+    visitor.visit(id, l, &buckets[0], kept);
+  }
+}
+
+void RollupStore::matchPrefix(const std::string &prefix, std::vector<std::string> &ids) const
+{
+  std::set<std::string> found;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      std::vector<std::string> indexed;
+      levels[l].index.matchPrefix(prefix, indexed);
+      found.insert(indexed.begin(), indexed.end());
+    }
+    std::map<std::string, SensorRollup>::const_iterator it = sensors.lower_bound(prefix);
+    for (; it != sensors.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+    {
+      found.insert(it->first);
+    }
+  }
+  ids.insert(ids.end(), found.begin(), found.end());
+}
+
+/**
+ * Finest level that answers [from, to] with at most maxPoints buckets.
+ **/
+int RollupStore::chooseLevel(int64_t from, int64_t to, uint32_t maxPoints)
+{
+  for (int l = 0; l < ROLLUP_LEVELS; l++)
+  {
+    if ((to - from) / resolution[l] <= (int64_t)maxPoints)
+    {
+      return l;
+    }
+  }
+  return ROLLUP_LEVELS - 1;
+}
+
+size_t RollupStore::memoryUsage() const
+{
+  std::lock_guard<std::mutex> guard(lock);
+  size_t bytes = memoryOf(block_buffer);
+  for (int l = 0; l < ROLLUP_LEVELS; l++)
+  {
+    bytes += levels[l].index.memoryUsage();
+  }
+  for (std::map<std::string, SensorRollup>::const_iterator it = sensors.begin(); it != sensors.end(); ++it)
+  {
+    bytes += MEMORY_NODE_BYTES + sizeof(SensorRollup) + memoryOf(it->first);
+    for (int l = 0; l < ROLLUP_LEVELS; l++)
+    {
+      bytes += memoryOf(it->second.closed[l]);
+    }
+  }
+  return bytes;
+}
@@ -0,0 +1,95 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesRollup.h
+ * FUNCTION:        Multi-resolution rollups of the stored readings.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the rollup store. For every sensor
+ * it keeps one open min/max/sum/count bucket per resolution (1 s, 1 min,
+ * 1 h). A sample only touches the 1 s bucket; a closed bucket is merged
+ * into the next coarser level, so each level is fed by the one below it.
+ *
+ * Closed buckets are appended to <directory>/rollup_1s.dat, rollup_1m.dat
+ * and rollup_1h.dat in chunks that use the series block framing with
+ * ROLLUP_BLOCK_MAGIC, so they are indexed the same way as raw blocks.
+ * Rollups are never compacted.
+ *
+ ***/
+
+#ifndef __SERIESROLLUP_H__
+  #define __SERIESROLLUP_H__
+
+  #include <stdio.h>
+  #include <map>
+  #include <mutex>
+  #include <string>
+  #include <vector>
+  #include "SeriesIndex.h"
+
+  #define ROLLUP_BLOCK_MAGIC 0x4c523253   /* "S2RL" */
+  #define ROLLUP_LEVELS      3
+
+  struct RollupBucket
+  {
+      int64_t  start;
+      float    min_value;
+      float    max_value;
+      double   sum;
+      uint32_t count;
+      uint32_t reserved;
+  };
+
+  /**
+   * Receives the buckets of a rollup query.
+   **/
+  class RollupVisitor
+  {
+    public:
+      virtual ~RollupVisitor() {}
+      virtual void visit(const std::string &id, int level, const RollupBucket *buckets,
+        uint32_t count) = 0;
+  };
+
+  class RollupStore
+  {
+      struct Level
+      {
+          FILE *file;
+          int read_fd;
+          uint64_t file_size;
+          SeriesIndex index;
+      };
+
+      struct SensorRollup
+      {
+          RollupBucket open[ROLLUP_LEVELS];
+          std::vector<RollupBucket> closed[ROLLUP_LEVELS];
+      };
+
+      Level levels[ROLLUP_LEVELS];
+      std::map<std::string, SensorRollup> sensors;
+      std::vector<uint8_t> block_buffer;
+      mutable std::mutex lock;
+
+      void closeBucket(const std::string &id, SensorRollup &sensor, int level);
+      void writeChunk(const std::string &id, int level, std::vector<RollupBucket> &buckets);
+    public:
+      static const int64_t resolution[ROLLUP_LEVELS];
+      static const char *const name[ROLLUP_LEVELS];
+
+      RollupStore();
+      ~RollupStore();
+      void open(const std::string &directory);
+      void add(const std::string &id, int64_t timestamp, float value);
+      void flush();
+      void close();
+      void query(const std::string &id, int level, int64_t from, int64_t to,
+        RollupVisitor &visitor) const;
+      void matchPrefix(const std::string &prefix, std::vector<std::string> &ids) const;
+      size_t memoryUsage() const;
+      static int chooseLevel(int64_t from, int64_t to, uint32_t maxPoints);
+  };
+
+#endif
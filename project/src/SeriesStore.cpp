@@ -0,0 +1,487 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesStore.cpp
+ * FUNCTION:        On disk storage of the readings received by c2.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the series store.
+ *
+ ***/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include "SeriesStore.h"
+#include "MemoryUsage.h"
+
+SeriesStore::ReadFile::~ReadFile()
+{
+  ::close(fd);
+}
+
+SeriesStore::SeriesStore()
+  : data_file(NULL), file_size(0), block_samples(1024), block_span(600000),
+    newest_timestamp(INT64_MIN), sample_count(0), stored_bytes(0), retention(0),
+    compactor_running(false)
+{
+}
+
+SeriesStore::~SeriesStore()
+{
+  close();
+}
+
+void SeriesStore::open(const std::string &dir, uint32_t blockSamples, int64_t blockSpanMs)
+{
+  directory = dir;
+  block_samples = blockSamples;
+  block_span = blockSpanMs;
+
+  if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+  {
+    std::cerr << "Error in SeriesStore::open: cannot create " << directory
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  std::string file = directory + "/series.dat";
+  int fd = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0)
+  {
+    std::cerr << "Error in SeriesStore::open: cannot open " << file
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  read_file = std::make_shared<ReadFile>(fd);
+
+  /* Index what is already stored and drop a block cut short by a crash. */
+  struct stat info;
+  fstat(fd, &info);
+  file_size = index.load(fd, (uint64_t)info.st_size);
+  if (file_size != (uint64_t)info.st_size && ftruncate(fd, (off_t)file_size) != 0)
+  {
+    std::cerr << "Error in SeriesStore::open: cannot truncate " << file
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+
+  data_file = fopen(file.c_str(), "ab");
+  if (data_file == NULL)
+  {
+    std::cerr << "Error in SeriesStore::open: cannot open " << file
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  rollups.open(directory);
+  std::cout << "=== [SeriesStore] " << index.size() << " blocks of "
+            << index.sensors() << " sensors in " << file << std::endl;
+}
+
+/* Called with the lock held. */
+void SeriesStore::writeBlock(const std::string &id, SeriesEncoder &encoder)
+{
+  SeriesBlockRef ref;
+  ref.offset = file_size;
+  ref.sample_count = encoder.size();
+  ref.first_timestamp = encoder.firstTimestamp();
+  ref.last_timestamp = encoder.lastTimestamp();
+
+  block_buffer.clear();
+  encoder.finish(id, block_buffer);
+  if (fwrite(&block_buffer[0], 1, block_buffer.size(), data_file) != block_buffer.size())
+  {
+    std::cerr << "Error in SeriesStore::writeBlock: " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  fflush(data_file);
+
+  ref.bytes = (uint32_t)block_buffer.size();
+  index.add(id, ref);
+  file_size += block_buffer.size();
+  stored_bytes += block_buffer.size();
+}
+
+void SeriesStore::append(const char *id, int64_t timestamp, float value)
+{
+  std::string key(id);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    SeriesEncoder &encoder = open_series[key];
+
+    if (!encoder.empty() &&
+        (encoder.size() >= block_samples || timestamp - encoder.firstTimestamp() >= block_span))
+    {
+      writeBlock(key, encoder);
+    }
+    encoder.append(timestamp, value);
+    sample_count++;
+    if (timestamp > newest_timestamp)
+    {
+      newest_timestamp = timestamp;
+    }
+  }
+  rollups.add(key, timestamp, value);
+}
+
+void SeriesStore::flush()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (data_file == NULL)
+    {
+      return;
+    }
+    for (std::map<std::string, SeriesEncoder>::iterator it = open_series.begin();
+         it != open_series.end(); ++it)
+    {
+      if (!it->second.empty())
+      {
+        writeBlock(it->first, it->second);
+      }
+    }
+  }
+  rollups.flush();
+}
+
+void SeriesStore::close()
+{
+  if (data_file == NULL)
+  {
+    return;
+  }
+
+  if (compactor.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> guard(compactor_lock);
+      compactor_running = false;
+    }
+    compactor_wakeup.notify_all();
+    compactor.join();
+  }
+
+  flush();
+  rollups.close();
+
+  std::lock_guard<std::mutex> guard(lock);
+  fclose(data_file);
+  data_file = NULL;
+  read_file.reset();
+  open_series.clear();
+  index.clear();
+}
+
+/* ---------------------------------------------------------------------- */
+
+/**
+ * Copies the blocks of [begin, end) that end at or after "before" from one
+ * file to the end of another and indexes them at their new offsets.
+ * Returns false when the target cannot be written.
+ **/
+static bool copyBlocks(int source, uint64_t begin, uint64_t end, int target,
+  uint64_t &written, SeriesIndex &kept, int64_t before, uint64_t &dropped)
+{
+  std::vector<uint8_t> block;
+  SeriesBlockHeader header;
+  uint64_t offset = begin;
+
+  while (offset + sizeof(header) <= end)
+  {
+    if (pread(source, &header, sizeof(header), (off_t)offset) != (ssize_t)sizeof(header) ||
+        header.magic != SERIES_BLOCK_MAGIC)
+    {
+      break;
+    }
+    uint32_t bytes = (uint32_t)(sizeof(header) + header.id_length + header.payload_bytes);
+    if (header.last_timestamp < before)
+    {
+      dropped += bytes;
+      offset += bytes;
+      continue;
+    }
+
+    block.resize(bytes);
+    if (pread(source, &block[0], bytes, (off_t)offset) != (ssize_t)bytes)
+    {
+      break;
+    }
+    if (pwrite(target, &block[0], bytes, (off_t)written) != (ssize_t)bytes)
+    {
+      return false;
+    }
+
+    SeriesBlockRef ref;
+    ref.offset = written;
+    ref.bytes = bytes;
+    ref.sample_count = header.sample_count;
+    ref.first_timestamp = header.first_timestamp;
+    ref.last_timestamp = header.last_timestamp;
+    kept.add(std::string((const char *)&block[sizeof(header)], header.id_length), ref);
+
+    written += bytes;
+    offset += bytes;
+  }
+  return true;
+}
+
+/**
+ * Rewrites series.dat without the blocks that end before "before". The
+ * bulk of the copy runs without the lock; only blocks appended meanwhile
+ * are copied while appends are held. Returns the number of bytes dropped.
+ **/
+uint64_t SeriesStore::compact(int64_t before)
+{
+  std::shared_ptr<ReadFile> source;
+  uint64_t snapshot;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (data_file == NULL || index.oldest() >= before)
+    {
+      return 0;
+    }
+    source = read_file;
+    snapshot = file_size;
+  }
+
+  std::string file = directory + "/series.dat";
+  std::string temporary = file + ".compact";
+  int target = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (target < 0)
+  {
+    std::cerr << "Error in SeriesStore::compact: cannot open " << temporary
+              << ": " << strerror(errno) << std::endl;
+    return 0;
+  }
+
+  SeriesIndex kept;
+  uint64_t written = 0;
+  uint64_t dropped = 0;
+  if (!copyBlocks(source->fd, 0, snapshot, target, written, kept, before, dropped))
+  {
+    std::cerr << "Error in SeriesStore::compact: " << strerror(errno) << std::endl;
+    ::close(target);
+    unlink(temporary.c_str());
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+  uint64_t ignored = 0;
+  if (!copyBlocks(source->fd, snapshot, file_size, target, written, kept, INT64_MIN, ignored) ||
+      fsync(target) != 0 || rename(temporary.c_str(), file.c_str()) != 0)
+  {
+    std::cerr << "Error in SeriesStore::compact: " << strerror(errno) << std::endl;
+    ::close(target);
+    unlink(temporary.c_str());
+    return 0;
+  }
+
+  fclose(data_file);
+  data_file = fopen(file.c_str(), "ab");
+  if (data_file == NULL)
+  {
+    std::cerr << "Error in SeriesStore::compact: cannot reopen " << file
+              << ": " << strerror(errno) << std::endl;
+    exit(1);
+  }
+  read_file = std::make_shared<ReadFile>(target);
+  index = kept;
+  file_size = written;
+  return dropped;
+}
+
+void SeriesStore::runCompactor(int64_t intervalMs)
+{
+  std::unique_lock<std::mutex> wait(compactor_lock);
+  while (compactor_running)
+  {
+    compactor_wakeup.wait_for(wait, std::chrono::milliseconds(intervalMs));
+    if (!compactor_running)
+    {
+      break;
+    }
+
+    int64_t newest;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      newest = newest_timestamp;
+    }
+    if (newest == INT64_MIN)
+    {
+      continue;
+    }
+
+    uint64_t dropped = compact(newest - retention);
+    if (dropped > 0)
+    {
+      std::cout << "=== [SeriesStore] Compaction dropped " << dropped
+                << " bytes of raw data" << std::endl;
+    }
+  }
+}
+
+/**
+ * Keeps raw blocks for retentionMs (measured against the newest reading)
+ * and checks every intervalMs for blocks to drop.
+ **/
+void SeriesStore::setRetention(int64_t retentionMs, int64_t intervalMs)
+{
+  if (compactor.joinable() || retentionMs <= 0)
+  {
+    return;
+  }
+  retention = retentionMs;
+  compactor_running = true;
+  compactor = std::thread(&SeriesStore::runCompactor, this, intervalMs);
+}
+
+/* ---------------------------------------------------------------------- */
+
+/**
+ * Decodes the given blocks outside the lock and passes the samples within
+ * [from, to] to the visitor.
+ **/
+void SeriesStore::readBlocks(int fd, const std::string &id, const std::vector<SeriesBlockRef> &refs,
+  const std::vector<uint8_t> &openBlock, int64_t from, int64_t to, SeriesVisitor &visitor) const
+{
+  std::vector<uint8_t> raw;
+  std::vector<int64_t> timestamps;
+  std::vector<float> values;
+
+  for (size_t b = 0; b <= refs.size(); b++)
+  {
+    const uint8_t *data;
+    size_t size;
+    if (b < refs.size())
+    {
+      raw.resize(refs[b].bytes);
+      if (pread(fd, &raw[0], raw.size(), (off_t)refs[b].offset) != (ssize_t)raw.size())
+      {
+        continue;
+      }
+      data = &raw[0];
+      size = raw.size();
+    }
+    else if (!openBlock.empty())
+    {
+      data = &openBlock[0];
+      size = openBlock.size();
+    }
+    else
+    {
+      break;
+    }
+
+    SeriesBlockCursor cursor(data, size);
+    if (!cursor.next())
+    {
+      continue;
+    }
+    uint32_t count = cursor.header().sample_count;
+    timestamps.resize(count);
+    values.resize(count);
+    SeriesDecoder decoder = cursor.decoder();
+    count = decoder.decode(&timestamps[0], &values[0], count);
+
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+      if (timestamps[i] >= from && timestamps[i] <= to)
+      {
+        timestamps[kept] = timestamps[i];
+        values[kept] = values[i];
+        kept++;
+      }
+    }
+    if (kept > 0)
+    {
+      visitor.visit(id, &timestamps[0], &values[0], kept);
+    }
+  }
+}
+
+void SeriesStore::query(const std::string &id, int64_t from, int64_t to, SeriesVisitor &visitor) const
+{
+  std::shared_ptr<ReadFile> file;
+  std::vector<SeriesBlockRef> refs;
+  std::vector<uint8_t> openBlock;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!read_file)
+    {
+      return;
+    }
+    file = read_file;
+    index.find(id, from, to, refs);
+
+    std::map<std::string, SeriesEncoder>::const_iterator it = open_series.find(id);
+    if (it != open_series.end() && !it->second.empty() &&
+        it->second.lastTimestamp() >= from && it->second.firstTimestamp() <= to)
+    {
+      SeriesEncoder copy = it->second;
+      copy.finish(id, openBlock);
+    }
+  }
+  readBlocks(file->fd, id, refs, openBlock, from, to, visitor);
+}
+
+void SeriesStore::queryPrefix(const std::string &prefix, int64_t from, int64_t to,
+  SeriesVisitor &visitor) const
+{
+  std::vector<std::string> indexed;
+  std::set<std::string> ids;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    index.matchPrefix(prefix, indexed);
+    std::map<std::string, SeriesEncoder>::const_iterator it = open_series.lower_bound(prefix);
+    for (; it != open_series.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+    {
+      ids.insert(it->first);
+    }
+  }
+  ids.insert(indexed.begin(), indexed.end());
+
+  for (std::set<std::string>::const_iterator id = ids.begin(); id != ids.end(); ++id)
+  {
+    query(*id, from, to, visitor);
+  }
+}
+
+void SeriesStore::queryRollup(const std::string &id, int level, int64_t from, int64_t to,
+  RollupVisitor &visitor) const
+{
+  rollups.query(id, level, from, to, visitor);
+}
+
+void SeriesStore::queryRollupPrefix(const std::string &prefix, int level, int64_t from,
+  int64_t to, RollupVisitor &visitor) const
+{
+  std::vector<std::string> ids;
+  rollups.matchPrefix(prefix, ids);
+  for (size_t i = 0; i < ids.size(); i++)
+  {
+    rollups.query(ids[i], level, from, to, visitor);
+  }
+}
+
+size_t SeriesStore::memoryUsage() const
+{
+  size_t bytes = 0;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    bytes = memoryOf(block_buffer) + index.memoryUsage();
+    for (std::map<std::string, SeriesEncoder>::const_iterator it = open_series.begin();
+         it != open_series.end(); ++it)
+    {
+      bytes += MEMORY_NODE_BYTES + sizeof(SeriesEncoder) + memoryOf(it->first) + it->second.capacity();
+    }
+  }
+  return bytes + rollups.memoryUsage();
+}
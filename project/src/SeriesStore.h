@@ -0,0 +1,115 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SeriesStore.h
+ * FUNCTION:        On disk storage of the readings received by c2.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the series store. Every sensor id
+ * keeps an open SeriesEncoder; when the block reaches its sample or time
+ * limit it is appended to <directory>/series.dat and added to the block
+ * index. Every reading also feeds the 1 s / 1 min / 1 h rollups kept next
+ * to the raw data. Queries may run from another thread while readings are
+ * appended.
+ *
+ * With a retention set, a background thread periodically rewrites
+ * series.dat without the blocks older than the retention; rollups are
+ * kept for the whole history.
+ *
+ ***/
+
+#ifndef __SERIESSTORE_H__
+  #define __SERIESSTORE_H__
+
+  #include <stdio.h>
+  #include <condition_variable>
+  #include <map>
+  #include <memory>
+  #include <mutex>
+  #include <string>
+  #include <thread>
+  #include <vector>
+  #include "SeriesCodec.h"
+  #include "SeriesIndex.h"
+  #include "SeriesRollup.h"
+
+  /**
+   * Receives the samples of a query, one decoded block at a time.
+   **/
+  class SeriesVisitor
+  {
+    public:
+      virtual ~SeriesVisitor() {}
+      virtual void visit(const std::string &id, const int64_t *timestamps,
+        const float *values, uint32_t count) = 0;
+  };
+
+  class SeriesStore
+  {
+      /* Read side of series.dat; queries keep the file they started on
+       * alive while compaction swaps in a new one. */
+      struct ReadFile
+      {
+          int fd;
+          ReadFile(int fd) : fd(fd) {}
+          ~ReadFile();
+      };
+
+      std::string directory;
+      FILE *data_file;
+      std::shared_ptr<ReadFile> read_file;
+      uint64_t file_size;
+      std::map<std::string, SeriesEncoder> open_series;
+      std::vector<uint8_t> block_buffer;
+      SeriesIndex index;
+      RollupStore rollups;
+      mutable std::mutex lock;
+
+      uint32_t block_samples;
+      int64_t  block_span;
+      int64_t  newest_timestamp;
+
+      uint64_t sample_count;
+      uint64_t stored_bytes;
+
+      int64_t retention;
+      std::thread compactor;
+      std::mutex compactor_lock;
+      std::condition_variable compactor_wakeup;
+      bool compactor_running;
+
+      void writeBlock(const std::string &id, SeriesEncoder &encoder);
+      void readBlocks(int fd, const std::string &id, const std::vector<SeriesBlockRef> &refs,
+        const std::vector<uint8_t> &openBlock, int64_t from, int64_t to,
+        SeriesVisitor &visitor) const;
+      void runCompactor(int64_t intervalMs);
+    public:
+      SeriesStore();
+      ~SeriesStore();
+      void open(const std::string &directory, uint32_t blockSamples = 1024,
+        int64_t blockSpanMs = 600000);
+      void append(const char *id, int64_t timestamp, float value);
+      void flush();
+      void close();
+      void setRetention(int64_t retentionMs, int64_t intervalMs = 3600000);
+      uint64_t compact(int64_t before);
+      void query(const std::string &id, int64_t from, int64_t to, SeriesVisitor &visitor) const;
+      void queryPrefix(const std::string &prefix, int64_t from, int64_t to,
+        SeriesVisitor &visitor) const;
+      void queryRollup(const std::string &id, int level, int64_t from, int64_t to,
+        RollupVisitor &visitor) const;
+      void queryRollupPrefix(const std::string &prefix, int level, int64_t from, int64_t to,
+        RollupVisitor &visitor) const;
+      bool isOpen() const { return data_file != NULL; }
+      const std::string &path() const { return directory; }
+      uint64_t samples() const { return sample_count; }
+      uint64_t bytes() const { return stored_bytes; }
+
+      /**
+       * Approximate bytes held in memory: open blocks, index and rollups.
+       **/
+      size_t memoryUsage() const;
+  };
+
+#endif
@@ -0,0 +1,186 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Sharding.cpp
+ * FUNCTION:        Partition sharding of the sensor traffic.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the shard map.
+ *
+ ***/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "CommandLine.h"
+#include "Sharding.h"
+
+ShardMap::ShardMap(uint32_t shards, ShardHash hash, const char *prefix)
+  : shard_count(shards > 0 ? shards : 1), hash(hash), prefix(prefix)
+{
+}
+
+bool ShardMap::parseHash(const char *name, ShardHash &hash)
+{
+  if (strcmp(name, "fnv1a") == 0)
+  {
+    hash = SHARD_HASH_FNV1A;
+    return true;
+  }
+  if (strcmp(name, "numeric") == 0)
+  {
+    hash = SHARD_HASH_NUMERIC;
+    return true;
+  }
+  return false;
+}
+
+ShardMap ShardMap::fromCommandLine(int argc, char *argv[])
+{
+  long shards = getIntOption(argc, argv, "--shards", 1);
+  const char *hashName = getOption(argc, argv, "--shard-hash", "fnv1a");
+  ShardHash hash;
+  if (shards < 1 || shards > 65536)
+  {
+    std::cerr << "Error in --shards: expected 1 to 65536, got " << shards << std::endl;
+    exit(1);
+  }
+  if (!parseHash(hashName, hash))
+  {
+    std::cerr << "Error in --shard-hash: expected fnv1a or numeric, got " << hashName << std::endl;
+    exit(1);
+  }
+  return ShardMap((uint32_t)shards, hash, getOption(argc, argv, "--shard-prefix", SHARD_DEFAULT_PREFIX));
+}
+
+uint32_t ShardMap::shardOf(const char *nodeId) const
+{
+  if (hash == SHARD_HASH_NUMERIC)
+  {
+    const char *end = nodeId + strlen(nodeId);
+    const char *digits = end;
+    while (digits > nodeId && digits[-1] >= '0' && digits[-1] <= '9')
+    {
+      digits--;
+    }
+    if (digits < end)
+    {
+      return (uint32_t)(strtoull(digits, NULL, 10) % shard_count);
+    }
+  }
+
+  uint32_t value = 2166136261u;
+  for (; *nodeId != '\0'; nodeId++)
+  {
+    value = (value ^ (uint8_t)*nodeId) * 16777619u;
+  }
+  return value % shard_count;
+}
+
+std::string ShardMap::partition(uint32_t shard) const
+{
+  if (!enabled())
+  {
+    return "";
+  }
+  return prefix + std::to_string(shard);
+}
+
+bool ShardMap::partitions(const char *subset, std::vector<std::string> &names) const
+{
+  names.clear();
+  if (strcmp(subset, "all") == 0)
+  {
+    for (uint32_t shard = 0; shard < shard_count; shard++)
+    {
+      names.push_back(partition(shard));
+    }
+    return true;
+  }
+
+  std::vector<bool> chosen(shard_count, false);
+  const char *at = subset;
+  while (*at != '\0')
+  {
+    char *end;
+    unsigned long first = strtoul(at, &end, 10);
+    unsigned long last = first;
+    if (end == at)
+    {
+      return false;
+    }
+    if (*end == '-')
+    {
+      at = end + 1;
+      last = strtoul(at, &end, 10);
+      if (end == at)
+      {
+        return false;
+      }
+    }
+    if (first > last || last >= shard_count || (*end != ',' && *end != '\0') ||
+        (*end == ',' && end[1] == '\0'))
+    {
+      return false;
+    }
+    for (unsigned long shard = first; shard <= last; shard++)
+    {
+      chosen[shard] = true;
+    }
+    at = *end == ',' ? end + 1 : end;
+  }
+
+  for (uint32_t shard = 0; shard < shard_count; shard++)
+  {
+    if (chosen[shard])
+    {
+      names.push_back(partition(shard));
+    }
+  }
+  return !names.empty();
+}
+
+std::vector<std::string> shardSubscription(int argc, char *argv[])
+{
+  std::vector<std::string> names;
+  const char *partition = getOption(argc, argv, "--partition", NULL);
+  if (partition != NULL)
+  {
+    std::string list = partition;
+    for (size_t start = 0, end; start <= list.size(); start = end + 1)
+    {
+      end = list.find(',', start);
+      end = end == std::string::npos ? list.size() : end;
+      names.push_back(list.substr(start, end - start));
+    }
+    return names;
+  }
+
+  ShardMap shards = ShardMap::fromCommandLine(argc, argv);
+  if (!shards.enabled())
+  {
+    return names;
+  }
+  const char *subset = getOption(argc, argv, "--shard-set", "all");
+  if (!shards.partitions(subset, names))
+  {
+    std::cerr << "Error in --shard-set: expected shards such as 0,2-3 below "
+              << shards.shards() << " or all, got " << subset << std::endl;
+    exit(1);
+  }
+  return names;
+}
+
+void setPartitions(DDS::PartitionQosPolicy &policy, const std::vector<std::string> &names)
+{
+  if (names.empty())
+  {
+    return;
+  }
+  policy.name.length((DDS::ULong)names.size());
+  for (size_t i = 0; i < names.size(); i++)
+  {
+    policy.name[(DDS::ULong)i] = names[i].c_str();
+  }
+}
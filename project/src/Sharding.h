@@ -0,0 +1,95 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Sharding.h
+ * FUNCTION:        Partition sharding of the sensor traffic.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for sharding the sensor topics over DDS
+ * partitions. With "--shards N" (N > 1) an edge node publishes into the
+ * partition "<prefix><k>", k being the hash of its node id modulo N, and
+ * a subscriber only binds to the partitions of "--shard-set" (default
+ * all of them), so N subscribers with disjoint sets share the load.
+ *
+ *   --shards N            number of shards, 1 (default) keeps the
+ *                         default partition
+ *   --shard-hash NAME     fnv1a (default) or numeric: the number at the
+ *                         end of the node id, so nodes 1..N go to shards
+ *                         1..N mod N; ids without one fall back to fnv1a
+ *   --shard-prefix P      partition name prefix (default stack.shard)
+ *   --shard-set LIST      subscribers: shards such as 0,2-3 or all
+ *
+ * "--partition A,B" instead binds a subscriber to the partitions named,
+ * e.g. the one an aggregator republishes into.
+ *
+ * Publishers and subscribers must agree on --shards, --shard-hash and
+ * --shard-prefix.
+ *
+ ***/
+
+#ifndef __SHARDING_H__
+  #define __SHARDING_H__
+
+  #include <stdint.h>
+  #include <string>
+  #include <vector>
+  #include "ccpp_dds_dcps.h"
+
+  #define SHARD_DEFAULT_PREFIX  "stack.shard"
+
+  enum ShardHash
+  {
+      SHARD_HASH_FNV1A,
+      SHARD_HASH_NUMERIC
+  };
+
+  class ShardMap
+  {
+      uint32_t shard_count;
+      ShardHash hash;
+      std::string prefix;
+    public:
+      ShardMap(uint32_t shards = 1, ShardHash hash = SHARD_HASH_FNV1A,
+        const char *prefix = SHARD_DEFAULT_PREFIX);
+
+      /**
+       * The map of --shards, --shard-hash and --shard-prefix. Exits with
+       * an error for bad values.
+       **/
+      static ShardMap fromCommandLine(int argc, char *argv[]);
+
+      uint32_t shards() const { return shard_count; }
+      bool enabled() const { return shard_count > 1; }
+      uint32_t shardOf(const char *nodeId) const;
+
+      /**
+       * Partition of shard, "" (the default partition) when sharding is
+       * off.
+       **/
+      std::string partition(uint32_t shard) const;
+      std::string partitionOf(const char *nodeId) const { return partition(shardOf(nodeId)); }
+
+      /**
+       * Partitions of the shards in subset ("0,2-3", "all"). Returns false
+       * for a malformed subset or a shard out of range.
+       **/
+      bool partitions(const char *subset, std::vector<std::string> &names) const;
+
+      static bool parseHash(const char *name, ShardHash &hash);
+  };
+
+  /**
+   * Partitions a subscriber binds to according to the command line
+   * (--partition, else --shards and --shard-set); empty for the default
+   * partition.
+   **/
+  std::vector<std::string> shardSubscription(int argc, char *argv[]);
+
+  /**
+   * Replaces the names of policy; an empty list keeps the default
+   * partition.
+   **/
+  void setPartitions(DDS::PartitionQosPolicy &policy, const std::vector<std::string> &names);
+
+#endif
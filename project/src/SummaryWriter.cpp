@@ -0,0 +1,71 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SummaryWriter.cpp
+ * FUNCTION:        Publisher of per sensor window summaries.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the summary writer.
+ *
+ ***/
+
+#include "SummaryWriter.h"
+#include "CheckStatus.h"
+#include "Sharding.h"
+
+SummaryWriter::SummaryWriter(DDS::DomainParticipant_ptr participant, DDS::QosProvider &qp,
+  const char *source, const std::vector<std::string> &partitions)
+  : participant(DDS::DomainParticipant::_duplicate(participant))
+{
+  std::string name = std::string(source) + "_summary";
+  EnvironmentalData::SensorSummaryTypeSupport_var typesupport = new EnvironmentalData::SensorSummaryTypeSupport();
+  DDS::String_var typeName = typesupport->get_type_name();
+  checkStatus(typesupport->register_type(participant, typeName), "register_type() summary failed");
+
+  DDS::TopicQos tQos;
+  checkStatus(qp.get_topic_qos(tQos, NULL), "get_topic_qos() failed");
+  topic = participant->create_topic(name.c_str(), typeName, tQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(topic, "create_topic() " + name + " failed");
+
+  DDS::PublisherQos pQos;
+  checkStatus(qp.get_publisher_qos(pQos, NULL), "get_publisher_qos() failed");
+  setPartitions(pQos.partition, partitions);
+  publisher = participant->create_publisher(pQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(publisher, "create_publisher() " + name + " failed");
+
+  DDS::DataWriterQos wQos;
+  checkStatus(qp.get_datawriter_qos(wQos, NULL), "get_datawriter_qos() failed");
+  DDS::DataWriter_var untyped = publisher->create_datawriter(topic, wQos, NULL, DDS::STATUS_MASK_NONE);
+  checkHandle(untyped, "create_datawriter() " + name + " failed");
+  writer = EnvironmentalData::SensorSummaryDataWriter::_narrow(untyped);
+  checkHandle(writer, "SensorSummaryDataWriter::_narrow() " + name + " failed");
+  instance.topic = DDS::String_mgr(source);
+}
+
+SummaryWriter::~SummaryWriter()
+{
+  checkStatus(publisher->delete_datawriter(writer), "delete_datawriter() summary failed");
+  checkStatus(participant->delete_publisher(publisher), "delete_publisher() summary failed");
+  checkStatus(participant->delete_topic(topic), "delete_topic() summary failed");
+}
+
+void SummaryWriter::write(const SensorAggregator &aggregator, const std::vector<SensorWindow> &windows,
+  int64_t windowEnd)
+{
+  for (size_t i = 0; i < windows.size(); i++)
+  {
+    const SensorWindow &window = windows[i];
+    instance.id = DDS::String_mgr(aggregator.id(window.sensor).c_str());
+    instance.type = DDS::String_mgr(aggregator.type(window.sensor).c_str());
+    instance.min = window.min_value;
+    instance.max = window.max_value;
+    instance.mean = window.value(REDUCE_MEAN);
+    instance.last = window.last_value;
+    instance.count = window.count;
+    instance.first = window.first;
+    instance.last_timestamp = window.last;
+    instance.window_end = windowEnd;
+    checkStatus(writer->write(instance, DDS::HANDLE_NIL), "SensorSummaryDataWriter::write");
+  }
+}
@@ -0,0 +1,52 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    SummaryWriter.h
+ * FUNCTION:        Publisher of per sensor window summaries.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the writer of the SensorSummary
+ * topics. The summaries of topic <t> go to "<t>_summary", keyed by
+ * sensor id, whether an edge node reduces its own readings or an
+ * aggregator reduces those of many nodes.
+ *
+ * The writer creates its topic, publisher and writer on a participant
+ * owned by the caller and deletes them when it is destroyed.
+ *
+ ***/
+
+#ifndef __SUMMARYWRITER_H__
+  #define __SUMMARYWRITER_H__
+
+  #include <string>
+  #include <vector>
+  #include "ccpp_dds_dcps.h"
+  #include "ccpp_EnvironmentalData.h"
+  #include "QosProvider.h"
+  #include "SensorAggregator.h"
+
+  class SummaryWriter
+  {
+      DDS::DomainParticipant_var participant;
+      DDS::Topic_var topic;
+      DDS::Publisher_var publisher;
+      EnvironmentalData::SensorSummaryDataWriter_var writer;
+      EnvironmentalData::SensorSummary instance;
+    public:
+      /**
+       * Writes the summaries of source in partitions (none: the default
+       * partition) with the QoS of qp.
+       **/
+      SummaryWriter(DDS::DomainParticipant_ptr participant, DDS::QosProvider &qp, const char *source,
+        const std::vector<std::string> &partitions);
+      ~SummaryWriter();
+
+      /**
+       * Publishes the windows aggregator closed at windowEnd (ms).
+       **/
+      void write(const SensorAggregator &aggregator, const std::vector<SensorWindow> &windows,
+        int64_t windowEnd);
+  };
+
+#endif
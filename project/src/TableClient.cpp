@@ -0,0 +1,83 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    TableClient.cpp
+ * FUNCTION:        Command line client for the c2 sensor table.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the 'c2_table' executable.
+ *
+ * This executable:
+ * - maps the shared memory sensor table of a running c2 (--table)
+ * - prints the latest reading of one sensor (--id) or of every sensor as
+ *   "id,type,value,timestamp,updated" lines
+ * - with --watch MS repeats that every MS milliseconds, following c2
+ *   when it is restarted
+ *
+ * It only reads the shared memory; c2 is never slowed down or blocked.
+ *
+ * Usage: c2_table [--table /stack_sensors] [--id ID] [--watch MS]
+ *
+ ***/
+
+#include <stdio.h>
+#include <unistd.h>
+#include <iostream>
+#include "CommandLine.h"
+#include "SensorTable.h"
+
+using namespace std;
+
+static void print(const SensorReading &reading)
+{
+  printf("%s,%s,%g,%lld,%lld\n", reading.id, reading.type, reading.value,
+    (long long)reading.timestamp, (long long)reading.updated);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *name = getOption(argc, argv, "--table", "/stack_sensors");
+  const char *id = getOption(argc, argv, "--id", NULL);
+  long watch = getIntOption(argc, argv, "--watch", 0);
+
+  SensorTableReader table;
+  for (;;)
+  {
+    if (!table.isLive() && !table.open(name))
+    {
+      if (watch <= 0)
+      {
+        cerr << "Error in open(): no sensor table " << name << endl;
+        return 1;
+      }
+    }
+    else if (id != NULL)
+    {
+      SensorReading reading;
+      SensorTableStatus status = table.read(id, reading);
+      if (status == SENSOR_TABLE_OK)
+      {
+        print(reading);
+      }
+      else if (watch <= 0)
+      {
+        cerr << "Error in read(): " << (status == SENSOR_TABLE_BUSY ? "busy " : "no reading for ")
+             << id << endl;
+        return 1;
+      }
+    }
+    else
+    {
+      table.forEach(print);
+      cerr << table.count() << " of " << table.capacity() << " slots in use" << endl;
+    }
+
+    if (watch <= 0)
+    {
+      return 0;
+    }
+    fflush(stdout);
+    usleep((useconds_t)watch * 1000);
+  }
+}
@@ -0,0 +1,26 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Transport.cpp
+ * FUNCTION:        Transport interface for sensor samples.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the implementation for the helpers shared by the
+ * transport backends.
+ *
+ ***/
+
+#include <string.h>
+#include "Transport.h"
+
+void transportCopy(char *field, const char *value)
+{
+  size_t length = strlen(value);
+  if (length >= TRANSPORT_STRING_SIZE)
+  {
+    length = TRANSPORT_STRING_SIZE - 1;
+  }
+  memcpy(field, value, length);
+  field[length] = '\0';
+}
@@ -0,0 +1,90 @@
+
+/************************************************************************
+ * LOGICAL_NAME:    Transport.h
+ * FUNCTION:        Transport interface for sensor samples.
+ * MODULE:          Stack2018 for the C++ programming language.
+ * DATE             October 2026.
+ ************************************************************************
+ *
+ * This file contains the headers for the transport interface the sample
+ * processing is written against. It carries the Environmental type as a
+ * plain struct and keeps the DDS read/take semantics:
+ * - a reader keeps the last depth samples of its topic (KEEP_LAST)
+ * - read() returns them and leaves them in the reader, take() removes them
+ * - a reader only sees samples written after it was created (VOLATILE)
+ *
+ * Backends:
+ * - DDSTransport (DDSTransport.h) on OpenSplice
+ * - BusTransport (BusTransport.h), an in-process lock-free bus, to run
+ *   and profile the processing without the middleware
+ *
+ ***/
+
+#ifndef __TRANSPORT_H__
+  #define __TRANSPORT_H__
+
+  #include <stdint.h>
+  #include <stddef.h>
+  #include <vector>
+
+  /* string<50> of the IDL plus the terminator. */
+  #define TRANSPORT_STRING_SIZE  51
+
+  struct TransportSample
+  {
+      char     id[TRANSPORT_STRING_SIZE];
+      char     type[TRANSPORT_STRING_SIZE];
+      float    value;
+      int64_t  timestamp;       /* source timestamp (ms since the epoch) */
+  };
+
+  /**
+   * Copies a string into a sample field, truncated to its bound.
+   **/
+  void transportCopy(char *field, const char *value);
+
+  class TransportWriter
+  {
+    public:
+      virtual ~TransportWriter() {}
+
+      /**
+       * Publishes a sample; a zero timestamp is set to the current time.
+       * Returns false when the sample could not be delivered.
+       **/
+      virtual bool write(const TransportSample &sample) = 0;
+  };
+
+  class TransportReader
+  {
+    public:
+      virtual ~TransportReader() {}
+
+      /**
+       * Replace the content of samples with up to maxSamples samples and
+       * return how many there are; take() removes them from the reader.
+       **/
+      virtual size_t read(std::vector<TransportSample> &samples, size_t maxSamples = SIZE_MAX) = 0;
+      virtual size_t take(std::vector<TransportSample> &samples, size_t maxSamples = SIZE_MAX) = 0;
+
+      /**
+       * Blocks until samples are available or timeoutMs passed. Returns
+       * true when samples are available.
+       **/
+      virtual bool wait(int64_t timeoutMs) = 0;
+
+      /**
+       * Samples that were dropped before this reader got them.
+       **/
+      virtual uint64_t lost() = 0;
+  };
+
+  class Transport
+  {
+    public:
+      virtual ~Transport() {}
+      virtual TransportWriter *createWriter(const char *topic) = 0;
+      virtual TransportReader *createReader(const char *topic) = 0;
+  };
+
+#endif